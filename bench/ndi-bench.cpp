@@ -0,0 +1,462 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/**
+ * Standalone benchmark of the plugin's CPU hot paths (colour conversion, scaling, audio gathering, crop math)
+ * at 720p to 8K, and of an NDI loopback (a sender and a receiver on this host) for end-to-end latency and
+ * throughput. Built with -DENABLE_BENCHMARKS=ON, never installed.
+ *
+ * Usage: ndi-bench [kernels] [loopback] [--seconds S] [--frames N]
+ * Runs both parts by default. The loopback needs the NDI runtime, found like the plugin does (NDI_RUNTIME_DIR_V6,
+ * then the system library path).
+ */
+
+#include "ndi-audio.h"
+#include "ndi-buffer-pool.h"
+#include "ndi-color-convert.h"
+#include "ndi-video-converter.h"
+
+#include <obs.h>
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct {
+	const char *name;
+	uint32_t width;
+	uint32_t height;
+} bench_resolution_t;
+
+static const bench_resolution_t bench_resolutions[] = {
+	{"720p", 1280, 720},
+	{"1080p", 1920, 1080},
+	{"4K", 3840, 2160},
+	{"8K", 7680, 4320},
+};
+
+// Measuring time of each kernel, and frames of each loopback run
+static double bench_seconds = 1.0;
+static int bench_frames = 240;
+
+// The converter logs its render regions at debug level, which would flood the crop benchmark
+static void bench_log_handler(int log_level, const char *format, va_list args, void *)
+{
+	if (log_level > LOG_WARNING)
+		return;
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+}
+
+/**
+ * Call fn repeatedly for bench_seconds (at least 3 times), after one warm up call.
+ * @return Average nanoseconds per call
+ */
+template<typename Fn> static double bench_run(Fn &&fn)
+{
+	fn();
+
+	const uint64_t start = os_gettime_ns();
+	const uint64_t deadline = start + (uint64_t)(bench_seconds * 1000000000.0);
+	uint64_t iterations = 0;
+	uint64_t now;
+	do {
+		fn();
+		++iterations;
+		now = os_gettime_ns();
+	} while (now < deadline || iterations < 3);
+
+	return (double)(now - start) / (double)iterations;
+}
+
+// units: items processed per call (pixels, samples), reported as millions per second
+static void bench_report(const char *kernel, const char *size, double ns, double units, const char *unit_name)
+{
+	if (units > 0.0)
+		printf("%-36s %-6s %10.4f ms %10.1f M%s/s\n", kernel, size, ns / 1000000.0, units * 1000.0 / ns,
+		       unit_name);
+	else
+		printf("%-36s %-6s %10.4f ms\n", kernel, size, ns / 1000000.0);
+}
+
+// Planes filled with a pattern, so the kernels do not run on untouched (possibly shared zero) pages
+static std::vector<uint8_t> bench_plane(size_t size)
+{
+	std::vector<uint8_t> plane(size);
+	for (size_t i = 0; i < size; ++i)
+		plane[i] = (uint8_t)(i * 31 + 7);
+	return plane;
+}
+
+static void bench_i444_to_uyvy(const bench_resolution_t &res)
+{
+	const size_t pixels = (size_t)res.width * res.height;
+	auto y = bench_plane(pixels);
+	auto u = bench_plane(pixels);
+	auto v = bench_plane(pixels);
+	std::vector<uint8_t> uyvy(pixels * 2);
+
+	uint8_t *input[] = {y.data(), u.data(), v.data()};
+	uint32_t in_linesize[] = {res.width, res.width, res.width};
+	uint8_t *output[] = {uyvy.data()};
+	uint32_t out_linesize[] = {res.width * 2};
+
+	double ns = bench_run([&] { convert_i444_to_uyvy(input, in_linesize, 0, res.height, output, out_linesize); });
+	bench_report("i444_to_uyvy (scalar)", res.name, ns, (double)pixels, "px");
+
+	const char *impl_name = nullptr;
+	uyvy_conv_function convert = ndi_select_i444_to_uyvy(&impl_name);
+	ns = bench_run([&] { convert(input, in_linesize, 0, res.height, output, out_linesize); });
+	std::string kernel = std::string("i444_to_uyvy (") + (impl_name ? impl_name : "selected") + ")";
+	bench_report(kernel.c_str(), res.name, ns, (double)pixels, "px");
+}
+
+static void bench_i010_to_p216(const bench_resolution_t &res)
+{
+	const char *impl_name = nullptr;
+	uyvy_conv_function convert = ndi_select_to_p216(VIDEO_FORMAT_I010, &impl_name);
+	if (!convert)
+		return;
+
+	const size_t pixels = (size_t)res.width * res.height;
+	auto y = bench_plane(pixels * 2);
+	auto u = bench_plane(pixels / 2);
+	auto v = bench_plane(pixels / 2);
+	std::vector<uint8_t> p216_y(pixels * 2);
+	std::vector<uint8_t> p216_uv(pixels * 2);
+
+	uint8_t *input[] = {y.data(), u.data(), v.data()};
+	uint32_t in_linesize[] = {res.width * 2, res.width, res.width};
+	uint8_t *output[] = {p216_y.data(), p216_uv.data()};
+	uint32_t out_linesize[] = {res.width * 2, res.width * 2};
+
+	double ns = bench_run([&] { convert(input, in_linesize, 0, res.height, output, out_linesize); });
+	std::string kernel = std::string("i010_to_p216 (") + (impl_name ? impl_name : "selected") + ")";
+	bench_report(kernel.c_str(), res.name, ns, (double)pixels, "px");
+}
+
+// BGRA source scaled to half its size, like an NDI Output with a custom resolution
+static void bench_scale_video(const bench_resolution_t &res)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_bool(settings, "enable_custom_resolution", true);
+	obs_data_set_int(settings, "resolution_mode", NDI_RESOLUTION_CUSTOM);
+	obs_data_set_int(settings, "custom_width", res.width / 2);
+	obs_data_set_int(settings, "custom_height", res.height / 2);
+	obs_data_set_int(settings, "scale_type", NDI_SCALE_BICUBIC);
+
+	ndi_video_converter_t converter;
+	ndi_converter_init(&converter);
+	ndi_converter_update(&converter, settings);
+	obs_data_release(settings);
+
+	auto bgra = bench_plane((size_t)res.width * res.height * 4);
+	uint8_t *frame_in[MAX_AV_PLANES] = {bgra.data()};
+	uint32_t linesize_in[MAX_AV_PLANES] = {res.width * 4};
+	uint8_t *frame_out = nullptr;
+	uint32_t linesize_out = 0;
+
+	bool scaled = true;
+	double ns = bench_run([&] {
+		scaled &= ndi_converter_scale_video(&converter, frame_in, linesize_in, res.width, res.height,
+						    VIDEO_FORMAT_BGRA, &frame_out, &linesize_out);
+	});
+	const char *kernel = "scale BGRA to 1/2 BGRA (bicubic)";
+	if (scaled)
+		bench_report(kernel, res.name, ns, (double)res.width * res.height, "px");
+	else
+		printf("%-36s %-6s failed\n", kernel, res.name);
+
+	ndi_converter_destroy(&converter);
+}
+
+// The render region is cached per source size, alternate two sizes so it is recomputed on every call
+static void bench_crop_region(const bench_resolution_t &res)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_bool(settings, "enable_crop", true);
+	obs_data_set_int(settings, "crop_left", res.width / 8);
+	obs_data_set_int(settings, "crop_top", res.height / 8);
+	obs_data_set_int(settings, "crop_width", res.width / 2);
+	obs_data_set_int(settings, "crop_height", res.height / 2);
+	obs_data_set_bool(settings, "enable_custom_resolution", true);
+	obs_data_set_int(settings, "resolution_mode", NDI_RESOLUTION_720P);
+
+	ndi_video_converter_t converter;
+	ndi_converter_init(&converter);
+	ndi_converter_update(&converter, settings);
+	obs_data_release(settings);
+
+	uint32_t width_step = 0;
+	double ns = bench_run([&] {
+		ndi_converter_update_region(&converter, res.width + width_step, res.height);
+		width_step ^= 2;
+	});
+	bench_report("crop region update", res.name, ns, 0.0, nullptr);
+
+	ndi_converter_destroy(&converter);
+}
+
+static void bench_audio()
+{
+	const uint32_t channels = 8;
+	const uint32_t samples = 1024;
+	const size_t plane_bytes = samples * sizeof(float);
+
+	// Equally spaced planes (OBS mix buffers) are referenced in place, separate allocations are gathered
+	auto contiguous = bench_plane(plane_bytes * channels);
+	std::vector<std::vector<uint8_t>> separate;
+	uint8_t *spaced_planes[MAX_AV_PLANES] = {};
+	uint8_t *separate_planes[MAX_AV_PLANES] = {};
+	for (uint32_t i = 0; i < channels; ++i) {
+		spaced_planes[i] = contiguous.data() + i * plane_bytes;
+		separate.push_back(bench_plane(plane_bytes + (i + 1) * 64));
+	}
+	for (uint32_t i = 0; i < channels; ++i)
+		separate_planes[i] = separate[i].data();
+
+	size_t buffer_size = ndi_audio_fltp_buffer_size(channels, samples);
+	uint8_t *buffer = ndi_buffer_pool_alloc(buffer_size, &buffer_size);
+	NDIlib_audio_frame_v3_t audio_frame;
+	audio_frame.no_channels = (int)channels;
+	audio_frame.no_samples = (int)samples;
+
+	double ns = bench_run([&] { ndi_audio_set_fltp(&audio_frame, spaced_planes, &buffer, &buffer_size); });
+	bench_report("audio fltp (in place, 8 ch)", "1024", ns, (double)samples * channels, "smp");
+	ns = bench_run([&] { ndi_audio_set_fltp(&audio_frame, separate_planes, &buffer, &buffer_size); });
+	bench_report("audio fltp (gathered, 8 ch)", "1024", ns, (double)samples * channels, "smp");
+	ndi_buffer_pool_free(buffer, buffer_size);
+
+	// 20 ms batches at 48 kHz, filled with 480 sample blocks
+	ndi_audio_batch_t batch = {};
+	ndi_audio_batch_configure(&batch, channels, 960);
+	ns = bench_run([&] {
+		ndi_audio_batch_append(&batch, separate_planes, 480);
+		ndi_audio_batch_append(&batch, separate_planes, 480);
+		ndi_audio_batch_set_frame(&batch, &audio_frame);
+		batch.samples = 0;
+	});
+	bench_report("audio batch (2 x 480, 8 ch)", "960", ns, 960.0 * channels, "smp");
+	ndi_audio_batch_free(&batch);
+}
+
+static void bench_kernels()
+{
+	printf("%-36s %-6s %13s %15s\n", "Kernel", "Size", "Time", "Rate");
+	for (const auto &res : bench_resolutions) {
+		bench_i444_to_uyvy(res);
+		bench_i010_to_p216(res);
+		bench_scale_video(res);
+		bench_crop_region(res);
+	}
+	bench_audio();
+}
+
+typedef const NDIlib_v6 *(*bench_ndilib_load_t)(void);
+
+static const NDIlib_v6 *bench_load_ndilib(void **module)
+{
+	std::string path = NDILIB_LIBRARY_NAME;
+	const char *folder = getenv(NDILIB_REDIST_FOLDER);
+	if (folder && *folder)
+		path = std::string(folder) + "/" + NDILIB_LIBRARY_NAME;
+
+	*module = os_dlopen(path.c_str());
+	if (!*module) {
+		fprintf(stderr, "Cannot load the NDI runtime '%s'\n", path.c_str());
+		return nullptr;
+	}
+
+	auto load = (bench_ndilib_load_t)os_dlsym(*module, "NDIlib_v6_load");
+	const NDIlib_v6 *ndi = load ? load() : nullptr;
+	if (!ndi || !ndi->initialize()) {
+		fprintf(stderr, "Cannot initialize the NDI runtime '%s'\n", path.c_str());
+		os_dlclose(*module);
+		*module = nullptr;
+		return nullptr;
+	}
+	return ndi;
+}
+
+static double bench_percentile(std::vector<double> &values, double percentile)
+{
+	if (values.empty())
+		return 0.0;
+	size_t index = std::min(values.size() - 1, (size_t)(percentile * (double)(values.size() - 1) + 0.5));
+	std::nth_element(values.begin(), values.begin() + (ptrdiff_t)index, values.end());
+	return values[index];
+}
+
+/**
+ * Send bench_frames UYVY frames to a receiver on this host. Each frame carries its send time in the timecode,
+ * the receiver measures the latency from it.
+ * @param paced Send at 60 fps (latency) instead of as fast as possible (throughput)
+ */
+static void bench_loopback_run(const NDIlib_v6 *ndi, const bench_resolution_t &res, bool paced)
+{
+	NDIlib_send_create_t send_desc;
+	send_desc.p_ndi_name = "DistroAV Benchmark";
+	send_desc.p_groups = nullptr;
+	send_desc.clock_video = false;
+	send_desc.clock_audio = false;
+	NDIlib_send_instance_t sender = ndi->send_create(&send_desc);
+	if (!sender) {
+		fprintf(stderr, "Cannot create the NDI sender\n");
+		return;
+	}
+
+	NDIlib_recv_create_v3_t recv_desc;
+	recv_desc.source_to_connect_to = *ndi->send_get_source_name(sender);
+	recv_desc.color_format = NDIlib_recv_color_format_fastest;
+	recv_desc.bandwidth = NDIlib_recv_bandwidth_highest;
+	recv_desc.allow_video_fields = false;
+	recv_desc.p_ndi_recv_name = "DistroAV Benchmark Receiver";
+	NDIlib_recv_instance_t receiver = ndi->recv_create_v3(&recv_desc);
+
+	const char *mode = paced ? "loopback 60 fps" : "loopback unpaced";
+	if (!receiver || ndi->send_get_no_connections(sender, 10000) <= 0) {
+		printf("%-36s %-6s no connection\n", mode, res.name);
+		if (receiver)
+			ndi->recv_destroy(receiver);
+		ndi->send_destroy(sender);
+		return;
+	}
+
+	std::vector<double> latencies_ms;
+	latencies_ms.reserve((size_t)bench_frames);
+	std::atomic<bool> sending{true};
+	uint64_t last_received_ns = 0;
+	std::thread capture([&] {
+		int idle = 0;
+		while ((int)latencies_ms.size() < bench_frames && idle < 3) {
+			NDIlib_video_frame_v2_t video_frame;
+			switch (ndi->recv_capture_v3(receiver, &video_frame, nullptr, nullptr, 1000)) {
+			case NDIlib_frame_type_video: {
+				last_received_ns = os_gettime_ns();
+				// Timecodes are in 100 ns units
+				int64_t latency = (int64_t)(last_received_ns / 100) - video_frame.timecode;
+				latencies_ms.push_back((double)latency / 10000.0);
+				ndi->recv_free_video_v2(receiver, &video_frame);
+				idle = 0;
+				break;
+			}
+			case NDIlib_frame_type_none:
+				// Frames dropped by the receiver never arrive, stop once the sender is done and idle
+				if (!sending)
+					++idle;
+				break;
+			default:
+				break;
+			}
+		}
+	});
+
+	auto uyvy = bench_plane((size_t)res.width * res.height * 2);
+	NDIlib_video_frame_v2_t video_frame;
+	video_frame.xres = (int)res.width;
+	video_frame.yres = (int)res.height;
+	video_frame.FourCC = NDIlib_FourCC_type_UYVY;
+	video_frame.frame_rate_N = 60000;
+	video_frame.frame_rate_D = 1000;
+	video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
+	video_frame.p_data = uyvy.data();
+	video_frame.line_stride_in_bytes = (int)res.width * 2;
+
+	const uint64_t interval_ns = 1000000000ULL / 60;
+	const uint64_t start = os_gettime_ns();
+	for (int i = 0; i < bench_frames; ++i) {
+		if (paced)
+			os_sleepto_ns(start + (uint64_t)i * interval_ns);
+		video_frame.timecode = (int64_t)(os_gettime_ns() / 100);
+		ndi->send_send_video_v2(sender, &video_frame);
+	}
+	sending = false;
+	capture.join();
+
+	size_t received = latencies_ms.size();
+	double elapsed_s = received ? (double)(last_received_ns - start) / 1000000000.0 : 0.0;
+	double fps = elapsed_s > 0.0 ? (double)received / elapsed_s : 0.0;
+	double mb_s = fps * (double)res.width * res.height * 2 / 1000000.0;
+	double p50 = bench_percentile(latencies_ms, 0.50);
+	double p95 = bench_percentile(latencies_ms, 0.95);
+	double max = received ? *std::max_element(latencies_ms.begin(), latencies_ms.end()) : 0.0;
+	printf("%-36s %-6s %4zu/%-4d frames %8.1f fps %8.1f MB/s  latency p50 %.2f p95 %.2f max %.2f ms\n", mode,
+	       res.name, received, bench_frames, fps, mb_s, p50, p95, max);
+
+	ndi->recv_destroy(receiver);
+	ndi->send_destroy(sender);
+}
+
+static void bench_loopback()
+{
+	void *module = nullptr;
+	const NDIlib_v6 *ndi = bench_load_ndilib(&module);
+	if (!ndi)
+		return;
+
+	printf("NDI %s\n", ndi->version());
+	for (const auto &res : bench_resolutions) {
+		if (res.width > 3840)
+			continue; // 8K UYVY exceeds what the loopback sends in real time on most hosts
+		bench_loopback_run(ndi, res, true);
+		bench_loopback_run(ndi, res, false);
+	}
+
+	ndi->destroy();
+	os_dlclose(module);
+}
+
+int main(int argc, char *argv[])
+{
+	bool run_kernels = false;
+	bool run_loopback = false;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "kernels") == 0) {
+			run_kernels = true;
+		} else if (strcmp(argv[i], "loopback") == 0) {
+			run_loopback = true;
+		} else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+			bench_seconds = std::max(atof(argv[++i]), 0.01);
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			bench_frames = std::max(atoi(argv[++i]), 1);
+		} else {
+			fprintf(stderr, "Usage: %s [kernels] [loopback] [--seconds S] [--frames N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (!run_kernels && !run_loopback)
+		run_kernels = run_loopback = true;
+
+	base_set_log_handler(bench_log_handler, nullptr);
+
+	if (run_kernels)
+		bench_kernels();
+	if (run_loopback)
+		bench_loopback();
+
+	ndi_buffer_pool_shutdown();
+	return 0;
+}
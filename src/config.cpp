@@ -29,9 +29,26 @@
 #define PARAM_MAIN_OUTPUT_ENABLED "MainOutputEnabled"
 #define PARAM_MAIN_OUTPUT_NAME "MainOutputName"
 #define PARAM_MAIN_OUTPUT_GROUPS "MainOutputGroups"
+#define PARAM_MAIN_OUTPUT_RESOLUTION "MainOutputResolution"
+#define PARAM_MAIN_OUTPUT_FRAMERATE "MainOutputFramerate"
+#define PARAM_MAIN_OUTPUT_ALWAYS_SEND "MainOutputAlwaysSend"
+#define PARAM_MAIN_OUTPUT_CLOCK_VIDEO "MainOutputClockVideo"
+#define PARAM_MAIN_OUTPUT_CLOCK_AUDIO "MainOutputClockAudio"
+#define PARAM_MAIN_OUTPUT_DROP_FRAMES "MainOutputDropFrames"
 #define PARAM_PREVIEW_OUTPUT_ENABLED "PreviewOutputEnabled"
 #define PARAM_PREVIEW_OUTPUT_NAME "PreviewOutputName"
 #define PARAM_PREVIEW_OUTPUT_GROUPS "PreviewOutputGroups"
+#define PARAM_PREVIEW_OUTPUT_RESOLUTION "PreviewOutputResolution"
+#define PARAM_PREVIEW_OUTPUT_FRAMERATE "PreviewOutputFramerate"
+#define PARAM_PREVIEW_OUTPUT_ALWAYS_SEND "PreviewOutputAlwaysSend"
+#define PARAM_PREVIEW_OUTPUT_CLOCK_VIDEO "PreviewOutputClockVideo"
+#define PARAM_PREVIEW_OUTPUT_DROP_FRAMES "PreviewOutputDropFrames"
+#define PARAM_SCENE_OUTPUTS "SceneOutputs"
+#define PARAM_ROUTING_OUTPUTS "RoutingOutputs"
+#define PARAM_FINDER_GROUPS "FinderGroups"
+#define PARAM_FINDER_EXTRA_IPS "FinderExtraIps"
+#define PARAM_FINDER_FILTER "FinderFilter"
+#define PARAM_FINDER_SHOW_LOCAL_SOURCES "FinderShowLocalSources"
 #define PARAM_TALLY_PROGRAM_ENABLED "TallyProgramEnabled"
 #define PARAM_TALLY_PREVIEW_ENABLED "TallyPreviewEnabled"
 #define PARAM_SKIP_UPDATE_VERSION "SkipUpdateVersion"
@@ -48,6 +65,7 @@ int Config::UpdateForce = 0;
 int Config::UpdateLocalPort = 0;
 bool Config::UpdateLastCheckIgnore = false;
 int Config::DetectObsNdiForce = 0;
+QString Config::TraceFile;
 
 enum ObsConfigType { OBS_CONFIG_STRING, OBS_CONFIG_BOOL };
 
@@ -141,6 +159,16 @@ void ProcessCommandLine()
 			continue;
 		}
 
+		//
+		// Tracing
+		//
+		if (argument.startsWith("--distroav-trace=")) {
+			// From the original argument, the path keeps its case
+			Config::TraceFile = arguments.at(i).mid(argument.indexOf('=') + 1);
+			obs_log(LOG_INFO, "config: DistroAV trace file set to '%s'", QT_TO_UTF8(Config::TraceFile));
+			continue;
+		}
+
 		//
 		// OBS-NDI Detection
 		//
@@ -187,9 +215,26 @@ Config::Config()
 	: OutputEnabled(false),
 	  OutputName("OBS PGM"),
 	  OutputGroups(""),
+	  OutputResolution(""),
+	  OutputFramerate(""),
+	  OutputAlwaysSend(false),
+	  OutputClockVideo(false),
+	  OutputClockAudio(false),
+	  OutputDropFrames(true),
 	  PreviewOutputEnabled(false),
 	  PreviewOutputName("OBS Preview"),
 	  PreviewOutputGroups(""),
+	  PreviewOutputResolution(""),
+	  PreviewOutputFramerate(""),
+	  PreviewOutputAlwaysSend(false),
+	  PreviewOutputClockVideo(false),
+	  PreviewOutputDropFrames(true),
+	  SceneOutputs(""),
+	  RoutingOutputs(""),
+	  FinderGroups(""),
+	  FinderExtraIps(""),
+	  FinderFilter(""),
+	  FinderShowLocalSources(true),
 	  TallyProgramEnabled(true),
 	  TallyPreviewEnabled(true)
 {
@@ -206,12 +251,39 @@ void Config::SetDefaultsToUserStore()
 		config_set_default_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_ENABLED, OutputEnabled);
 		config_set_default_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_NAME, QT_TO_UTF8(OutputName));
 		config_set_default_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_GROUPS, QT_TO_UTF8(OutputGroups));
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_RESOLUTION,
+					  QT_TO_UTF8(OutputResolution));
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_FRAMERATE,
+					  QT_TO_UTF8(OutputFramerate));
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_ALWAYS_SEND, OutputAlwaysSend);
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_CLOCK_VIDEO, OutputClockVideo);
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_CLOCK_AUDIO, OutputClockAudio);
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_DROP_FRAMES, OutputDropFrames);
 
 		config_set_default_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_ENABLED, PreviewOutputEnabled);
 		config_set_default_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_NAME,
 					  QT_TO_UTF8(PreviewOutputName));
 		config_set_default_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_GROUPS,
 					  QT_TO_UTF8(PreviewOutputGroups));
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_RESOLUTION,
+					  QT_TO_UTF8(PreviewOutputResolution));
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_FRAMERATE,
+					  QT_TO_UTF8(PreviewOutputFramerate));
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_ALWAYS_SEND,
+					PreviewOutputAlwaysSend);
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_CLOCK_VIDEO,
+					PreviewOutputClockVideo);
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_DROP_FRAMES,
+					PreviewOutputDropFrames);
+
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_SCENE_OUTPUTS, QT_TO_UTF8(SceneOutputs));
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_ROUTING_OUTPUTS, QT_TO_UTF8(RoutingOutputs));
+
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_FINDER_GROUPS, QT_TO_UTF8(FinderGroups));
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_FINDER_EXTRA_IPS, QT_TO_UTF8(FinderExtraIps));
+		config_set_default_string(obs_config, SECTION_NAME, PARAM_FINDER_FILTER, QT_TO_UTF8(FinderFilter));
+		config_set_default_bool(obs_config, SECTION_NAME, PARAM_FINDER_SHOW_LOCAL_SOURCES,
+					FinderShowLocalSources);
 
 		config_set_default_bool(obs_config, SECTION_NAME, PARAM_TALLY_PROGRAM_ENABLED, TallyProgramEnabled);
 		config_set_default_bool(obs_config, SECTION_NAME, PARAM_TALLY_PREVIEW_ENABLED, TallyPreviewEnabled);
@@ -249,10 +321,30 @@ void Config::Load()
 		OutputEnabled = config_get_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_ENABLED);
 		OutputName = config_get_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_NAME);
 		OutputGroups = config_get_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_GROUPS);
+		OutputResolution = config_get_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_RESOLUTION);
+		OutputFramerate = config_get_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_FRAMERATE);
+		OutputAlwaysSend = config_get_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_ALWAYS_SEND);
+		OutputClockVideo = config_get_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_CLOCK_VIDEO);
+		OutputClockAudio = config_get_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_CLOCK_AUDIO);
+		OutputDropFrames = config_get_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_DROP_FRAMES);
 
 		PreviewOutputEnabled = config_get_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_ENABLED);
 		PreviewOutputName = config_get_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_NAME);
 		PreviewOutputGroups = config_get_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_GROUPS);
+		PreviewOutputResolution =
+			config_get_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_RESOLUTION);
+		PreviewOutputFramerate = config_get_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_FRAMERATE);
+		PreviewOutputAlwaysSend = config_get_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_ALWAYS_SEND);
+		PreviewOutputClockVideo = config_get_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_CLOCK_VIDEO);
+		PreviewOutputDropFrames = config_get_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_DROP_FRAMES);
+
+		SceneOutputs = config_get_string(obs_config, SECTION_NAME, PARAM_SCENE_OUTPUTS);
+		RoutingOutputs = config_get_string(obs_config, SECTION_NAME, PARAM_ROUTING_OUTPUTS);
+
+		FinderGroups = config_get_string(obs_config, SECTION_NAME, PARAM_FINDER_GROUPS);
+		FinderExtraIps = config_get_string(obs_config, SECTION_NAME, PARAM_FINDER_EXTRA_IPS);
+		FinderFilter = config_get_string(obs_config, SECTION_NAME, PARAM_FINDER_FILTER);
+		FinderShowLocalSources = config_get_bool(obs_config, SECTION_NAME, PARAM_FINDER_SHOW_LOCAL_SOURCES);
 
 		TallyProgramEnabled = config_get_bool(obs_config, SECTION_NAME, PARAM_TALLY_PROGRAM_ENABLED);
 		TallyPreviewEnabled = config_get_bool(obs_config, SECTION_NAME, PARAM_TALLY_PREVIEW_ENABLED);
@@ -266,11 +358,32 @@ void Config::Save()
 		config_set_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_ENABLED, OutputEnabled);
 		config_set_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_NAME, QT_TO_UTF8(OutputName));
 		config_set_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_GROUPS, QT_TO_UTF8(OutputGroups));
+		config_set_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_RESOLUTION, QT_TO_UTF8(OutputResolution));
+		config_set_string(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_FRAMERATE, QT_TO_UTF8(OutputFramerate));
+		config_set_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_ALWAYS_SEND, OutputAlwaysSend);
+		config_set_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_CLOCK_VIDEO, OutputClockVideo);
+		config_set_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_CLOCK_AUDIO, OutputClockAudio);
+		config_set_bool(obs_config, SECTION_NAME, PARAM_MAIN_OUTPUT_DROP_FRAMES, OutputDropFrames);
 
 		config_set_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_ENABLED, PreviewOutputEnabled);
 		config_set_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_NAME, QT_TO_UTF8(PreviewOutputName));
 		config_set_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_GROUPS,
 				  QT_TO_UTF8(PreviewOutputGroups));
+		config_set_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_RESOLUTION,
+				  QT_TO_UTF8(PreviewOutputResolution));
+		config_set_string(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_FRAMERATE,
+				  QT_TO_UTF8(PreviewOutputFramerate));
+		config_set_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_ALWAYS_SEND, PreviewOutputAlwaysSend);
+		config_set_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_CLOCK_VIDEO, PreviewOutputClockVideo);
+		config_set_bool(obs_config, SECTION_NAME, PARAM_PREVIEW_OUTPUT_DROP_FRAMES, PreviewOutputDropFrames);
+
+		config_set_string(obs_config, SECTION_NAME, PARAM_SCENE_OUTPUTS, QT_TO_UTF8(SceneOutputs));
+		config_set_string(obs_config, SECTION_NAME, PARAM_ROUTING_OUTPUTS, QT_TO_UTF8(RoutingOutputs));
+
+		config_set_string(obs_config, SECTION_NAME, PARAM_FINDER_GROUPS, QT_TO_UTF8(FinderGroups));
+		config_set_string(obs_config, SECTION_NAME, PARAM_FINDER_EXTRA_IPS, QT_TO_UTF8(FinderExtraIps));
+		config_set_string(obs_config, SECTION_NAME, PARAM_FINDER_FILTER, QT_TO_UTF8(FinderFilter));
+		config_set_bool(obs_config, SECTION_NAME, PARAM_FINDER_SHOW_LOCAL_SOURCES, FinderShowLocalSources);
 
 		config_set_bool(obs_config, SECTION_NAME, PARAM_TALLY_PROGRAM_ENABLED, TallyProgramEnabled);
 		config_set_bool(obs_config, SECTION_NAME, PARAM_TALLY_PREVIEW_ENABLED, TallyPreviewEnabled);
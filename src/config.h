@@ -42,6 +42,23 @@
  * AutoCheckForUpdates=true
  * MainOutputGroups=
  * PreviewOutputGroups=
+ * MainOutputResolution=1920x1080
+ * MainOutputFramerate=50
+ * PreviewOutputResolution=
+ * PreviewOutputFramerate=
+ * MainOutputAlwaysSend=false
+ * PreviewOutputAlwaysSend=false
+ * MainOutputClockVideo=false
+ * MainOutputClockAudio=false
+ * MainOutputDropFrames=true
+ * PreviewOutputClockVideo=false
+ * PreviewOutputDropFrames=true
+ * SceneOutputs=[{"name":"OBS ISO 1","scene":"Camera 1","resolution":"1280x720","framerate":""}]
+ * RoutingOutputs=[{"name":"OBS Camera Routing","source":"CAMERA-PC (Camera 1)"}]
+ * FinderGroups=
+ * FinderExtraIps=
+ * FinderFilter=
+ * FinderShowLocalSources=true
  * ```
  */
 class Config {
@@ -69,13 +86,40 @@ public:
 	 *  1 = `--DistroAV-detect-obsndi-force=on` : force OBS-NDI detected
 	 */
 	static int DetectObsNdiForce;
+	/**
+	 * `--DistroAV-trace=<file>` : record timing zones and write them to file as a Chrome trace on exit
+	 */
+	static QString TraceFile;
 
 	bool OutputEnabled;
 	QString OutputName;
 	QString OutputGroups;
+	// Empty for the canvas resolution/frame rate, else "WIDTHxHEIGHT" and "NUM" or "NUM/DEN"
+	QString OutputResolution;
+	QString OutputFramerate;
+	// Keep sending while no NDI receiver is connected
+	bool OutputAlwaysSend;
+	// Let the NDI SDK clock video/audio sends, and skip video frames while the sender is busy
+	bool OutputClockVideo;
+	bool OutputClockAudio;
+	bool OutputDropFrames;
 	bool PreviewOutputEnabled;
 	QString PreviewOutputName;
 	QString PreviewOutputGroups;
+	QString PreviewOutputResolution;
+	QString PreviewOutputFramerate;
+	bool PreviewOutputAlwaysSend;
+	bool PreviewOutputClockVideo;
+	bool PreviewOutputDropFrames;
+	// JSON array of the scene outputs: {"name", "groups", "scene", "resolution", "framerate"}
+	QString SceneOutputs;
+	// JSON array of the NDI routings: {"name", "groups", "source"}
+	QString RoutingOutputs;
+	// NDI source discovery: groups and extra IPs handed to the finder, name filter of the listed sources
+	QString FinderGroups;
+	QString FinderExtraIps;
+	QString FinderFilter;
+	bool FinderShowLocalSources;
 	bool TallyProgramEnabled;
 	bool TallyPreviewEnabled;
 
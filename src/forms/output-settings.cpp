@@ -19,19 +19,179 @@
 
 #include "plugin-main.h"
 #include "main-output.h"
+#include "ndi-finder.h"
 #include "preview-output.h"
+#include "routing-outputs.h"
+#include "scene-outputs.h"
 #include "update.h"
 
 #include <QClipboard>
 #include <QDesktopServices>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QPointer>
 
+// Editable presets for the output conversion; the first entry (empty value) keeps the canvas setting
+static void setupConversionComboBox(QComboBox *comboBox, const QStringList &presets)
+{
+	comboBox->addItem(QTStr("NDIPlugin.OutputSettings.Conversion.Canvas"), QString());
+	for (const auto &preset : presets) {
+		comboBox->addItem(preset, preset);
+	}
+}
+
+static QString conversionComboBoxValue(QComboBox *comboBox)
+{
+	auto index = comboBox->findText(comboBox->currentText());
+	return index >= 0 ? comboBox->itemData(index).toString() : comboBox->currentText().trimmed();
+}
+
+static void setConversionComboBoxValue(QComboBox *comboBox, const QString &value)
+{
+	auto index = comboBox->findData(value);
+	if (index >= 0) {
+		comboBox->setCurrentIndex(index);
+	} else {
+		comboBox->setEditText(value);
+	}
+}
+
+static const QStringList conversionResolutions = {"1280x720", "1920x1080", "2560x1440", "3840x2160"};
+static const QStringList conversionFramerates = {"24", "25", "30000/1001", "30", "50", "60000/1001", "60"};
+
+enum SceneOutputColumn {
+	SceneOutputColumnName = 0,
+	SceneOutputColumnScene,
+	SceneOutputColumnResolution,
+	SceneOutputColumnFramerate
+};
+
+static void addSceneOutputRow(QTableWidget *table, const QJsonObject &entry)
+{
+	auto row = table->rowCount();
+	table->insertRow(row);
+
+	auto nameItem = new QTableWidgetItem(entry["name"].toString());
+	// Groups have no column, they are kept as-is
+	nameItem->setData(Qt::UserRole, entry["groups"].toString());
+	table->setItem(row, SceneOutputColumnName, nameItem);
+
+	auto sceneComboBox = new QComboBox(table);
+	sceneComboBox->setEditable(true);
+	char **sceneNames = obs_frontend_get_scene_names();
+	for (char **name = sceneNames; name && *name; ++name) {
+		sceneComboBox->addItem(*name);
+	}
+	bfree(sceneNames);
+	sceneComboBox->setEditText(entry["scene"].toString());
+	table->setCellWidget(row, SceneOutputColumnScene, sceneComboBox);
+
+	auto resolutionComboBox = new QComboBox(table);
+	resolutionComboBox->setEditable(true);
+	setupConversionComboBox(resolutionComboBox, conversionResolutions);
+	setConversionComboBoxValue(resolutionComboBox, entry["resolution"].toString());
+	table->setCellWidget(row, SceneOutputColumnResolution, resolutionComboBox);
+
+	auto framerateComboBox = new QComboBox(table);
+	framerateComboBox->setEditable(true);
+	setupConversionComboBox(framerateComboBox, conversionFramerates);
+	setConversionComboBoxValue(framerateComboBox, entry["framerate"].toString());
+	table->setCellWidget(row, SceneOutputColumnFramerate, framerateComboBox);
+}
+
+static QString sceneOutputsTableValue(QTableWidget *table)
+{
+	QJsonArray entries;
+	for (int row = 0; row < table->rowCount(); ++row) {
+		auto nameItem = table->item(row, SceneOutputColumnName);
+		auto name = nameItem ? nameItem->text().trimmed() : QString();
+		if (name.isEmpty())
+			continue;
+
+		QJsonObject entry;
+		entry["name"] = name;
+		entry["groups"] = nameItem->data(Qt::UserRole).toString();
+		auto sceneComboBox = static_cast<QComboBox *>(table->cellWidget(row, SceneOutputColumnScene));
+		entry["scene"] = sceneComboBox->currentText().trimmed();
+		entry["resolution"] = conversionComboBoxValue(
+			static_cast<QComboBox *>(table->cellWidget(row, SceneOutputColumnResolution)));
+		entry["framerate"] = conversionComboBoxValue(
+			static_cast<QComboBox *>(table->cellWidget(row, SceneOutputColumnFramerate)));
+		entries.append(entry);
+	}
+	return entries.isEmpty() ? QString() : QString(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+}
+
+enum RoutingOutputColumn { RoutingOutputColumnName = 0, RoutingOutputColumnSource };
+
+static void addRoutingOutputRow(QTableWidget *table, const QJsonObject &entry)
+{
+	auto row = table->rowCount();
+	table->insertRow(row);
+
+	auto nameItem = new QTableWidgetItem(entry["name"].toString());
+	// Groups have no column, they are kept as-is
+	nameItem->setData(Qt::UserRole, entry["groups"].toString());
+	table->setItem(row, RoutingOutputColumnName, nameItem);
+
+	auto sourceComboBox = new QComboBox(table);
+	sourceComboBox->setEditable(true);
+	for (const auto &sourceName : NDIFinder::getNDISourceList()) {
+		sourceComboBox->addItem(QString::fromStdString(sourceName));
+	}
+	sourceComboBox->setEditText(entry["source"].toString());
+	table->setCellWidget(row, RoutingOutputColumnSource, sourceComboBox);
+}
+
+static QString routingOutputsTableValue(QTableWidget *table)
+{
+	QJsonArray entries;
+	for (int row = 0; row < table->rowCount(); ++row) {
+		auto nameItem = table->item(row, RoutingOutputColumnName);
+		auto name = nameItem ? nameItem->text().trimmed() : QString();
+		if (name.isEmpty())
+			continue;
+
+		QJsonObject entry;
+		entry["name"] = name;
+		entry["groups"] = nameItem->data(Qt::UserRole).toString();
+		auto sourceComboBox = static_cast<QComboBox *>(table->cellWidget(row, RoutingOutputColumnSource));
+		entry["source"] = sourceComboBox->currentText().trimmed();
+		entries.append(entry);
+	}
+	return entries.isEmpty() ? QString() : QString(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+}
+
 OutputSettings::OutputSettings(QWidget *parent) : QDialog(parent), ui(new Ui::OutputSettings)
 {
 	ui->setupUi(this);
 
+	setupConversionComboBox(ui->mainOutputResolution, conversionResolutions);
+	setupConversionComboBox(ui->mainOutputFramerate, conversionFramerates);
+	setupConversionComboBox(ui->previewOutputResolution, conversionResolutions);
+	setupConversionComboBox(ui->previewOutputFramerate, conversionFramerates);
+
+	ui->sceneOutputsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+	connect(ui->sceneOutputsAdd, &QPushButton::clicked,
+		[this]() { addSceneOutputRow(ui->sceneOutputsTable, QJsonObject()); });
+	connect(ui->sceneOutputsRemove, &QPushButton::clicked, [this]() {
+		auto row = ui->sceneOutputsTable->currentRow();
+		if (row >= 0)
+			ui->sceneOutputsTable->removeRow(row);
+	});
+
+	ui->routingOutputsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+	connect(ui->routingOutputsAdd, &QPushButton::clicked,
+		[this]() { addRoutingOutputRow(ui->routingOutputsTable, QJsonObject()); });
+	connect(ui->routingOutputsRemove, &QPushButton::clicked, [this]() {
+		auto row = ui->routingOutputsTable->currentRow();
+		if (row >= 0)
+			ui->routingOutputsTable->removeRow(row);
+	});
+
 	connect(ui->buttonBox, SIGNAL(accepted()), this, SLOT(onFormAccepted()));
 
 	auto pluginVersionText = QString("%1 %2").arg(PLUGIN_DISPLAY_NAME).arg(PLUGIN_VERSION);
@@ -176,10 +336,29 @@ void OutputSettings::onFormAccepted()
 	config->OutputEnabled = ui->mainOutputGroupBox->isChecked();
 	config->OutputName = ui->mainOutputName->text();
 	config->OutputGroups = ui->mainOutputGroups->text();
+	config->OutputResolution = conversionComboBoxValue(ui->mainOutputResolution);
+	config->OutputFramerate = conversionComboBoxValue(ui->mainOutputFramerate);
+	config->OutputAlwaysSend = ui->mainOutputAlwaysSend->isChecked();
+	config->OutputClockVideo = ui->mainOutputClockVideo->isChecked();
+	config->OutputClockAudio = ui->mainOutputClockAudio->isChecked();
+	config->OutputDropFrames = ui->mainOutputDropFrames->isChecked();
 
 	config->PreviewOutputEnabled = ui->previewOutputGroupBox->isChecked();
 	config->PreviewOutputName = ui->previewOutputName->text();
 	config->PreviewOutputGroups = ui->previewOutputGroups->text();
+	config->PreviewOutputResolution = conversionComboBoxValue(ui->previewOutputResolution);
+	config->PreviewOutputFramerate = conversionComboBoxValue(ui->previewOutputFramerate);
+	config->PreviewOutputAlwaysSend = ui->previewOutputAlwaysSend->isChecked();
+	config->PreviewOutputClockVideo = ui->previewOutputClockVideo->isChecked();
+	config->PreviewOutputDropFrames = ui->previewOutputDropFrames->isChecked();
+
+	config->SceneOutputs = sceneOutputsTableValue(ui->sceneOutputsTable);
+	config->RoutingOutputs = routingOutputsTableValue(ui->routingOutputsTable);
+
+	config->FinderGroups = ui->finderGroups->text().trimmed();
+	config->FinderExtraIps = ui->finderExtraIps->text().trimmed();
+	config->FinderFilter = ui->finderFilter->text().trimmed();
+	config->FinderShowLocalSources = ui->finderShowLocalSources->isChecked();
 
 	config->TallyProgramEnabled = ui->tallyProgramCheckBox->isChecked();
 	config->TallyPreviewEnabled = ui->tallyPreviewCheckBox->isChecked();
@@ -202,7 +381,13 @@ void OutputSettings::onFormAccepted()
 	if (mainSupported && config->OutputEnabled && !config->OutputName.isEmpty()) {
 		if ((last_config.OutputEnabled != config->OutputEnabled) ||
 		    (last_config.OutputName != config->OutputName) ||
-		    (last_config.OutputGroups != config->OutputGroups)) {
+		    (last_config.OutputGroups != config->OutputGroups) ||
+		    (last_config.OutputResolution != config->OutputResolution) ||
+		    (last_config.OutputFramerate != config->OutputFramerate) ||
+		    (last_config.OutputAlwaysSend != config->OutputAlwaysSend) ||
+		    (last_config.OutputClockVideo != config->OutputClockVideo) ||
+		    (last_config.OutputClockAudio != config->OutputClockAudio) ||
+		    (last_config.OutputDropFrames != config->OutputDropFrames)) {
 			// The Output is supported and enabled, OutputName exists and a Name or GroupName has changed since last form submission
 			obs_log(LOG_INFO, "Initializing Main output");
 			main_output_init();
@@ -213,7 +398,12 @@ void OutputSettings::onFormAccepted()
 	if (config->PreviewOutputEnabled && !config->PreviewOutputName.isEmpty()) {
 		if ((last_config.PreviewOutputEnabled != config->PreviewOutputEnabled) ||
 		    (last_config.PreviewOutputName != config->PreviewOutputName) ||
-		    (last_config.PreviewOutputGroups != config->PreviewOutputGroups)) {
+		    (last_config.PreviewOutputGroups != config->PreviewOutputGroups) ||
+		    (last_config.PreviewOutputResolution != config->PreviewOutputResolution) ||
+		    (last_config.PreviewOutputFramerate != config->PreviewOutputFramerate) ||
+		    (last_config.PreviewOutputAlwaysSend != config->PreviewOutputAlwaysSend) ||
+		    (last_config.PreviewOutputClockVideo != config->PreviewOutputClockVideo) ||
+		    (last_config.PreviewOutputDropFrames != config->PreviewOutputDropFrames)) {
 			// The Preview Output is enabled, OutputName exists and a Name or GroupName has changed since last form submission
 			obs_log(LOG_INFO, "Initializing Preview output");
 			preview_output_init();
@@ -221,6 +411,22 @@ void OutputSettings::onFormAccepted()
 	} else {
 		preview_output_deinit();
 	}
+	if (last_config.SceneOutputs != config->SceneOutputs) {
+		obs_log(LOG_INFO, "Initializing Scene outputs");
+		scene_outputs_init();
+	}
+	if (last_config.RoutingOutputs != config->RoutingOutputs) {
+		// Routings that are only pointed to another source keep their receivers connected
+		obs_log(LOG_INFO, "Updating NDI routings");
+		routing_outputs_init();
+	}
+	if ((last_config.FinderGroups != config->FinderGroups) ||
+	    (last_config.FinderExtraIps != config->FinderExtraIps) ||
+	    (last_config.FinderFilter != config->FinderFilter) ||
+	    (last_config.FinderShowLocalSources != config->FinderShowLocalSources)) {
+		obs_log(LOG_INFO, "Restarting NDI source discovery");
+		NDIFinder::restart();
+	}
 }
 
 void OutputSettings::showEvent(QShowEvent *)
@@ -233,6 +439,12 @@ void OutputSettings::showEvent(QShowEvent *)
 	ui->mainOutputGroupBox->setChecked(config->OutputEnabled);
 	ui->mainOutputName->setText(config->OutputName);
 	ui->mainOutputGroups->setText(config->OutputGroups);
+	setConversionComboBoxValue(ui->mainOutputResolution, config->OutputResolution);
+	setConversionComboBoxValue(ui->mainOutputFramerate, config->OutputFramerate);
+	ui->mainOutputAlwaysSend->setChecked(config->OutputAlwaysSend);
+	ui->mainOutputClockVideo->setChecked(config->OutputClockVideo);
+	ui->mainOutputClockAudio->setChecked(config->OutputClockAudio);
+	ui->mainOutputDropFrames->setChecked(config->OutputDropFrames);
 
 	auto lastError = main_output_last_error();
 	ui->mainOutputLastError->setText(lastError);
@@ -245,6 +457,26 @@ void OutputSettings::showEvent(QShowEvent *)
 	ui->previewOutputGroupBox->setChecked(config->PreviewOutputEnabled);
 	ui->previewOutputName->setText(config->PreviewOutputName);
 	ui->previewOutputGroups->setText(config->PreviewOutputGroups);
+	setConversionComboBoxValue(ui->previewOutputResolution, config->PreviewOutputResolution);
+	setConversionComboBoxValue(ui->previewOutputFramerate, config->PreviewOutputFramerate);
+	ui->previewOutputAlwaysSend->setChecked(config->PreviewOutputAlwaysSend);
+	ui->previewOutputClockVideo->setChecked(config->PreviewOutputClockVideo);
+	ui->previewOutputDropFrames->setChecked(config->PreviewOutputDropFrames);
+
+	ui->finderGroups->setText(config->FinderGroups);
+	ui->finderExtraIps->setText(config->FinderExtraIps);
+	ui->finderFilter->setText(config->FinderFilter);
+	ui->finderShowLocalSources->setChecked(config->FinderShowLocalSources);
+
+	ui->sceneOutputsTable->setRowCount(0);
+	for (const auto &value : QJsonDocument::fromJson(config->SceneOutputs.toUtf8()).array()) {
+		addSceneOutputRow(ui->sceneOutputsTable, value.toObject());
+	}
+
+	ui->routingOutputsTable->setRowCount(0);
+	for (const auto &value : QJsonDocument::fromJson(config->RoutingOutputs.toUtf8()).array()) {
+		addRoutingOutputRow(ui->routingOutputsTable, value.toObject());
+	}
 
 	ui->tallyProgramCheckBox->setChecked(config->TallyProgramEnabled);
 	ui->tallyPreviewCheckBox->setChecked(config->TallyPreviewEnabled);
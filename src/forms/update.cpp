@@ -45,6 +45,8 @@ Inspiration(s):
 #include <QTimeZone>
 #include <QUrlQuery>
 
+#include <thread>
+
 #define UPDATE_TIMEOUT_SEC 10
 
 template<typename QEnum> const char *qEnumToString(const QEnum value)
@@ -281,9 +283,15 @@ QPointer<RemoteTextThread> update_request = nullptr;
 #endif
 QPointer<PluginUpdate> update_dialog = nullptr;
 
+// The module hash sent with update checks is computed once, off the UI thread, see updateCheckStart
+std::thread module_hash_thread;
+QString module_hash_sha256;
+bool module_hash_ready = false;
+bool module_hash_pending = false;
+
 bool isUpdatePendingOrShowing()
 {
-	return update_request ||
+	return update_request || module_hash_pending ||
 #ifdef UPDATE_REQUEST_QT
 	       update_reply ||
 #endif
@@ -395,6 +403,9 @@ void updateCheckStop()
 			update_request->exit(1);
 		}
 	}
+	if (module_hash_thread.joinable()) {
+		module_hash_thread.join();
+	}
 	obs_log(LOG_DEBUG, "-updateCheckStop()");
 }
 
@@ -441,10 +452,36 @@ bool updateCheckStart(UserRequestCallback userRequestCallback)
 			}
 		}
 	}
-	config->LastUpdateCheck(QDateTime::currentDateTime());
-
 	auto main_window = static_cast<QMainWindow *>(obs_frontend_get_main_window());
 
+	//
+	// Hashing the module file takes a while, so it is done on a thread and the check continues on the UI thread
+	// once the hash is known.
+	//
+	if (!module_hash_ready) {
+		module_hash_pending = true;
+		module_hash_thread = std::thread([main_window, userRequestCallback]() {
+			auto hash = GetObsCurrentModuleSHA256();
+			QMetaObject::invokeMethod(
+				main_window,
+				[hash, userRequestCallback]() {
+					if (module_hash_thread.joinable()) {
+						module_hash_thread.join();
+					}
+					module_hash_sha256 = hash;
+					module_hash_ready = true;
+					module_hash_pending = false;
+					updateCheckStart(userRequestCallback);
+				},
+				Qt::QueuedConnection);
+		});
+		obs_log(LOG_DEBUG, "updateCheckStart: hashing module in the background");
+		obs_log(LOG_DEBUG, "-%s", QT_TO_UTF8(methodSignature));
+		return true;
+	}
+
+	config->LastUpdateCheck(QDateTime::currentDateTime());
+
 //#define DIRECT_REQUEST_GITHUB
 #ifdef DIRECT_REQUEST_GITHUB
 	// Used to test directly hitting github instead of going through distroav.org firebase hosting+functions.
@@ -455,7 +492,6 @@ bool updateCheckStart(UserRequestCallback userRequestCallback)
 
 	auto pluginVersion = QString(PLUGIN_VERSION);
 	auto obsGuid = GetProgramGUID();
-	auto module_hash_sha256 = GetObsCurrentModuleSHA256();
 	auto userAgent = QString("DistroAV/%1 (OBS/%2 %3; %4; %5; %6) %7")
 				 .arg(pluginVersion)
 				 .arg(obs_get_version_string())
@@ -18,6 +18,8 @@
 #include "main-output.h"
 
 #include "plugin-main.h"
+#include "ndi-video-converter.h"
+
 #include <random>
 
 struct main_output {
@@ -193,6 +195,12 @@ void main_output_init()
 		obs_data_t *output_settings = obs_data_create();
 		obs_data_set_string(output_settings, "ndi_name", QT_TO_UTF8(output_name));
 		obs_data_set_string(output_settings, "ndi_groups", QT_TO_UTF8(output_groups));
+		ndi_converter_set_output_settings(output_settings, QT_TO_UTF8(config->OutputResolution),
+						  QT_TO_UTF8(config->OutputFramerate));
+		obs_data_set_bool(output_settings, "always_send", config->OutputAlwaysSend);
+		obs_data_set_bool(output_settings, "clock_video", config->OutputClockVideo);
+		obs_data_set_bool(output_settings, "clock_audio", config->OutputClockAudio);
+		obs_data_set_bool(output_settings, "drop_frames", config->OutputDropFrames);
 
 		context.output = obs_output_create("ndi_output", "NDI Main Output", output_settings, nullptr);
 		obs_data_release(output_settings);
@@ -0,0 +1,126 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-audio.h"
+#include "ndi-buffer-pool.h"
+
+#include "plugin-support.h"
+
+#include <util/base.h>
+#include <util/bmem.h>
+
+#include <string.h>
+
+size_t ndi_audio_fltp_buffer_size(uint32_t channels, uint32_t samples)
+{
+	return (size_t)channels * samples * sizeof(float);
+}
+
+// Distance between consecutive planes if they are all equally spaced and at least a channel apart, 0 otherwise
+static ptrdiff_t ndi_audio_plane_spacing(uint8_t *const planes[], int channels, size_t channel_bytes)
+{
+	if (channels < 2)
+		return planes[0] ? (ptrdiff_t)channel_bytes : 0;
+
+	// Planes may come from separate allocations, compare addresses rather than subtracting pointers
+	uintptr_t first = (uintptr_t)planes[0];
+	if (!first || (uintptr_t)planes[1] < first)
+		return 0;
+	uintptr_t spacing = (uintptr_t)planes[1] - first;
+	if (spacing < channel_bytes || spacing > INT32_MAX || spacing % sizeof(float))
+		return 0;
+
+	for (int i = 2; i < channels; ++i) {
+		if ((uintptr_t)planes[i] != first + i * spacing)
+			return 0;
+	}
+	return (ptrdiff_t)spacing;
+}
+
+void ndi_audio_set_fltp(NDIlib_audio_frame_v3_t *audio_frame, uint8_t *const planes[], uint8_t **buffer,
+			size_t *buffer_size)
+{
+	audio_frame->FourCC = NDIlib_FourCC_audio_type_FLTP;
+
+	const int channels = audio_frame->no_channels;
+	const size_t channel_bytes = (size_t)audio_frame->no_samples * sizeof(float);
+
+	ptrdiff_t spacing = ndi_audio_plane_spacing(planes, channels, channel_bytes);
+	if (spacing) {
+		// send_send_audio_v3 is synchronous, the OBS planes outlive the call
+		audio_frame->p_data = planes[0];
+		audio_frame->channel_stride_in_bytes = (int)spacing;
+		return;
+	}
+
+	const size_t data_size = channels * channel_bytes;
+	if (data_size > *buffer_size) {
+		obs_log(LOG_DEBUG, "ndi_audio_set_fltp: growing gather buffer from %zu to %zu bytes", *buffer_size,
+			data_size);
+		ndi_buffer_pool_free(*buffer, *buffer_size);
+		*buffer = ndi_buffer_pool_alloc(data_size, buffer_size);
+		if (!*buffer) {
+			// Sent as an empty frame
+			audio_frame->p_data = nullptr;
+			audio_frame->no_samples = 0;
+			return;
+		}
+	}
+
+	for (int i = 0; i < channels; ++i)
+		memcpy(*buffer + i * channel_bytes, planes[i], channel_bytes);
+
+	audio_frame->p_data = *buffer;
+	audio_frame->channel_stride_in_bytes = (int)channel_bytes;
+}
+
+void ndi_audio_batch_configure(ndi_audio_batch_t *batch, uint32_t channels, uint32_t capacity)
+{
+	if (batch->data && batch->channels == channels && batch->capacity == capacity)
+		return;
+
+	bfree(batch->data);
+	batch->data = (uint8_t *)bmalloc(ndi_audio_fltp_buffer_size(channels, capacity));
+	batch->channels = channels;
+	batch->capacity = capacity;
+	batch->samples = 0;
+}
+
+void ndi_audio_batch_append(ndi_audio_batch_t *batch, uint8_t *const planes[], uint32_t samples)
+{
+	const size_t plane_bytes = (size_t)batch->capacity * sizeof(float);
+	const size_t offset = (size_t)batch->samples * sizeof(float);
+	for (uint32_t i = 0; i < batch->channels; ++i)
+		memcpy(batch->data + i * plane_bytes + offset, planes[i], (size_t)samples * sizeof(float));
+	batch->samples += samples;
+}
+
+void ndi_audio_batch_set_frame(ndi_audio_batch_t *batch, NDIlib_audio_frame_v3_t *audio_frame)
+{
+	audio_frame->FourCC = NDIlib_FourCC_audio_type_FLTP;
+	audio_frame->no_channels = batch->channels;
+	audio_frame->no_samples = batch->samples;
+	audio_frame->p_data = batch->data;
+	audio_frame->channel_stride_in_bytes = (int)(batch->capacity * sizeof(float));
+}
+
+void ndi_audio_batch_free(ndi_audio_batch_t *batch)
+{
+	bfree(batch->data);
+	batch->data = nullptr;
+	batch->samples = 0;
+}
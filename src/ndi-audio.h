@@ -0,0 +1,78 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Processing.NDI.Lib.h>
+
+/**
+ * Planar float audio helpers shared by the NDI Output and the NDI Filters.
+ */
+
+/**
+ * Size in bytes of a FLTP gather buffer holding frames of up to `samples` samples.
+ * Callers allocate it once up front so the audio callback does not allocate.
+ */
+size_t ndi_audio_fltp_buffer_size(uint32_t channels, uint32_t samples);
+
+/**
+ * Point an NDI FLTP audio frame at OBS planar float audio.
+ * When the OBS planes are equally spaced in memory (as in OBS's own mix buffers), the frame references them in
+ * place with that spacing as channel stride and nothing is copied. Otherwise the planes are gathered into buffer,
+ * which is only grown if a frame is larger than it was sized for.
+ * @param audio_frame Frame with no_channels and no_samples set; p_data and channel_stride_in_bytes are filled in
+ * @param planes OBS channel planes
+ * @param buffer Gather buffer, from ndi_buffer_pool_alloc (may be replaced by a larger one)
+ * @param buffer_size Gather buffer capacity in bytes (updated when replaced)
+ */
+void ndi_audio_set_fltp(NDIlib_audio_frame_v3_t *audio_frame, uint8_t *const planes[], uint8_t **buffer,
+			size_t *buffer_size);
+
+/**
+ * Planar float audio gathered from several OBS blocks, to be sent as one larger NDI frame.
+ */
+typedef struct {
+	// Planes back to back, capacity samples each
+	uint8_t *data;
+	uint32_t channels;
+	uint32_t capacity;
+	// Samples queued in each plane
+	uint32_t samples;
+} ndi_audio_batch_t;
+
+/**
+ * Size the batch for channels planes of capacity samples. Queued samples are dropped if the layout changes.
+ */
+void ndi_audio_batch_configure(ndi_audio_batch_t *batch, uint32_t channels, uint32_t capacity);
+
+/**
+ * Append an OBS block to the batch.
+ * @param planes OBS channel planes
+ * @param samples Samples in each plane, no more than the room left in the batch
+ */
+void ndi_audio_batch_append(ndi_audio_batch_t *batch, uint8_t *const planes[], uint32_t samples);
+
+/**
+ * Point an NDI FLTP audio frame at the queued samples. The batch must not change until the frame is sent.
+ * @param audio_frame Frame whose no_channels, no_samples, p_data and channel_stride_in_bytes are filled in
+ */
+void ndi_audio_batch_set_frame(ndi_audio_batch_t *batch, NDIlib_audio_frame_v3_t *audio_frame);
+
+void ndi_audio_batch_free(ndi_audio_batch_t *batch);
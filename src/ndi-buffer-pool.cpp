@@ -0,0 +1,171 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-buffer-pool.h"
+
+#include "plugin-support.h"
+
+#include <util/base.h>
+#include <util/threading.h>
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Smallest class; below it, audio gather buffers and the like all share one class
+#define NDI_BUFFER_POOL_MIN_SIZE 4096
+// Four classes per power of two, up to 3.5 GB; larger buffers are not pooled
+#define NDI_BUFFER_POOL_CLASSES 80
+// Free buffers kept per class: a few instances' worth of send buffers of one frame size
+#define NDI_BUFFER_POOL_CLASS_BUFFERS 8
+// Free memory kept over all classes
+#define NDI_BUFFER_POOL_MAX_FREE_BYTES ((size_t)512 * 1024 * 1024)
+// Buffers at least this large are aligned for, and offered to, transparent huge pages
+#define NDI_BUFFER_POOL_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+// Free buffers of a class are chained through their first bytes
+typedef struct ndi_free_buffer {
+	struct ndi_free_buffer *next;
+} ndi_free_buffer_t;
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ndi_free_buffer_t *free_lists[NDI_BUFFER_POOL_CLASSES] = {};
+static int free_counts[NDI_BUFFER_POOL_CLASSES] = {};
+static size_t free_bytes = 0;
+static long long pool_hits = 0;
+static long long pool_misses = 0;
+
+static size_t ndi_buffer_pool_class_size(int index)
+{
+	return ((size_t)NDI_BUFFER_POOL_MIN_SIZE << (index / 4)) / 4 * (4 + index % 4);
+}
+
+// Class of the smallest buffers holding size bytes, -1 when too large to pool
+static int ndi_buffer_pool_class(size_t size)
+{
+	for (int i = 0; i < NDI_BUFFER_POOL_CLASSES; ++i) {
+		if (ndi_buffer_pool_class_size(i) >= size)
+			return i;
+	}
+	return -1;
+}
+
+static uint8_t *ndi_buffer_pool_system_alloc(size_t size)
+{
+	const size_t alignment = size >= NDI_BUFFER_POOL_HUGE_PAGE_SIZE ? NDI_BUFFER_POOL_HUGE_PAGE_SIZE
+									 : NDI_BUFFER_POOL_ALIGNMENT;
+#ifdef _WIN32
+	// Large pages need the "Lock pages in memory" privilege, which OBS users do not have
+	return (uint8_t *)_aligned_malloc(size, alignment);
+#else
+	void *data = nullptr;
+	if (posix_memalign(&data, alignment, size) != 0)
+		return nullptr;
+#ifdef __linux__
+	// Only a hint, ignored unless transparent huge pages are set to "madvise" or "always"
+	if (alignment == NDI_BUFFER_POOL_HUGE_PAGE_SIZE)
+		madvise(data, size, MADV_HUGEPAGE);
+#endif
+	return (uint8_t *)data;
+#endif
+}
+
+static void ndi_buffer_pool_system_free(uint8_t *data)
+{
+#ifdef _WIN32
+	_aligned_free(data);
+#else
+	free(data);
+#endif
+}
+
+uint8_t *ndi_buffer_pool_alloc(size_t size, size_t *capacity)
+{
+	const int index = ndi_buffer_pool_class(size);
+	if (index >= 0) {
+		pthread_mutex_lock(&pool_mutex);
+		ndi_free_buffer_t *buffer = free_lists[index];
+		if (buffer) {
+			free_lists[index] = buffer->next;
+			free_counts[index]--;
+			free_bytes -= ndi_buffer_pool_class_size(index);
+			pool_hits++;
+			pthread_mutex_unlock(&pool_mutex);
+			*capacity = ndi_buffer_pool_class_size(index);
+			return (uint8_t *)buffer;
+		}
+		pool_misses++;
+		pthread_mutex_unlock(&pool_mutex);
+		size = ndi_buffer_pool_class_size(index);
+	}
+
+	uint8_t *data = ndi_buffer_pool_system_alloc(size);
+	if (!data) {
+		obs_log(LOG_ERROR, "ERR-434 - Failed to allocate a %zu bytes frame buffer", size);
+		*capacity = 0;
+		return nullptr;
+	}
+	obs_log(LOG_DEBUG, "ndi_buffer_pool_alloc: allocated %zu bytes", size);
+	*capacity = size;
+	return data;
+}
+
+void ndi_buffer_pool_free(uint8_t *data, size_t capacity)
+{
+	if (!data)
+		return;
+
+	// Only buffers of an exact class size came from a class
+	const int index = ndi_buffer_pool_class(capacity);
+	if (index >= 0 && ndi_buffer_pool_class_size(index) == capacity) {
+		pthread_mutex_lock(&pool_mutex);
+		if (free_counts[index] < NDI_BUFFER_POOL_CLASS_BUFFERS &&
+		    free_bytes + capacity <= NDI_BUFFER_POOL_MAX_FREE_BYTES) {
+			auto buffer = (ndi_free_buffer_t *)data;
+			buffer->next = free_lists[index];
+			free_lists[index] = buffer;
+			free_counts[index]++;
+			free_bytes += capacity;
+			pthread_mutex_unlock(&pool_mutex);
+			return;
+		}
+		pthread_mutex_unlock(&pool_mutex);
+	}
+
+	ndi_buffer_pool_system_free(data);
+}
+
+void ndi_buffer_pool_shutdown()
+{
+	pthread_mutex_lock(&pool_mutex);
+	obs_log(LOG_DEBUG, "ndi_buffer_pool_shutdown: %lld allocations reused, %lld new, freeing %zu bytes", pool_hits,
+		pool_misses, free_bytes);
+	for (int i = 0; i < NDI_BUFFER_POOL_CLASSES; ++i) {
+		while (free_lists[i]) {
+			ndi_free_buffer_t *buffer = free_lists[i];
+			free_lists[i] = buffer->next;
+			ndi_buffer_pool_system_free((uint8_t *)buffer);
+		}
+		free_counts[i] = 0;
+	}
+	free_bytes = 0;
+	pthread_mutex_unlock(&pool_mutex);
+}
@@ -0,0 +1,52 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Buffer pool: frame and conversion buffers shared by all outputs, filters and converters.
+ * Sizes are rounded up to a size class (four per power of two, so at most 25% is wasted) and freed buffers are
+ * kept for the next allocation of the same class, so instances being recreated (scene collection switch, output
+ * restart) reuse the memory of the ones they replace instead of going back to the system allocator.
+ * Buffers are aligned for SIMD; on Linux, large ones are offered to transparent huge pages.
+ */
+
+// Alignment of every pooled buffer, enough for AVX-512 loads and a cache line
+#define NDI_BUFFER_POOL_ALIGNMENT 64
+
+/**
+ * Get a buffer of at least size bytes. The content is not initialized.
+ * @param size Requested size
+ * @param capacity Output: actual size of the buffer, to pass back to ndi_buffer_pool_free
+ * @return The buffer, nullptr if the allocation failed
+ */
+uint8_t *ndi_buffer_pool_alloc(size_t size, size_t *capacity);
+
+/**
+ * Return a buffer to the pool. Buffers over the pool limits are freed.
+ * @param data Buffer from ndi_buffer_pool_alloc, may be nullptr
+ * @param capacity Capacity returned with the buffer
+ */
+void ndi_buffer_pool_free(uint8_t *data, size_t capacity);
+
+/**
+ * Free all pooled buffers. Called on module unload, after all their users are destroyed.
+ */
+void ndi_buffer_pool_shutdown();
@@ -0,0 +1,382 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-color-convert.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NDI_CONVERT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NDI_TARGET_AVX2
+#else
+#define NDI_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NDI_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+static inline uint32_t i444_uyvy_width(uint32_t in_linesize[], uint32_t out_linesize[])
+{
+	// UYVY is 2 bytes per pixel; never read past the source row nor write past the destination row
+	uint32_t width = out_linesize[0] / 2;
+	return in_linesize[0] < width ? in_linesize[0] : width;
+}
+
+// Converts pixels [x, width) of one row; used for the scalar path and the SIMD tails
+static inline void i444_to_uyvy_row(const uint8_t *y_row, const uint8_t *u_row, const uint8_t *v_row,
+				    uint8_t *out_row, uint32_t x, uint32_t width)
+{
+	for (; x + 1 < width; x += 2) {
+		// Quality loss here. Some chroma samples are ignored.
+		uint8_t *out = out_row + (size_t)x * 2;
+		out[0] = u_row[x];
+		out[1] = y_row[x];
+		out[2] = v_row[x];
+		out[3] = y_row[x + 1];
+	}
+}
+
+void convert_i444_to_uyvy(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+			  uint8_t *output[], uint32_t out_linesize[])
+{
+	uint32_t width = i444_uyvy_width(in_linesize, out_linesize);
+	for (uint32_t y = start_y; y < end_y; ++y) {
+		i444_to_uyvy_row(input[0] + (size_t)y * in_linesize[0], input[1] + (size_t)y * in_linesize[1],
+				 input[2] + (size_t)y * in_linesize[2], output[0] + (size_t)y * out_linesize[0], 0,
+				 width);
+	}
+}
+
+#if NDI_CONVERT_X86
+static void convert_i444_to_uyvy_sse2(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+				      uint8_t *output[], uint32_t out_linesize[])
+{
+	uint32_t width = i444_uyvy_width(in_linesize, out_linesize);
+	const __m128i even_bytes = _mm_set1_epi16(0x00FF);
+	for (uint32_t y = start_y; y < end_y; ++y) {
+		const uint8_t *y_row = input[0] + (size_t)y * in_linesize[0];
+		const uint8_t *u_row = input[1] + (size_t)y * in_linesize[1];
+		const uint8_t *v_row = input[2] + (size_t)y * in_linesize[2];
+		uint8_t *out_row = output[0] + (size_t)y * out_linesize[0];
+
+		// 16 pixels per iteration: U0 V0 U2 V2 ... interleaved with Y0 Y1 Y2 ... gives U0 Y0 V0 Y1 U2 Y2 V2 Y3
+		uint32_t x = 0;
+		for (; x + 16 <= width; x += 16) {
+			__m128i luma = _mm_loadu_si128((const __m128i *)(y_row + x));
+			__m128i u = _mm_and_si128(_mm_loadu_si128((const __m128i *)(u_row + x)), even_bytes);
+			__m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i *)(v_row + x)), even_bytes);
+			__m128i chroma = _mm_or_si128(u, _mm_slli_epi16(v, 8));
+			_mm_storeu_si128((__m128i *)(out_row + (size_t)x * 2), _mm_unpacklo_epi8(chroma, luma));
+			_mm_storeu_si128((__m128i *)(out_row + (size_t)x * 2 + 16), _mm_unpackhi_epi8(chroma, luma));
+		}
+		i444_to_uyvy_row(y_row, u_row, v_row, out_row, x, width);
+	}
+}
+
+NDI_TARGET_AVX2 static void convert_i444_to_uyvy_avx2(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y,
+						      uint32_t end_y, uint8_t *output[], uint32_t out_linesize[])
+{
+	uint32_t width = i444_uyvy_width(in_linesize, out_linesize);
+	const __m256i even_bytes = _mm256_set1_epi16(0x00FF);
+	for (uint32_t y = start_y; y < end_y; ++y) {
+		const uint8_t *y_row = input[0] + (size_t)y * in_linesize[0];
+		const uint8_t *u_row = input[1] + (size_t)y * in_linesize[1];
+		const uint8_t *v_row = input[2] + (size_t)y * in_linesize[2];
+		uint8_t *out_row = output[0] + (size_t)y * out_linesize[0];
+
+		// 32 pixels per iteration, same as SSE2; unpack works per 128-bit lane, so reorder the lanes after
+		uint32_t x = 0;
+		for (; x + 32 <= width; x += 32) {
+			__m256i luma = _mm256_loadu_si256((const __m256i *)(y_row + x));
+			__m256i u = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(u_row + x)), even_bytes);
+			__m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(v_row + x)), even_bytes);
+			__m256i chroma = _mm256_or_si256(u, _mm256_slli_epi16(v, 8));
+			__m256i lo = _mm256_unpacklo_epi8(chroma, luma); // pixels 0-7, 16-23
+			__m256i hi = _mm256_unpackhi_epi8(chroma, luma); // pixels 8-15, 24-31
+			_mm256_storeu_si256((__m256i *)(out_row + (size_t)x * 2),
+					    _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256((__m256i *)(out_row + (size_t)x * 2 + 32),
+					    _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+		i444_to_uyvy_row(y_row, u_row, v_row, out_row, x, width);
+	}
+}
+
+static bool cpu_has_avx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int regs[4];
+	__cpuid(regs, 0);
+	if (regs[0] < 7)
+		return false;
+	__cpuid(regs, 1);
+	bool osxsave = (regs[2] & (1 << 27)) != 0;
+	bool avx = (regs[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+		return false;
+	__cpuidex(regs, 7, 0);
+	return (regs[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#if NDI_CONVERT_NEON
+static void convert_i444_to_uyvy_neon(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+				      uint8_t *output[], uint32_t out_linesize[])
+{
+	uint32_t width = i444_uyvy_width(in_linesize, out_linesize);
+	for (uint32_t y = start_y; y < end_y; ++y) {
+		const uint8_t *y_row = input[0] + (size_t)y * in_linesize[0];
+		const uint8_t *u_row = input[1] + (size_t)y * in_linesize[1];
+		const uint8_t *v_row = input[2] + (size_t)y * in_linesize[2];
+		uint8_t *out_row = output[0] + (size_t)y * out_linesize[0];
+
+		// 32 pixels per iteration: de-interleave even/odd samples, then store U Y0 V Y1 interleaved
+		uint32_t x = 0;
+		for (; x + 32 <= width; x += 32) {
+			uint8x16x2_t luma = vld2q_u8(y_row + x);
+			uint8x16x2_t u = vld2q_u8(u_row + x);
+			uint8x16x2_t v = vld2q_u8(v_row + x);
+			uint8x16x4_t uyvy;
+			uyvy.val[0] = u.val[0];
+			uyvy.val[1] = luma.val[0];
+			uyvy.val[2] = v.val[0];
+			uyvy.val[3] = luma.val[1];
+			vst4q_u8(out_row + (size_t)x * 2, uyvy);
+		}
+		i444_to_uyvy_row(y_row, u_row, v_row, out_row, x, width);
+	}
+}
+#endif
+
+uyvy_conv_function ndi_select_i444_to_uyvy(const char **impl_name)
+{
+	const char *name = "scalar";
+	uyvy_conv_function function = convert_i444_to_uyvy;
+
+#if NDI_CONVERT_X86
+	if (cpu_has_avx2()) {
+		name = "AVX2";
+		function = convert_i444_to_uyvy_avx2;
+	} else {
+		name = "SSE2";
+		function = convert_i444_to_uyvy_sse2;
+	}
+#elif NDI_CONVERT_NEON
+	name = "NEON";
+	function = convert_i444_to_uyvy_neon;
+#endif
+
+	if (impl_name)
+		*impl_name = name;
+	return function;
+}
+
+//
+// High bit depth to P216. The work is mostly copying, so each converter is a template over three row
+// primitives (10-bit LSB to MSB shift, U/V interleave, even chroma pair selection) with scalar and SIMD versions.
+//
+typedef void (*row_shift_function)(const uint16_t *src, uint16_t *dst, uint32_t count);
+typedef void (*row_interleave_function)(const uint16_t *u, const uint16_t *v, uint16_t *dst, uint32_t count);
+typedef void (*row_even_pairs_function)(const uint32_t *src, uint32_t *dst, uint32_t count);
+
+static void shift_row_scalar(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+	for (uint32_t x = 0; x < count; ++x)
+		dst[x] = (uint16_t)(src[x] << 6);
+}
+
+static void interleave_row_scalar(const uint16_t *u, const uint16_t *v, uint16_t *dst, uint32_t count)
+{
+	for (uint32_t x = 0; x < count; ++x) {
+		dst[x * 2] = (uint16_t)(u[x] << 6);
+		dst[x * 2 + 1] = (uint16_t)(v[x] << 6);
+	}
+}
+
+static void even_pairs_row_scalar(const uint32_t *src, uint32_t *dst, uint32_t count)
+{
+	for (uint32_t x = 0; x < count; ++x)
+		dst[x] = src[x * 2];
+}
+
+#if NDI_CONVERT_X86
+static void shift_row_sse2(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8)
+		_mm_storeu_si128((__m128i *)(dst + x), _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(src + x)), 6));
+	shift_row_scalar(src + x, dst + x, count - x);
+}
+
+static void interleave_row_sse2(const uint16_t *u, const uint16_t *v, uint16_t *dst, uint32_t count)
+{
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8) {
+		__m128i u8 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(u + x)), 6);
+		__m128i v8 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(v + x)), 6);
+		_mm_storeu_si128((__m128i *)(dst + x * 2), _mm_unpacklo_epi16(u8, v8));
+		_mm_storeu_si128((__m128i *)(dst + x * 2 + 8), _mm_unpackhi_epi16(u8, v8));
+	}
+	interleave_row_scalar(u + x, v + x, dst + x * 2, count - x);
+}
+
+static void even_pairs_row_sse2(const uint32_t *src, uint32_t *dst, uint32_t count)
+{
+	uint32_t x = 0;
+	for (; x + 4 <= count; x += 4) {
+		__m128i a = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(src + x * 2)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128i b = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(src + x * 2 + 4)),
+					      _MM_SHUFFLE(2, 0, 2, 0));
+		_mm_storeu_si128((__m128i *)(dst + x), _mm_unpacklo_epi64(a, b));
+	}
+	even_pairs_row_scalar(src + x * 2, dst + x, count - x);
+}
+#endif
+
+#if NDI_CONVERT_NEON
+static void shift_row_neon(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8)
+		vst1q_u16(dst + x, vshlq_n_u16(vld1q_u16(src + x), 6));
+	shift_row_scalar(src + x, dst + x, count - x);
+}
+
+static void interleave_row_neon(const uint16_t *u, const uint16_t *v, uint16_t *dst, uint32_t count)
+{
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8) {
+		uint16x8x2_t uv;
+		uv.val[0] = vshlq_n_u16(vld1q_u16(u + x), 6);
+		uv.val[1] = vshlq_n_u16(vld1q_u16(v + x), 6);
+		vst2q_u16(dst + x * 2, uv);
+	}
+	interleave_row_scalar(u + x, v + x, dst + x * 2, count - x);
+}
+
+static void even_pairs_row_neon(const uint32_t *src, uint32_t *dst, uint32_t count)
+{
+	uint32_t x = 0;
+	for (; x + 4 <= count; x += 4)
+		vst1q_u32(dst + x, vld2q_u32(src + x * 2).val[0]);
+	even_pairs_row_scalar(src + x * 2, dst + x, count - x);
+}
+#endif
+
+static inline uint32_t p216_width(uint32_t in_linesize[], uint32_t out_linesize[])
+{
+	// 2 bytes per Y sample; never read past the source row nor write past the destination row
+	uint32_t width = out_linesize[0] / 2;
+	return (in_linesize[0] / 2) < width ? in_linesize[0] / 2 : width;
+}
+
+static inline uint8_t *row_at(uint8_t *plane, uint32_t linesize, uint32_t y)
+{
+	return plane + (size_t)y * linesize;
+}
+
+// P010 (4:2:0) and P216 (4:2:2) are already MSB aligned and interleaved: copy, line doubling 4:2:0 chroma
+template<uint32_t ChromaShiftY>
+static void convert_semiplanar_to_p216(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+				       uint8_t *output[], uint32_t out_linesize[])
+{
+	size_t row_bytes = (size_t)p216_width(in_linesize, out_linesize) * 2;
+	for (uint32_t y = start_y; y < end_y; ++y) {
+		memcpy(row_at(output[0], out_linesize[0], y), row_at(input[0], in_linesize[0], y), row_bytes);
+		memcpy(row_at(output[1], out_linesize[1], y), row_at(input[1], in_linesize[1], y >> ChromaShiftY),
+		       row_bytes);
+	}
+}
+
+template<row_even_pairs_function EvenPairs>
+static void convert_p416_to_p216(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+				 uint8_t *output[], uint32_t out_linesize[])
+{
+	uint32_t width = p216_width(in_linesize, out_linesize);
+	for (uint32_t y = start_y; y < end_y; ++y) {
+		memcpy(row_at(output[0], out_linesize[0], y), row_at(input[0], in_linesize[0], y), (size_t)width * 2);
+		EvenPairs((const uint32_t *)row_at(input[1], in_linesize[1], y),
+			  (uint32_t *)row_at(output[1], out_linesize[1], y), width / 2);
+	}
+}
+
+template<row_shift_function Shift, row_interleave_function Interleave>
+static void convert_i010_to_p216(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+				 uint8_t *output[], uint32_t out_linesize[])
+{
+	uint32_t width = p216_width(in_linesize, out_linesize);
+	for (uint32_t y = start_y; y < end_y; ++y) {
+		Shift((const uint16_t *)row_at(input[0], in_linesize[0], y),
+		      (uint16_t *)row_at(output[0], out_linesize[0], y), width);
+		Interleave((const uint16_t *)row_at(input[1], in_linesize[1], y / 2),
+			   (const uint16_t *)row_at(input[2], in_linesize[2], y / 2),
+			   (uint16_t *)row_at(output[1], out_linesize[1], y), width / 2);
+	}
+}
+
+uyvy_conv_function ndi_select_to_p216(enum video_format format, const char **impl_name)
+{
+	const char *name = "scalar";
+	uyvy_conv_function function = nullptr;
+	switch (format) {
+	case VIDEO_FORMAT_P010:
+		// memcpy is already vectorized
+		name = "copy";
+		function = convert_semiplanar_to_p216<1>;
+		break;
+	case VIDEO_FORMAT_P216:
+		name = "copy";
+		function = convert_semiplanar_to_p216<0>;
+		break;
+	case VIDEO_FORMAT_P416:
+#if NDI_CONVERT_X86
+		name = "SSE2";
+		function = convert_p416_to_p216<even_pairs_row_sse2>;
+#elif NDI_CONVERT_NEON
+		name = "NEON";
+		function = convert_p416_to_p216<even_pairs_row_neon>;
+#else
+		function = convert_p416_to_p216<even_pairs_row_scalar>;
+#endif
+		break;
+	case VIDEO_FORMAT_I010:
+#if NDI_CONVERT_X86
+		name = "SSE2";
+		function = convert_i010_to_p216<shift_row_sse2, interleave_row_sse2>;
+#elif NDI_CONVERT_NEON
+		name = "NEON";
+		function = convert_i010_to_p216<shift_row_neon, interleave_row_neon>;
+#else
+		function = convert_i010_to_p216<shift_row_scalar, interleave_row_scalar>;
+#endif
+		break;
+	default:
+		return nullptr;
+	}
+
+	if (impl_name)
+		*impl_name = name;
+	return function;
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <media-io/video-io.h>
+
+/**
+ * CPU colour conversion kernels for the NDI Output, when OBS outputs a format NDI cannot send as-is.
+ * Each kernel has a scalar reference implementation and, where it pays off, SIMD variants
+ * (SSE2/AVX2 on x86, NEON on ARM64) selected once at runtime from the CPU features.
+ */
+
+/**
+ * Convert rows [start_y, end_y) of a frame. Rows are independent, so a frame can be split in stripes.
+ * @param input Source planes
+ * @param in_linesize Source line sizes
+ * @param start_y First row to convert
+ * @param end_y Row after the last row to convert
+ * @param output Destination planes (not offset to start_y)
+ * @param out_linesize Destination line sizes; the first one's pixel width bounds the conversion
+ */
+typedef void (*uyvy_conv_function)(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+				   uint8_t *output[], uint32_t out_linesize[]);
+
+/**
+ * Scalar I444 to UYVY conversion (even chroma samples are kept). Reference for the SIMD variants.
+ */
+void convert_i444_to_uyvy(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
+			  uint8_t *output[], uint32_t out_linesize[]);
+
+/**
+ * Fastest I444 to UYVY conversion supported by this CPU.
+ * @param impl_name Output name of the selected implementation, for logging (may be NULL)
+ */
+uyvy_conv_function ndi_select_i444_to_uyvy(const char **impl_name);
+
+/**
+ * Fastest conversion of a high bit depth OBS format (P010, I010, P216, P416) to NDI P216:
+ * 16-bit MSB aligned Y plane (output[0]) and interleaved half width UV plane (output[1]), full height.
+ * 4:2:0 chroma rows are line doubled; 4:4:4 chroma keeps even samples.
+ * @param format Source format
+ * @param impl_name Output name of the selected implementation, for logging (may be NULL)
+ * @return NULL if the format has no P216 conversion
+ */
+uyvy_conv_function ndi_select_to_p216(enum video_format format, const char **impl_name);
@@ -0,0 +1,238 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-control.h"
+
+#include "plugin-main.h"
+
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// Minimum time between two PTZ commands to the same receiver; changes in between are coalesced
+#define NDI_CONTROL_PTZ_INTERVAL_NS 20000000ULL
+// How long the control thread sleeps when nothing is pending
+#define NDI_CONTROL_IDLE_WAIT_MS 1000
+// PTZ changes smaller than this are not sent
+#define NDI_CONTROL_PTZ_TOLERANCE 0.001f
+
+struct ndi_control {
+	obs_source_t *source;
+
+	// Wanted state, written by the setters
+	std::atomic<bool> ptz_enabled;
+	std::atomic<float> pan;
+	std::atomic<float> tilt;
+	std::atomic<float> zoom;
+	std::atomic<bool> on_preview;
+	std::atomic<bool> on_program;
+
+	// Held while a command is sent, so the capture thread can swap or destroy its receiver safely
+	pthread_mutex_t mutex;
+	NDIlib_recv_instance_t receiver;
+	bool receiver_changed;
+
+	// Last state sent to the receiver, control thread only
+	NDIlib_tally_t sent_tally;
+	bool ptz_sent;
+	float sent_pan;
+	float sent_tilt;
+	float sent_zoom;
+	uint64_t last_ptz_ns;
+};
+
+static struct {
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	volatile bool running = false;
+	pthread_t thread;
+	os_event_t *wake_event = nullptr;
+	// Held by the control thread for a whole pass, so destroy waits for any command in flight
+	pthread_mutex_t list_mutex = PTHREAD_MUTEX_INITIALIZER;
+	std::vector<ndi_control_t *> controls;
+} control_thread;
+
+/**
+ * Send the pending commands of a control.
+ * @return Time in ns until a coalesced PTZ command can be sent, 0 if nothing is pending
+ */
+static uint64_t ndi_control_step(ndi_control_t *c, uint64_t now_ns)
+{
+	uint64_t pending_ns = 0;
+
+	pthread_mutex_lock(&c->mutex);
+	if (c->receiver) {
+		auto obs_source_name = obs_source_get_name(c->source);
+		auto config = Config::Current();
+
+		if (c->receiver_changed) {
+			// A new receiver starts with tally off and no PTZ position
+			c->receiver_changed = false;
+			c->sent_tally = NDIlib_tally_t(false, false);
+			c->ptz_sent = false;
+		}
+
+		//
+		// Tally
+		//
+		NDIlib_tally_t tally(c->on_program, c->on_preview);
+		if ((config->TallyPreviewEnabled && tally.on_preview != c->sent_tally.on_preview) ||
+		    (config->TallyProgramEnabled && tally.on_program != c->sent_tally.on_program)) {
+			c->sent_tally = tally;
+			obs_log(LOG_INFO, "'%s': Tally status : on_preview=%d, on_program=%d", obs_source_name,
+				tally.on_preview, tally.on_program);
+			obs_log(LOG_DEBUG, "'%s' ndi_control_step: Sending tally on_preview=%d, on_program=%d",
+				obs_source_name, tally.on_preview, tally.on_program);
+			ndiLib->recv_set_tally(c->receiver, &tally);
+		}
+
+		//
+		// PTZ: only the latest position is sent, rate limited
+		//
+		if (c->ptz_enabled) {
+			float pan = c->pan;
+			float tilt = c->tilt;
+			float zoom = c->zoom;
+			if (!c->ptz_sent || fabs(pan - c->sent_pan) > NDI_CONTROL_PTZ_TOLERANCE ||
+			    fabs(tilt - c->sent_tilt) > NDI_CONTROL_PTZ_TOLERANCE ||
+			    fabs(zoom - c->sent_zoom) > NDI_CONTROL_PTZ_TOLERANCE) {
+				uint64_t elapsed_ns = now_ns - c->last_ptz_ns;
+				if (c->last_ptz_ns && elapsed_ns < NDI_CONTROL_PTZ_INTERVAL_NS) {
+					pending_ns = NDI_CONTROL_PTZ_INTERVAL_NS - elapsed_ns;
+				} else {
+					c->ptz_sent = true;
+					c->sent_pan = pan;
+					c->sent_tilt = tilt;
+					c->sent_zoom = zoom;
+					c->last_ptz_ns = now_ns;
+					if (ndiLib->recv_ptz_is_supported(c->receiver)) {
+						obs_log(LOG_DEBUG, "'%s' ndi_control_step: Sending PTZ %f, %f, %f",
+							obs_source_name, pan, tilt, zoom);
+						ndiLib->recv_ptz_pan_tilt(c->receiver, pan, tilt);
+						ndiLib->recv_ptz_zoom(c->receiver, zoom);
+					}
+				}
+			}
+		}
+	}
+	pthread_mutex_unlock(&c->mutex);
+
+	return pending_ns;
+}
+
+static void *ndi_control_thread(void *)
+{
+	os_set_thread_name("distroav-ndi-control");
+
+	while (control_thread.running) {
+		uint64_t wait_ns = 0;
+
+		pthread_mutex_lock(&control_thread.list_mutex);
+		uint64_t now_ns = os_gettime_ns();
+		for (auto c : control_thread.controls) {
+			uint64_t pending_ns = ndi_control_step(c, now_ns);
+			if (pending_ns && (!wait_ns || pending_ns < wait_ns))
+				wait_ns = pending_ns;
+		}
+		pthread_mutex_unlock(&control_thread.list_mutex);
+
+		// Woken early by every state change; a coalesced PTZ command is sent once its interval is over
+		unsigned long wait_ms = wait_ns ? (unsigned long)std::max<uint64_t>(1, wait_ns / 1000000ULL)
+						: NDI_CONTROL_IDLE_WAIT_MS;
+		os_event_timedwait(control_thread.wake_event, wait_ms);
+	}
+
+	return nullptr;
+}
+
+ndi_control_t *ndi_control_create(obs_source_t *source)
+{
+	auto c = new ndi_control_t();
+	c->source = source;
+	pthread_mutex_init(&c->mutex, nullptr);
+
+	pthread_mutex_lock(&control_thread.mutex);
+	if (!control_thread.running) {
+		obs_log(LOG_DEBUG, "ndi_control: starting control thread");
+		os_event_init(&control_thread.wake_event, OS_EVENT_TYPE_AUTO);
+		control_thread.running = true;
+		pthread_create(&control_thread.thread, nullptr, ndi_control_thread, nullptr);
+	}
+	pthread_mutex_lock(&control_thread.list_mutex);
+	control_thread.controls.push_back(c);
+	pthread_mutex_unlock(&control_thread.list_mutex);
+	pthread_mutex_unlock(&control_thread.mutex);
+
+	return c;
+}
+
+void ndi_control_destroy(ndi_control_t *control)
+{
+	if (!control)
+		return;
+
+	pthread_mutex_lock(&control_thread.list_mutex);
+	auto &controls = control_thread.controls;
+	controls.erase(std::remove(controls.begin(), controls.end(), control), controls.end());
+	pthread_mutex_unlock(&control_thread.list_mutex);
+
+	pthread_mutex_destroy(&control->mutex);
+	delete control;
+}
+
+void ndi_control_set_receiver(ndi_control_t *control, NDIlib_recv_instance_t receiver)
+{
+	pthread_mutex_lock(&control->mutex);
+	control->receiver = receiver;
+	control->receiver_changed = true;
+	pthread_mutex_unlock(&control->mutex);
+
+	if (receiver)
+		os_event_signal(control_thread.wake_event);
+}
+
+void ndi_control_set_ptz(ndi_control_t *control, bool enabled, float pan, float tilt, float zoom)
+{
+	control->pan = pan;
+	control->tilt = tilt;
+	control->zoom = zoom;
+	control->ptz_enabled = enabled;
+	os_event_signal(control_thread.wake_event);
+}
+
+void ndi_control_set_tally(ndi_control_t *control, bool on_preview, bool on_program)
+{
+	control->on_preview = on_preview;
+	control->on_program = on_program;
+	os_event_signal(control_thread.wake_event);
+}
+
+void ndi_control_shutdown()
+{
+	pthread_mutex_lock(&control_thread.mutex);
+	if (control_thread.running) {
+		control_thread.running = false;
+		os_event_signal(control_thread.wake_event);
+		pthread_join(control_thread.thread, nullptr);
+		os_event_destroy(control_thread.wake_event);
+		control_thread.wake_event = nullptr;
+	}
+	pthread_mutex_unlock(&control_thread.mutex);
+}
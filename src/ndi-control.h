@@ -0,0 +1,63 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <obs-module.h>
+#include <Processing.NDI.Lib.h>
+
+/**
+ * Control path of the NDI receivers: tally and PTZ commands are sent from a single shared thread instead of the
+ * capture loop, so a burst of PTZ changes never delays a frame capture.
+ * The wanted state is handed over without locking and coalesced: only the latest PTZ target is sent, at most
+ * once per NDI_CONTROL_PTZ_INTERVAL_NS for each receiver.
+ */
+
+typedef struct ndi_control ndi_control_t;
+
+/**
+ * Create the control state of a source, starting the control thread on first use.
+ * @param source Source the commands are sent for, used for logging
+ */
+ndi_control_t *ndi_control_create(obs_source_t *source);
+
+/**
+ * Destroy the control state. On return, no command is being sent for it.
+ */
+void ndi_control_destroy(ndi_control_t *control);
+
+/**
+ * Set the receiver the commands go to, or nullptr. Called by the capture thread before destroying its receiver
+ * and after creating a new one; waits for a command in flight to the previous receiver.
+ * The current tally and PTZ state is sent again to the new receiver.
+ */
+void ndi_control_set_receiver(ndi_control_t *control, NDIlib_recv_instance_t receiver);
+
+/**
+ * Set the wanted PTZ position. Lock-free, from any thread.
+ */
+void ndi_control_set_ptz(ndi_control_t *control, bool enabled, float pan, float tilt, float zoom);
+
+/**
+ * Set the wanted tally state. Lock-free, from any thread.
+ */
+void ndi_control_set_tally(ndi_control_t *control, bool on_preview, bool on_program);
+
+/**
+ * Stop the control thread. Called on module unload.
+ */
+void ndi_control_shutdown();
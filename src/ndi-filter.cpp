@@ -17,10 +17,18 @@
 
 #include "plugin-main.h"
 #include "ndi-video-converter.h"
+#include "ndi-readback.h"
+#include "ndi-audio.h"
+#include "ndi-buffer-pool.h"
+#include "ndi-trace.h"
 
 #include <util/platform.h>
 #include <util/threading.h>
 #include <media-io/video-frame.h>
+#include <graphics/matrix4.h>
+
+#include <algorithm>
+#include <atomic>
 
 #include <QDesktopServices>
 #include <QUrl>
@@ -28,11 +36,31 @@
 #define TEXFORMAT GS_BGRA
 #define FLT_PROP_NAME "ndi_filter_ndiname"
 #define FLT_PROP_GROUPS "ndi_filter_ndigroups"
+#define FLT_PROP_READBACK_LATENCY "ndi_filter_readback_latency"
+#define FLT_PROP_VIDEO_FORMAT "ndi_filter_video_format"
+#define FLT_PROP_ALWAYS_SEND "ndi_filter_always_send"
+#define FLT_PROP_AUDIO_BATCH "ndi_filter_audio_batch_ms"
+#define FLT_PROP_ALPHA_MODE "ndi_filter_alpha_mode"
+
+#define FLT_VIDEO_FORMAT_BGRA 0
+#define FLT_VIDEO_FORMAT_UYVY 1
+#define FLT_VIDEO_FORMAT_UYVA 2
+
+#define FLT_ALPHA_MODE_NONE 0
+#define FLT_ALPHA_MODE_PREMULTIPLY 1
+#define FLT_ALPHA_MODE_UNPREMULTIPLY 2
+
+// Async sends read the frame until the next send call, so one buffer is in flight while the other is filled
+#define NDI_FILTER_SEND_BUFFERS 2
+
+// Longest audio frame the filter gathers, in milliseconds
+#define NDI_FILTER_AUDIO_BATCH_MAX_MS 100
 
 typedef struct {
 	obs_source_t *obs_source;
 
-	NDIlib_send_instance_t ndi_sender;
+	// Audio-only filters swap it atomically, see audio_senders
+	std::atomic<NDIlib_send_instance_t> ndi_sender;
 
 	pthread_mutex_t ndi_sender_video_mutex;
 	pthread_mutex_t ndi_sender_audio_mutex;
@@ -42,18 +70,62 @@ typedef struct {
 
 	uint32_t known_width;
 	uint32_t known_height;
+	NDIlib_FourCC_video_type_e known_fourcc;
+	// Rows of the video_output frame: the UYVA alpha plane adds rows under the image
+	uint32_t known_readback_height;
+	uint32_t known_fps_num;
+	uint32_t known_fps_den;
 
 	gs_texrender_t *texrender;
-	gs_stagesurf_t *stagesurface;
+	// Area/Lanczos downscaling: the crop region at source resolution, filtered down into texrender
+	gs_texrender_t *source_texrender;
+	// Frame blending: the frame rendered before texrender (swapped each frame) and the blend of both
+	gs_texrender_t *previous_texrender;
+	gs_texrender_t *blend_texrender;
+	gs_effect_t *blend_effect;
+	bool has_previous_frame;
+	// UYVY/UYVA: frames are converted on the GPU before readback, halving it and sparing NDI the CPU conversion
+	int video_format;
+	gs_texrender_t *encode_texrender;
+	gs_effect_t *encode_effect;
+	// Premultiply and unpremultiply are done by the encode pass (which then also runs for BGRA), instead of a
+	// separate premultiplied alpha filter pass
+	int alpha_mode;
+	// Frames of readback latency traded for not stalling the render thread (0 = synchronous)
+	int readback_latency;
+	ndi_readback_t readback;
 	uint8_t *video_data;
 	uint32_t video_linesize;
 
 	video_t *video_output;
+	// Spreads the repeats of a frame over their ticks, on the video_output thread
+	ndi_frame_pacer_t video_pacer;
 	bool is_audioonly;
 
+	// Keep sending while no receiver is connected, otherwise nothing is rendered, read back nor sent
+	bool always_send;
+	// Receiver state of the render path, for logging suspend/resume
+	bool video_suspended;
+
+	// Owned copies of the video_output frames handed to send_send_video_async_v2 (video_output thread only)
+	uint8_t *send_buffers[NDI_FILTER_SEND_BUFFERS];
+	size_t send_buffer_size;
+	int send_buffer_index;
+
 	uint8_t *audio_conv_buffer;
 	size_t audio_conv_buffer_size;
 
+	// Audio gathered into NDI frames of audio_batch_ms (0 = each OBS block is sent as is). Guarded by
+	// audio_batch_mutex: the tick flushes a batch that waited its whole budget (e.g. the source went silent).
+	int audio_batch_ms;
+	pthread_mutex_t audio_batch_mutex;
+	ndi_audio_batch_t audio_batch;
+	uint32_t audio_batch_rate;
+	uint64_t audio_batch_start_ns;
+	// Audio-only filters send without locking. Sends in progress are counted, so a sender replaced by an update
+	// is only destroyed once none of them can still use it.
+	std::atomic<int> audio_senders;
+
 	// Video converter for custom resolution/FPS
 	ndi_video_converter_t converter;
 } ndi_filter_t;
@@ -84,6 +156,46 @@ obs_properties_t *ndi_filter_getproperties(void *)
 	obs_properties_add_text(props, FLT_PROP_GROUPS, obs_module_text("NDIPlugin.FilterProps.NDIGroups"),
 				OBS_TEXT_DEFAULT);
 
+	obs_property_t *readback_list =
+		obs_properties_add_list(props, FLT_PROP_READBACK_LATENCY,
+					obs_module_text("NDIPlugin.FilterProps.ReadbackLatency"), OBS_COMBO_TYPE_LIST,
+					OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(readback_list, obs_module_text("NDIPlugin.FilterProps.ReadbackLatency.None"), 0);
+	obs_property_list_add_int(readback_list, obs_module_text("NDIPlugin.FilterProps.ReadbackLatency.OneFrame"), 1);
+	obs_property_list_add_int(readback_list, obs_module_text("NDIPlugin.FilterProps.ReadbackLatency.TwoFrames"),
+				  2);
+	obs_property_set_long_description(readback_list,
+					  obs_module_text("NDIPlugin.FilterProps.ReadbackLatency.Description"));
+
+	obs_properties_add_bool(props, FLT_PROP_ALWAYS_SEND, obs_module_text("NDIPlugin.FilterProps.AlwaysSend"));
+
+	obs_property_t *audio_batch = obs_properties_add_int_slider(
+		props, FLT_PROP_AUDIO_BATCH, obs_module_text("NDIPlugin.FilterProps.AudioBatch"), 0,
+		NDI_FILTER_AUDIO_BATCH_MAX_MS, 5);
+	obs_property_int_set_suffix(audio_batch, " ms");
+	obs_property_set_long_description(audio_batch, obs_module_text("NDIPlugin.FilterProps.AudioBatch.Description"));
+
+	obs_property_t *format_list = obs_properties_add_list(props, FLT_PROP_VIDEO_FORMAT,
+							      obs_module_text("NDIPlugin.FilterProps.VideoFormat"),
+							      OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(format_list, obs_module_text("NDIPlugin.FilterProps.VideoFormat.BGRA"),
+				  FLT_VIDEO_FORMAT_BGRA);
+	obs_property_list_add_int(format_list, obs_module_text("NDIPlugin.FilterProps.VideoFormat.UYVY"),
+				  FLT_VIDEO_FORMAT_UYVY);
+	obs_property_list_add_int(format_list, obs_module_text("NDIPlugin.FilterProps.VideoFormat.UYVA"),
+				  FLT_VIDEO_FORMAT_UYVA);
+
+	obs_property_t *alpha_list = obs_properties_add_list(props, FLT_PROP_ALPHA_MODE,
+							     obs_module_text("NDIPlugin.FilterProps.AlphaMode"),
+							     OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(alpha_list, obs_module_text("NDIPlugin.FilterProps.AlphaMode.None"),
+				  FLT_ALPHA_MODE_NONE);
+	obs_property_list_add_int(alpha_list, obs_module_text("NDIPlugin.FilterProps.AlphaMode.Premultiply"),
+				  FLT_ALPHA_MODE_PREMULTIPLY);
+	obs_property_list_add_int(alpha_list, obs_module_text("NDIPlugin.FilterProps.AlphaMode.Unpremultiply"),
+				  FLT_ALPHA_MODE_UNPREMULTIPLY);
+	obs_property_set_long_description(alpha_list, obs_module_text("NDIPlugin.FilterProps.AlphaMode.Description"));
+
 	// Custom Resolution Settings
 	auto group_res = obs_properties_create();
 	obs_properties_add_bool(group_res, "enable_custom_resolution", "Enable Custom Resolution");
@@ -104,6 +216,8 @@ obs_properties_t *ndi_filter_getproperties(void *)
 	obs_property_list_add_int(scale_type, "Fast Bilinear (Fastest)", NDI_SCALE_FAST_BILINEAR);
 	obs_property_list_add_int(scale_type, "Bilinear (Good)", NDI_SCALE_BILINEAR);
 	obs_property_list_add_int(scale_type, "Bicubic (Best)", NDI_SCALE_BICUBIC);
+	obs_property_list_add_int(scale_type, "Area (Large downscales)", NDI_SCALE_AREA);
+	obs_property_list_add_int(scale_type, "Lanczos (Sharpest downscale)", NDI_SCALE_LANCZOS);
 
 	obs_properties_add_group(props, "group_resolution", "Resolution Conversion", OBS_GROUP_NORMAL, group_res);
 
@@ -141,6 +255,7 @@ obs_properties_t *ndi_filter_getproperties(void *)
 
 	obs_properties_add_int(group_fps, "custom_fps_num", "Custom FPS Numerator", 1, 240, 1);
 	obs_properties_add_int(group_fps, "custom_fps_den", "Custom FPS Denominator", 1, 1001, 1);
+	obs_properties_add_bool(group_fps, "frame_blend", "Blend Frames (smoother 60 to 50 fps)");
 
 	obs_properties_add_group(props, "group_framerate", "Frame Rate Conversion", OBS_GROUP_NORMAL, group_fps);
 
@@ -170,6 +285,11 @@ void ndi_filter_getdefaults(obs_data_t *defaults)
 	obs_log(LOG_DEBUG, "+ndi_filter_getdefaults(...)");
 	obs_data_set_default_string(defaults, FLT_PROP_NAME, obs_module_text("NDIPlugin.FilterProps.NDIName.Default"));
 	obs_data_set_default_string(defaults, FLT_PROP_GROUPS, "");
+	obs_data_set_default_int(defaults, FLT_PROP_READBACK_LATENCY, 1);
+	obs_data_set_default_int(defaults, FLT_PROP_VIDEO_FORMAT, FLT_VIDEO_FORMAT_BGRA);
+	obs_data_set_default_bool(defaults, FLT_PROP_ALWAYS_SEND, false);
+	obs_data_set_default_int(defaults, FLT_PROP_AUDIO_BATCH, 0);
+	obs_data_set_default_int(defaults, FLT_PROP_ALPHA_MODE, FLT_ALPHA_MODE_NONE);
 
 	// Resolution defaults
 	obs_data_set_default_bool(defaults, "enable_custom_resolution", false);
@@ -190,6 +310,7 @@ void ndi_filter_getdefaults(obs_data_t *defaults)
 	obs_data_set_default_int(defaults, "framerate_mode", NDI_FRAMERATE_30);
 	obs_data_set_default_int(defaults, "custom_fps_num", 30);
 	obs_data_set_default_int(defaults, "custom_fps_den", 1);
+	obs_data_set_default_bool(defaults, "frame_blend", false);
 
 	obs_log(LOG_DEBUG, "-ndi_filter_getdefaults(...)");
 }
@@ -212,129 +333,229 @@ bool is_filter_valid(ndi_filter_t *filter)
 	return is_valid;
 }
 
-void ndi_filter_raw_video(void *data, video_data *frame)
+static uint8_t *ndi_filter_next_send_buffer(ndi_filter_t *f, size_t size)
 {
-	auto f = (ndi_filter_t *)data;
+	if (size > f->send_buffer_size) {
+		// NDI may still be reading the buffer of the last async send; flush it before reallocating.
+		pthread_mutex_lock(&f->ndi_sender_video_mutex);
+		if (f->ndi_sender)
+			ndiLib->send_send_video_async_v2(f->ndi_sender, nullptr);
+		pthread_mutex_unlock(&f->ndi_sender_video_mutex);
 
-	// Check frame rate limiting
-	int frames_to_send = 1;
-	if (f->converter.enable_custom_framerate && frame) {
-		bool should_send = ndi_converter_should_send_frame(&f->converter, frame->timestamp, &frames_to_send);
-		if (!should_send || frames_to_send == 0) {
-			return; // Skip this frame
+		obs_log(LOG_DEBUG, "ndi_filter_next_send_buffer: allocating %d x %zu bytes", NDI_FILTER_SEND_BUFFERS,
+			size);
+		for (auto &buffer : f->send_buffers) {
+			ndi_buffer_pool_free(buffer, f->send_buffer_size);
+			buffer = nullptr;
 		}
+		for (auto &buffer : f->send_buffers)
+			buffer = ndi_buffer_pool_alloc(size, &f->send_buffer_size);
 	}
 
-	// Determine frame rate metadata
-	uint32_t ndi_fps_num = f->ovi.fps_num;
-	uint32_t ndi_fps_den = f->ovi.fps_den;
-	if (f->converter.enable_custom_framerate && f->converter.target_fps_num > 0 &&
-	    f->converter.target_fps_den > 0) {
-		ndi_fps_num = f->converter.target_fps_num;
-		ndi_fps_den = f->converter.target_fps_den;
-	}
-
-	// Apply crop (AFTER scaling) if enabled
-	uint32_t final_width = f->known_width;
-	uint32_t final_height = f->known_height;
-	uint8_t *final_data = frame->data[0];
-	uint32_t final_linesize = frame->linesize[0];
-
-	if (f->converter.enable_crop && frame && frame->data[0]) {
-		// Get crop coordinates (assumed to be in source resolution space)
-		int32_t crop_left = f->converter.crop_left;
-		int32_t crop_top = f->converter.crop_top;
-		uint32_t crop_width = f->converter.crop_width;
-		uint32_t crop_height = f->converter.crop_height;
-
-		// If custom resolution is enabled, normalize crop coordinates from source to scaled space
-		if (f->converter.enable_custom_resolution && f->converter.target_width > 0 &&
-		    f->converter.target_height > 0) {
-			// Get source dimensions
-			uint32_t source_width = obs_source_get_width(f->obs_source);
-			uint32_t source_height = obs_source_get_height(f->obs_source);
-
-			if (source_width > 0 && source_height > 0) {
-				// Calculate scaling ratios
-				float scale_x = (float)f->known_width / (float)source_width;
-				float scale_y = (float)f->known_height / (float)source_height;
-
-				// Scale crop coordinates proportionally
-				crop_left = (int32_t)((float)crop_left * scale_x);
-				crop_top = (int32_t)((float)crop_top * scale_y);
-				crop_width = (uint32_t)((float)crop_width * scale_x);
-				crop_height = (uint32_t)((float)crop_height * scale_y);
-
-				obs_log(LOG_INFO,
-					"[distroav] Crop normalized from source %ux%u to scaled %ux%u: (%d,%d,%u,%u) "
-					"-> (%d,%d,%u,%u)",
-					source_width, source_height, f->known_width, f->known_height,
-					f->converter.crop_left, f->converter.crop_top, f->converter.crop_width,
-					f->converter.crop_height, crop_left, crop_top, crop_width, crop_height);
-			}
-		}
-
-		// 0 means use full dimension
-		if (crop_width == 0)
-			crop_width = f->known_width;
-		if (crop_height == 0)
-			crop_height = f->known_height;
-
-		// Clamp to valid range
-		if (crop_left < 0)
-			crop_left = 0;
-		if (crop_top < 0)
-			crop_top = 0;
-		// Don't reset to 0 - clamp to max valid position
-		if ((uint32_t)crop_left >= f->known_width)
-			crop_left = f->known_width - 1;
-		if ((uint32_t)crop_top >= f->known_height)
-			crop_top = f->known_height - 1;
-		// Clamp dimensions to fit within frame
-		if (crop_left + crop_width > f->known_width)
-			crop_width = f->known_width - crop_left;
-		if (crop_top + crop_height > f->known_height)
-			crop_height = f->known_height - crop_top;
-
-		obs_log(LOG_INFO, "[distroav] Crop applied: left=%d, top=%d, width=%u, height=%u", crop_left, crop_top,
-			crop_width, crop_height);
-
-		if (crop_width > 0 && crop_height > 0 && (crop_left > 0 || crop_top > 0 ||
-							  crop_width < f->known_width ||
-							  crop_height < f->known_height)) {
-			// Offset pointer to crop region (BGRA = 4 bytes per pixel)
-			final_data = frame->data[0] + (crop_top * final_linesize) + (crop_left * 4);
-			final_width = crop_width;
-			final_height = crop_height;
-			// linesize stays the same (full row stride)
-		}
-	}
+	f->send_buffer_index = (f->send_buffer_index + 1) % NDI_FILTER_SEND_BUFFERS;
+	return f->send_buffers[f->send_buffer_index];
+}
 
-	// Send frame(s) - dimensions may be cropped from scaled frame
-	for (int i = 0; i < frames_to_send; i++) {
-		NDIlib_video_frame_v2_t video_frame = {0};
+void ndi_filter_raw_video(void *data, video_data *frame)
+{
+	NDI_TRACE_ZONE("ndi_filter_raw_video");
+	auto f = (ndi_filter_t *)data;
 
-		if (frame && frame->data[0]) {
-			video_frame.xres = final_width;
-			video_frame.yres = final_height;
-			video_frame.FourCC = NDIlib_FourCC_type_BGRA;
-			video_frame.frame_rate_N = ndi_fps_num;
-			video_frame.frame_rate_D = ndi_fps_den;
-			video_frame.picture_aspect_ratio = 0;
-			video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
-			video_frame.timecode = NDIlib_send_timecode_synthesize;
-			video_frame.p_data = final_data;
-			video_frame.line_stride_in_bytes = final_linesize;
-		}
+	// Frame rate conversion happens in the render pass: the video_output runs at the target rate and paces
+	// duplicated frames itself, so every frame received here is sent once.
+	NDIlib_video_frame_v2_t video_frame = {0};
 
+	if (!frame || !frame->data[0]) {
+		// Synchronous, which also releases the buffer of the last async send
 		pthread_mutex_lock(&f->ndi_sender_video_mutex);
 		ndiLib->send_send_video_v2(f->ndi_sender, &video_frame);
 		pthread_mutex_unlock(&f->ndi_sender_video_mutex);
+		return;
 	}
+
+	// Repeats of a frame come back to back: hold each until its own tick
+	ndi_frame_pacer_wait(&f->video_pacer, frame->timestamp, video_output_get_frame_time(f->video_output));
+
+	// The video_output frame is recycled once this callback returns, so NDI gets an owned copy
+	// that stays untouched until the send after next.
+	size_t frame_size = (size_t)frame->linesize[0] * f->known_readback_height;
+	uint8_t *send_buffer = ndi_filter_next_send_buffer(f, frame_size);
+	if (!send_buffer)
+		return;
+	memcpy(send_buffer, frame->data[0], frame_size);
+
+	// Cropping and scaling already happened on the GPU
+	video_frame.xres = f->known_width;
+	video_frame.yres = f->known_height;
+	video_frame.FourCC = f->known_fourcc;
+	video_frame.frame_rate_N = f->known_fps_num;
+	video_frame.frame_rate_D = f->known_fps_den;
+	video_frame.picture_aspect_ratio = 0;
+	video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
+	video_frame.timecode = NDIlib_send_timecode_synthesize;
+	video_frame.p_data = send_buffer;
+	video_frame.line_stride_in_bytes = frame->linesize[0];
+
+	NDI_TRACE_ZONE("ndi_filter send");
+	pthread_mutex_lock(&f->ndi_sender_video_mutex);
+	ndiLib->send_send_video_async_v2(f->ndi_sender, &video_frame);
+	pthread_mutex_unlock(&f->ndi_sender_video_mutex);
+}
+
+// Effective NDI format for a frame size; the 4:2:2 formats need whole macropixels (and whole alpha texels)
+static NDIlib_FourCC_video_type_e ndi_filter_fourcc(ndi_filter_t *f, uint32_t width, uint32_t height)
+{
+	if (!f->encode_effect)
+		return NDIlib_FourCC_type_BGRA;
+	if (f->video_format == FLT_VIDEO_FORMAT_UYVA && width % 4 == 0 && height % 2 == 0)
+		return NDIlib_FourCC_type_UYVA;
+	if (f->video_format != FLT_VIDEO_FORMAT_BGRA && width % 2 == 0)
+		return NDIlib_FourCC_type_UYVY;
+	return NDIlib_FourCC_type_BGRA;
+}
+
+// Size of the BGRA texture holding a frame in the given NDI format
+static void ndi_filter_readback_size(NDIlib_FourCC_video_type_e fourcc, uint32_t width, uint32_t height,
+				     uint32_t *readback_width, uint32_t *readback_height)
+{
+	switch (fourcc) {
+	case NDIlib_FourCC_type_UYVY:
+		*readback_width = width / 2;
+		*readback_height = height;
+		break;
+	case NDIlib_FourCC_type_UYVA:
+		*readback_width = width / 2;
+		*readback_height = height + height / 2;
+		break;
+	default:
+		*readback_width = width;
+		*readback_height = height;
+		break;
+	}
+}
+
+static gs_texture_t *ndi_filter_encode(ndi_filter_t *f, gs_texture_t *texture, NDIlib_FourCC_video_type_e fourcc,
+				       uint32_t width, uint32_t height, uint32_t target_width, uint32_t target_height)
+{
+	NDI_TRACE_ZONE("ndi_filter_encode");
+	gs_texrender_reset(f->encode_texrender);
+	if (!gs_texrender_begin(f->encode_texrender, target_width, target_height))
+		return nullptr;
+
+	gs_ortho(0.0f, (float)target_width, 0.0f, (float)target_height, -100.0f, 100.0f);
+
+	float yuv_to_rgb[16];
+	video_format_get_parameters_for_format(f->ovi.colorspace, f->ovi.range, VIDEO_FORMAT_UYVY, yuv_to_rgb, nullptr,
+					       nullptr);
+	struct matrix4 rgb_to_yuv;
+	memcpy(&rgb_to_yuv, yuv_to_rgb, sizeof(yuv_to_rgb));
+	matrix4_inv(&rgb_to_yuv, &rgb_to_yuv);
+
+	struct vec2 frame_size;
+	struct vec2 target_size;
+	vec2_set(&frame_size, (float)width, (float)height);
+	vec2_set(&target_size, (float)target_width, (float)target_height);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(f->encode_effect, "image"), texture);
+	gs_effect_set_matrix4(gs_effect_get_param_by_name(f->encode_effect, "color_matrix"), &rgb_to_yuv);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(f->encode_effect, "frame_size"), &frame_size);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(f->encode_effect, "target_size"), &target_size);
+	// UYVY has no alpha to unpremultiply against, receivers see the color as rendered
+	int alpha_mode = f->alpha_mode;
+	if (alpha_mode == FLT_ALPHA_MODE_UNPREMULTIPLY && fourcc == NDIlib_FourCC_type_UYVY)
+		alpha_mode = FLT_ALPHA_MODE_NONE;
+	gs_effect_set_float(gs_effect_get_param_by_name(f->encode_effect, "alpha_mode"), (float)alpha_mode);
+
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	const char *technique = "ConvertAlpha";
+	if (fourcc == NDIlib_FourCC_type_UYVA)
+		technique = "EncodeUYVA";
+	else if (fourcc == NDIlib_FourCC_type_UYVY)
+		technique = "EncodeUYVY";
+	while (gs_effect_loop(f->encode_effect, technique)) {
+		gs_draw_sprite(nullptr, 0, target_width, target_height);
+	}
+	gs_blend_state_pop();
+
+	gs_texrender_end(f->encode_texrender);
+	return gs_texrender_get_texture(f->encode_texrender);
+}
+
+static gs_texture_t *ndi_filter_blend(ndi_filter_t *f, float weight, uint32_t width, uint32_t height)
+{
+	NDI_TRACE_ZONE("ndi_filter_blend");
+	gs_texrender_reset(f->blend_texrender);
+	if (!gs_texrender_begin(f->blend_texrender, width, height))
+		return nullptr;
+
+	gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(f->blend_effect, "image"),
+			      gs_texrender_get_texture(f->texrender));
+	gs_effect_set_texture(gs_effect_get_param_by_name(f->blend_effect, "previous_image"),
+			      gs_texrender_get_texture(f->previous_texrender));
+	gs_effect_set_float(gs_effect_get_param_by_name(f->blend_effect, "weight"), weight);
+
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	while (gs_effect_loop(f->blend_effect, "Draw")) {
+		gs_draw_sprite(nullptr, 0, width, height);
+	}
+	gs_blend_state_pop();
+
+	gs_texrender_end(f->blend_texrender);
+	return gs_texrender_get_texture(f->blend_texrender);
+}
+
+// The sender is replaced under both sender mutexes, so either one guards the query
+// (no mutex: an audio-only filter, whose sender outlives the sends counted in audio_senders)
+static bool ndi_filter_has_receivers(ndi_filter_t *f, pthread_mutex_t *sender_mutex)
+{
+	if (f->always_send)
+		return true;
+
+	if (sender_mutex)
+		pthread_mutex_lock(sender_mutex);
+	NDIlib_send_instance_t sender = f->ndi_sender;
+	bool connected = sender && ndiLib->send_get_no_connections(sender, 0) > 0;
+	if (sender_mutex)
+		pthread_mutex_unlock(sender_mutex);
+	return connected;
+}
+
+// Draw the target into the current render target, with the crop region filling it
+static void ndi_filter_render_region(ndi_filter_t *f, obs_source_t *target, obs_source_t *parent)
+{
+	NDI_TRACE_ZONE("ndi_filter texrender");
+	ndi_video_converter_t *converter = &f->converter;
+
+	vec4 background;
+	vec4_zero(&background);
+
+	gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
+	// Ortho covers the crop region in SOURCE coordinates - only that region fills the render target,
+	// so cropping and scaling both happen here and only the cropped pixels are read back
+	gs_ortho(converter->region_left, converter->region_left + converter->region_width, converter->region_top,
+		 converter->region_top + converter->region_height, -100.0f, 100.0f);
+
+	// Alpha is converted by the encode pass: scenes draw their items with their own blend states, so a blend
+	// function set here would not apply to them
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	if (target == parent) {
+		obs_source_skip_video_filter(f->obs_source);
+	} else {
+		obs_source_video_render(target);
+	}
+
+	gs_blend_state_pop();
 }
 
 void ndi_filter_render_video(void *data, gs_effect_t *)
 {
+	NDI_TRACE_ZONE("ndi_filter_render_video");
 	auto f = (ndi_filter_t *)data;
 	obs_source_skip_video_filter(f->obs_source);
 
@@ -354,82 +575,177 @@ void ndi_filter_render_video(void *data, gs_effect_t *)
 		return;
 	}
 
+	// Nothing is rendered nor read back without receivers. Staged frames would be stale on resume, and the
+	// frame rate conversion and blending restart from the first frame after the pause.
+	ndi_video_converter_t *converter = &f->converter;
+	bool suspended = !ndi_filter_has_receivers(f, &f->ndi_sender_video_mutex);
+	if (suspended != f->video_suspended) {
+		f->video_suspended = suspended;
+		obs_log(LOG_INFO, suspended ? "NDI Filter Suspended, no receiver connected: '%s'"
+					    : "NDI Filter Resumed: '%s'",
+			obs_source_get_name(f->obs_source));
+		ndi_readback_reset(&f->readback);
+		ndi_converter_reset_framerate(converter);
+		f->has_previous_frame = false;
+	}
+	if (suspended)
+		return;
+
 	uint32_t width = obs_source_get_width(f->obs_source);
 	uint32_t height = obs_source_get_height(f->obs_source);
 
-	// Determine render dimensions (use custom if enabled and different)
-	uint32_t render_width = width;
-	uint32_t render_height = height;
-	if (f->converter.enable_custom_resolution && f->converter.target_width > 0 && f->converter.target_height > 0) {
-		render_width = f->converter.target_width;
-		render_height = f->converter.target_height;
+	// Render dimensions: the crop region, scaled to the custom resolution if enabled
+	ndi_converter_update_region(converter, width, height);
+	uint32_t render_width = converter->output_width;
+	uint32_t render_height = converter->output_height;
+
+	NDIlib_FourCC_video_type_e fourcc = ndi_filter_fourcc(f, render_width, render_height);
+	uint32_t readback_width;
+	uint32_t readback_height;
+	ndi_filter_readback_size(fourcc, render_width, render_height, &readback_width, &readback_height);
+
+	if (!ndi_readback_configure(&f->readback, readback_width, readback_height, TEXFORMAT,
+				    (uint32_t)f->readback_latency + 1)) {
+		return;
 	}
 
-	if (f->known_width != render_width || f->known_height != render_height) {
-		gs_stagesurface_destroy(f->stagesurface);
-		f->stagesurface = gs_stagesurface_create(render_width, render_height, TEXFORMAT);
+	// Frame rate conversion: the video_output runs at the target rate
+	uint32_t fps_num = f->ovi.fps_num;
+	uint32_t fps_den = f->ovi.fps_den;
+	if (converter->enable_custom_framerate && converter->target_fps_num > 0 && converter->target_fps_den > 0) {
+		fps_num = converter->target_fps_num;
+		fps_den = converter->target_fps_den;
+	}
 
+	if (f->known_width != render_width || f->known_height != render_height || f->known_fourcc != fourcc ||
+	    f->known_fps_num != fps_num || f->known_fps_den != fps_den) {
+		// The queue carries the readback texture as-is; raw_video tags it with the NDI format.
 		video_output_info vi = {0};
 		vi.format = VIDEO_FORMAT_BGRA;
-		vi.width = render_width;
-		vi.height = render_height;
-		vi.fps_den = f->ovi.fps_den;
-		vi.fps_num = f->ovi.fps_num;
+		vi.width = readback_width;
+		vi.height = readback_height;
+		vi.fps_den = fps_den;
+		vi.fps_num = fps_num;
 		vi.cache_size = 16;
 		vi.colorspace = VIDEO_CS_DEFAULT;
 		vi.range = VIDEO_RANGE_DEFAULT;
 		vi.name = obs_source_get_name(f->obs_source);
 
+		// Close first: raw_video reads the known_* values from the video_output thread
 		video_output_close(f->video_output);
-		video_output_open(&f->video_output, &vi);
-		video_output_connect(f->video_output, nullptr, ndi_filter_raw_video, f);
 
 		f->known_width = render_width;
 		f->known_height = render_height;
+		f->known_fourcc = fourcc;
+		f->known_readback_height = readback_height;
+		f->known_fps_num = fps_num;
+		f->known_fps_den = fps_den;
+		f->has_previous_frame = false;
+		f->video_pacer = {};
+
+		video_output_open(&f->video_output, &vi);
+		video_output_connect(f->video_output, nullptr, ndi_filter_raw_video, f);
 	}
 
-	gs_texrender_reset(f->texrender);
+	// Frames dropped by the conversion cost no GPU work, unless blending needs them as the previous frame.
+	// Duplicates are queued as one frame with a repeat count; raw_video paces the copies the video_output hands
+	// over back to back.
+	uint64_t timestamp = os_gettime_ns();
+	int frames_to_send = 1;
+	bool send = true;
+	if (converter->enable_custom_framerate) {
+		send = ndi_converter_should_send_frame(converter, timestamp, &frames_to_send) && frames_to_send > 0;
+	}
+	bool blend = converter->enable_custom_framerate && converter->frame_blend && f->blend_effect;
+	if (!send && !blend)
+		return;
 
-	// Render at target resolution (GPU scaling happens here - this is the key!)
-	if (gs_texrender_begin(f->texrender, render_width, render_height)) {
-		vec4 background;
-		vec4_zero(&background);
+	if (blend) {
+		gs_texrender_t *previous = f->previous_texrender;
+		f->previous_texrender = f->texrender;
+		f->texrender = previous;
+	}
 
-		gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
-		// Ortho uses SOURCE dimensions - source fills render target, causing automatic scaling
-		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+	// Area/Lanczos: render the crop region at its own resolution first, the filtered draw below downscales it
+	gs_texture_t *source_texture = nullptr;
+	if (ndi_converter_gpu_downscale(converter)) {
+		uint32_t region_width = std::max((uint32_t)(converter->region_width + 0.5f), 1u);
+		uint32_t region_height = std::max((uint32_t)(converter->region_height + 0.5f), 1u);
+		gs_texrender_reset(f->source_texrender);
+		if (!gs_texrender_begin(f->source_texrender, region_width, region_height))
+			return;
+		ndi_filter_render_region(f, target, parent);
+		gs_texrender_end(f->source_texrender);
+		source_texture = gs_texrender_get_texture(f->source_texrender);
+	}
 
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	gs_texrender_reset(f->texrender);
 
-		if (target == parent) {
-			obs_source_skip_video_filter(f->obs_source);
+	// Render at target resolution (GPU scaling happens here - this is the key!)
+	if (gs_texrender_begin(f->texrender, render_width, render_height)) {
+		if (source_texture) {
+			gs_ortho(0.0f, (float)render_width, 0.0f, (float)render_height, -100.0f, 100.0f);
+
+			gs_blend_state_push();
+			gs_enable_blending(false);
+			gs_effect_t *effect = ndi_converter_scale_effect(converter, source_texture);
+			while (gs_effect_loop(effect, "Draw")) {
+				gs_draw_sprite(source_texture, 0, render_width, render_height);
+			}
+			gs_blend_state_pop();
 		} else {
-			obs_source_video_render(target);
+			ndi_filter_render_region(f, target, parent);
 		}
-
-		gs_blend_state_pop();
 		gs_texrender_end(f->texrender);
 
-		gs_stage_texture(f->stagesurface, gs_texrender_get_texture(f->texrender));
-		if (gs_stagesurface_map(f->stagesurface, &f->video_data, &f->video_linesize)) {
+		bool had_previous_frame = f->has_previous_frame;
+		f->has_previous_frame = blend;
+		if (!send)
+			return;
+
+		// With readback_latency > 0, this maps a frame rendered readback_latency frames ago,
+		// whose GPU copy has already completed, instead of waiting for the one just staged.
+		gs_texture_t *readback_texture = gs_texrender_get_texture(f->texrender);
+		if (blend && had_previous_frame) {
+			readback_texture = ndi_filter_blend(f, ndi_converter_blend_weight(converter), render_width,
+							    render_height);
+			if (!readback_texture)
+				return;
+		}
+		bool convert_alpha = f->alpha_mode != FLT_ALPHA_MODE_NONE && f->encode_effect;
+		if (fourcc != NDIlib_FourCC_type_BGRA || convert_alpha) {
+			readback_texture = ndi_filter_encode(f, readback_texture, fourcc, render_width, render_height,
+							     readback_width, readback_height);
+			if (!readback_texture)
+				return;
+		}
+
+		uint64_t frame_timestamp = 0;
+		ndi_readback_stage(&f->readback, readback_texture, timestamp);
+		if (ndi_readback_map(&f->readback, &f->video_data, &f->video_linesize, &frame_timestamp)) {
 			video_frame output_frame;
-			if (video_output_lock_frame(f->video_output, &output_frame, 1, os_gettime_ns())) {
-				uint32_t linesize = output_frame.linesize[0];
-				for (uint32_t i = 0; i < render_height; ++i) {
-					uint32_t dst_offset = linesize * i;
-					uint32_t src_offset = f->video_linesize * i;
-					memcpy(output_frame.data[0] + dst_offset, f->video_data + src_offset, linesize);
-				}
+			if (video_output_lock_frame(f->video_output, &output_frame, frames_to_send, frame_timestamp)) {
+				ndi_readback_copy_plane(output_frame.data[0], output_frame.linesize[0], f->video_data,
+							f->video_linesize, readback_width * 4, readback_height);
 
 				video_output_unlock_frame(f->video_output);
 			}
 
-			gs_stagesurface_unmap(f->stagesurface);
+			ndi_readback_unmap(&f->readback);
 		}
 	}
 }
 
+// Audio-only filters send without a mutex: take the sender away from the audio thread, then destroy it once the
+// sends that may have picked it up are done. The old one goes first, so the NDI name is free for its replacement.
+static void ndi_sender_release_audioonly(ndi_filter_t *filter)
+{
+	NDIlib_send_instance_t sender = filter->ndi_sender.exchange(nullptr);
+	while (filter->audio_senders > 0)
+		os_sleep_ms(1);
+	ndiLib->send_destroy(sender);
+}
+
 void ndi_sender_destroy(ndi_filter_t *filter)
 {
 	if (!filter || !filter->ndi_sender) {
@@ -440,10 +756,14 @@ void ndi_sender_destroy(ndi_filter_t *filter)
 		pthread_mutex_lock(&filter->ndi_sender_video_mutex);
 	}
 
-	pthread_mutex_lock(&filter->ndi_sender_audio_mutex);
-	ndiLib->send_destroy(filter->ndi_sender);
-	filter->ndi_sender = nullptr;
-	pthread_mutex_unlock(&filter->ndi_sender_audio_mutex);
+	if (filter->is_audioonly) {
+		ndi_sender_release_audioonly(filter);
+	} else {
+		pthread_mutex_lock(&filter->ndi_sender_audio_mutex);
+		ndiLib->send_destroy(filter->ndi_sender);
+		filter->ndi_sender = nullptr;
+		pthread_mutex_unlock(&filter->ndi_sender_audio_mutex);
+	}
 
 	if (!filter->is_audioonly) {
 		pthread_mutex_unlock(&filter->ndi_sender_video_mutex);
@@ -457,8 +777,10 @@ void ndi_sender_create(ndi_filter_t *filter, obs_data_t *settings)
 	}
 
 	auto obs_source = filter->obs_source;
+	obs_data_t *owned_settings = nullptr;
 	if (!settings) {
-		settings = obs_source_get_settings(obs_source);
+		owned_settings = obs_source_get_settings(obs_source);
+		settings = owned_settings;
 	}
 
 	NDIlib_send_create_t send_desc;
@@ -471,18 +793,19 @@ void ndi_sender_create(ndi_filter_t *filter, obs_data_t *settings)
 	send_desc.clock_video = false;
 	send_desc.clock_audio = false;
 
-	if (!filter->is_audioonly) {
+	if (filter->is_audioonly) {
+		ndi_sender_release_audioonly(filter);
+		filter->ndi_sender = ndiLib->send_create(&send_desc);
+	} else {
 		pthread_mutex_lock(&filter->ndi_sender_video_mutex);
-	}
-
-	pthread_mutex_lock(&filter->ndi_sender_audio_mutex);
-	ndiLib->send_destroy(filter->ndi_sender);
-	filter->ndi_sender = ndiLib->send_create(&send_desc);
-	pthread_mutex_unlock(&filter->ndi_sender_audio_mutex);
-
-	if (!filter->is_audioonly) {
+		pthread_mutex_lock(&filter->ndi_sender_audio_mutex);
+		ndiLib->send_destroy(filter->ndi_sender);
+		filter->ndi_sender = ndiLib->send_create(&send_desc);
+		pthread_mutex_unlock(&filter->ndi_sender_audio_mutex);
 		pthread_mutex_unlock(&filter->ndi_sender_video_mutex);
 	}
+
+	obs_data_release(owned_settings);
 }
 
 void ndi_filter_update(void *data, obs_data_t *settings)
@@ -497,12 +820,59 @@ void ndi_filter_update(void *data, obs_data_t *settings)
 	// Update video converter settings
 	ndi_converter_update(&f->converter, settings);
 
+	// Picked up by the render thread, which owns the stage surfaces
+	f->readback_latency = (int)obs_data_get_int(settings, FLT_PROP_READBACK_LATENCY);
+	f->video_format = (int)obs_data_get_int(settings, FLT_PROP_VIDEO_FORMAT);
+	f->alpha_mode = (int)obs_data_get_int(settings, FLT_PROP_ALPHA_MODE);
+	f->always_send = obs_data_get_bool(settings, FLT_PROP_ALWAYS_SEND);
+	f->audio_batch_ms = (int)obs_data_get_int(settings, FLT_PROP_AUDIO_BATCH);
+
 	auto groups = obs_data_get_string(settings, FLT_PROP_GROUPS);
 
 	obs_log(LOG_INFO, "NDI Filter Updated: '%s'", name);
 	obs_log(LOG_DEBUG, "-ndi_filter_update(name='%s', groups='%s')", name, groups);
 }
 
+// Send the gathered audio as one NDI frame, checking for receivers (and taking the sender mutex) once per batch.
+// Called with audio_batch_mutex held.
+static void ndi_filter_flush_audio(ndi_filter_t *f, pthread_mutex_t *sender_mutex)
+{
+	ndi_audio_batch_t *batch = &f->audio_batch;
+	if (!batch->samples)
+		return;
+
+	if (ndi_filter_has_receivers(f, sender_mutex)) {
+		NDIlib_audio_frame_v3_t audio_frame = {0};
+		audio_frame.sample_rate = f->audio_batch_rate;
+		audio_frame.timecode = NDIlib_send_timecode_synthesize;
+		ndi_audio_batch_set_frame(batch, &audio_frame);
+
+		if (sender_mutex)
+			pthread_mutex_lock(sender_mutex);
+		NDIlib_send_instance_t sender = f->ndi_sender;
+		if (sender)
+			ndiLib->send_send_audio_v3(sender, &audio_frame);
+		if (sender_mutex)
+			pthread_mutex_unlock(sender_mutex);
+	}
+	batch->samples = 0;
+}
+
+// Send whatever is left in the batch, before the sender goes away
+static void ndi_filter_flush_audio_batch(ndi_filter_t *f, pthread_mutex_t *sender_mutex)
+{
+	pthread_mutex_lock(&f->audio_batch_mutex);
+	ndi_filter_flush_audio(f, sender_mutex);
+	pthread_mutex_unlock(&f->audio_batch_mutex);
+}
+
+// Source audio usually arrives in blocks of at most AUDIO_OUTPUT_FRAMES; larger ones grow the buffer when sent
+static void ndi_filter_alloc_audio_buffer(ndi_filter_t *f)
+{
+	size_t size = ndi_audio_fltp_buffer_size((uint32_t)f->oai.speakers, AUDIO_OUTPUT_FRAMES);
+	f->audio_conv_buffer = ndi_buffer_pool_alloc(size, &f->audio_conv_buffer_size);
+}
+
 void *ndi_filter_create(obs_data_t *settings, obs_source_t *obs_source)
 {
 	auto name = obs_data_get_string(settings, FLT_PROP_NAME);
@@ -512,13 +882,39 @@ void *ndi_filter_create(obs_data_t *settings, obs_source_t *obs_source)
 	auto f = (ndi_filter_t *)bzalloc(sizeof(ndi_filter_t));
 	f->obs_source = obs_source;
 	f->texrender = gs_texrender_create(TEXFORMAT, GS_ZS_NONE);
+	f->source_texrender = gs_texrender_create(TEXFORMAT, GS_ZS_NONE);
+	f->encode_texrender = gs_texrender_create(TEXFORMAT, GS_ZS_NONE);
+	f->previous_texrender = gs_texrender_create(TEXFORMAT, GS_ZS_NONE);
+	f->blend_texrender = gs_texrender_create(TEXFORMAT, GS_ZS_NONE);
+
+	char *effect_path = obs_module_file("effects/ndi-encode.effect");
+	obs_enter_graphics();
+	f->encode_effect = gs_effect_create_from_file(effect_path, nullptr);
+	obs_leave_graphics();
+	bfree(effect_path);
+	if (!f->encode_effect) {
+		obs_log(LOG_ERROR, "ERR-432 - Error loading the NDI encode effect for '%s', sending BGRA", name);
+	}
+
+	effect_path = obs_module_file("effects/ndi-blend.effect");
+	obs_enter_graphics();
+	f->blend_effect = gs_effect_create_from_file(effect_path, nullptr);
+	obs_leave_graphics();
+	bfree(effect_path);
+	if (!f->blend_effect) {
+		obs_log(LOG_WARNING, "WARN-428 - Error loading the NDI blend effect for '%s', frames are not blended",
+			name);
+	}
 	pthread_mutex_init(&f->ndi_sender_video_mutex, NULL);
 	pthread_mutex_init(&f->ndi_sender_audio_mutex, NULL);
+	pthread_mutex_init(&f->audio_batch_mutex, NULL);
 	obs_get_video_info(&f->ovi);
 	obs_get_audio_info(&f->oai);
+	ndi_filter_alloc_audio_buffer(f);
 
 	// Initialize video converter
 	ndi_converter_init(&f->converter);
+	ndi_readback_init(&f->readback);
 
 	ndi_filter_update(f, settings);
 
@@ -538,7 +934,9 @@ void *ndi_filter_create_audioonly(obs_data_t *settings, obs_source_t *obs_source
 	f->is_audioonly = true;
 	f->obs_source = obs_source;
 	pthread_mutex_init(&f->ndi_sender_audio_mutex, NULL);
+	pthread_mutex_init(&f->audio_batch_mutex, NULL);
 	obs_get_audio_info(&f->oai);
+	ndi_filter_alloc_audio_buffer(f);
 
 	ndi_filter_update(f, settings);
 
@@ -555,6 +953,7 @@ void ndi_filter_destroy(void *data)
 	obs_log(LOG_DEBUG, "+ndi_filter_destroy('%s'...)", name);
 
 	video_output_close(f->video_output);
+	ndi_filter_flush_audio_batch(f, &f->ndi_sender_audio_mutex);
 
 	pthread_mutex_lock(&f->ndi_sender_video_mutex);
 	pthread_mutex_lock(&f->ndi_sender_audio_mutex);
@@ -562,15 +961,29 @@ void ndi_filter_destroy(void *data)
 	pthread_mutex_unlock(&f->ndi_sender_audio_mutex);
 	pthread_mutex_unlock(&f->ndi_sender_video_mutex);
 
-	gs_stagesurface_unmap(f->stagesurface);
-	gs_stagesurface_destroy(f->stagesurface);
+	// Only safe once the sender, which may still read the last async frame, is gone
+	for (auto &buffer : f->send_buffers) {
+		ndi_buffer_pool_free(buffer, f->send_buffer_size);
+		buffer = nullptr;
+	}
+
+	obs_enter_graphics();
+	ndi_readback_destroy(&f->readback);
 	gs_texrender_destroy(f->texrender);
+	gs_texrender_destroy(f->source_texrender);
+	gs_texrender_destroy(f->encode_texrender);
+	gs_effect_destroy(f->encode_effect);
+	gs_texrender_destroy(f->previous_texrender);
+	gs_texrender_destroy(f->blend_texrender);
+	gs_effect_destroy(f->blend_effect);
+	obs_leave_graphics();
 
 	if (f->audio_conv_buffer) {
 		obs_log(LOG_DEBUG, "ndi_filter_destroy: freeing %zu bytes", f->audio_conv_buffer_size);
-		bfree(f->audio_conv_buffer);
+		ndi_buffer_pool_free(f->audio_conv_buffer, f->audio_conv_buffer_size);
 		f->audio_conv_buffer = nullptr;
 	}
+	ndi_audio_batch_free(&f->audio_batch);
 
 	// Destroy video converter (minimal - only used for FPS conversion state)
 	ndi_converter_destroy(&f->converter);
@@ -587,14 +1000,15 @@ void ndi_filter_destroy_audioonly(void *data)
 	auto name = obs_source_get_name(f->obs_source);
 	obs_log(LOG_DEBUG, "+ndi_filter_destroy_audioonly('%s'...)", name);
 
-	pthread_mutex_lock(&f->ndi_sender_audio_mutex);
+	// Audio has stopped by now, so the sender is used without the in-flight count
+	ndi_filter_flush_audio_batch(f, nullptr);
 	ndiLib->send_destroy(f->ndi_sender);
-	pthread_mutex_unlock(&f->ndi_sender_audio_mutex);
 
 	if (f->audio_conv_buffer) {
-		bfree(f->audio_conv_buffer);
+		ndi_buffer_pool_free(f->audio_conv_buffer, f->audio_conv_buffer_size);
 		f->audio_conv_buffer = nullptr;
 	}
+	ndi_audio_batch_free(&f->audio_batch);
 
 	bfree(f);
 
@@ -602,10 +1016,31 @@ void ndi_filter_destroy_audioonly(void *data)
 	obs_log(LOG_DEBUG, "-ndi_filter_destroy_audioonly('%s'...)", name);
 }
 
+// A batch is only completed by more audio: once it has waited the whole batch length (the source went quiet or
+// stopped), send what it has. Runs on the video thread, which never waits for the audio thread.
+static void ndi_filter_flush_stale_audio(ndi_filter_t *f)
+{
+	if (pthread_mutex_trylock(&f->audio_batch_mutex) != 0)
+		return;
+
+	uint64_t budget_ns = (uint64_t)f->audio_batch_ms * 1000000ULL;
+	if (f->audio_batch.samples && os_gettime_ns() - f->audio_batch_start_ns >= budget_ns) {
+		if (f->is_audioonly) {
+			f->audio_senders++;
+			ndi_filter_flush_audio(f, nullptr);
+			f->audio_senders--;
+		} else {
+			ndi_filter_flush_audio(f, &f->ndi_sender_audio_mutex);
+		}
+	}
+	pthread_mutex_unlock(&f->audio_batch_mutex);
+}
+
 void ndi_filter_tick(void *data, float)
 {
 	auto f = (ndi_filter_t *)data;
 	obs_get_video_info(&f->ovi);
+	ndi_filter_flush_stale_audio(f);
 
 	if (!is_filter_valid(f)) {
 		return;
@@ -615,6 +1050,58 @@ void ndi_filter_tick(void *data, float)
 	}
 }
 
+void ndi_audiofilter_tick(void *data, float)
+{
+	ndi_filter_flush_stale_audio((ndi_filter_t *)data);
+}
+
+// Called with audio_batch_mutex held
+static void ndi_filter_send_audio(ndi_filter_t *f, obs_audio_data *audio_data, pthread_mutex_t *sender_mutex)
+{
+	const uint32_t channels = (uint32_t)f->oai.speakers;
+	const uint32_t batch_samples = (uint32_t)((uint64_t)f->audio_batch_ms * f->oai.samples_per_sec / 1000);
+	if (batch_samples <= audio_data->frames) {
+		// Not batching, or the blocks are already as long as a batch: send them as they come
+		ndi_filter_flush_audio(f, sender_mutex);
+		if (!ndi_filter_has_receivers(f, sender_mutex))
+			return;
+
+		NDIlib_audio_frame_v3_t audio_frame = {0};
+		audio_frame.sample_rate = f->oai.samples_per_sec;
+		audio_frame.no_channels = channels;
+		audio_frame.timecode = NDIlib_send_timecode_synthesize;
+		audio_frame.no_samples = audio_data->frames;
+		audio_frame.p_metadata = NULL; // No metadata support yet!
+		ndi_audio_set_fltp(&audio_frame, audio_data->data, &f->audio_conv_buffer, &f->audio_conv_buffer_size);
+
+		if (sender_mutex)
+			pthread_mutex_lock(sender_mutex);
+		NDIlib_send_instance_t sender = f->ndi_sender;
+		if (sender)
+			ndiLib->send_send_audio_v3(sender, &audio_frame);
+		if (sender_mutex)
+			pthread_mutex_unlock(sender_mutex);
+		return;
+	}
+
+	ndi_audio_batch_t *batch = &f->audio_batch;
+	if (f->audio_batch_rate != f->oai.samples_per_sec || batch->channels != channels ||
+	    batch->capacity != batch_samples) {
+		ndi_filter_flush_audio(f, sender_mutex);
+		ndi_audio_batch_configure(batch, channels, batch_samples);
+		f->audio_batch_rate = f->oai.samples_per_sec;
+	}
+
+	// Frames hold whole OBS blocks, so the batch is sent early rather than split one
+	if (batch->samples + audio_data->frames > batch->capacity)
+		ndi_filter_flush_audio(f, sender_mutex);
+	if (!batch->samples)
+		f->audio_batch_start_ns = os_gettime_ns();
+	ndi_audio_batch_append(batch, audio_data->data, audio_data->frames);
+	if (batch->samples == batch->capacity)
+		ndi_filter_flush_audio(f, sender_mutex);
+}
+
 obs_audio_data *ndi_filter_asyncaudio(void *data, obs_audio_data *audio_data)
 {
 	// NOTE: The logic in this function should be similar to
@@ -623,43 +1110,18 @@ obs_audio_data *ndi_filter_asyncaudio(void *data, obs_audio_data *audio_data)
 
 	obs_get_audio_info(&f->oai);
 
-	NDIlib_audio_frame_v3_t audio_frame = {0};
-	audio_frame.sample_rate = f->oai.samples_per_sec;
-	audio_frame.no_channels = f->oai.speakers;
-	audio_frame.timecode = NDIlib_send_timecode_synthesize;
-	audio_frame.no_samples = audio_data->frames;
-	audio_frame.channel_stride_in_bytes =
-		audio_frame.no_samples *
-		4; // TODO: Check if this correct or should 4 be replaced by number of channels.
-	// audio_frame.FourCC = NDIlib_FourCC_audio_type_FLTP;
-	// audio_frame.p_data = p_frame;
-	audio_frame.p_metadata = NULL; // No metadata support yet!
-
-	const size_t data_size = audio_frame.no_channels * audio_frame.channel_stride_in_bytes;
-
-	if (data_size > f->audio_conv_buffer_size) {
-		obs_log(LOG_DEBUG, "ndi_filter_asyncaudio: growing audio_conv_buffer from %zu to %zu bytes",
-			f->audio_conv_buffer_size, data_size);
-		if (f->audio_conv_buffer) {
-			obs_log(LOG_DEBUG, "ndi_filter_asyncaudio: freeing %zu bytes", f->audio_conv_buffer_size);
-			bfree(f->audio_conv_buffer);
-		}
-		obs_log(LOG_DEBUG, "ndi_filter_asyncaudio: allocating %zu bytes", data_size);
-		f->audio_conv_buffer = (uint8_t *)bmalloc(data_size);
-		f->audio_conv_buffer_size = data_size;
-	}
-
-	for (int i = 0; i < audio_frame.no_channels; ++i) {
-		memcpy(f->audio_conv_buffer + (i * audio_frame.channel_stride_in_bytes), audio_data->data[i],
-		       audio_frame.channel_stride_in_bytes);
+	if (f->is_audioonly) {
+		f->audio_senders++;
+		pthread_mutex_lock(&f->audio_batch_mutex);
+		ndi_filter_send_audio(f, audio_data, nullptr);
+		pthread_mutex_unlock(&f->audio_batch_mutex);
+		f->audio_senders--;
+	} else {
+		pthread_mutex_lock(&f->audio_batch_mutex);
+		ndi_filter_send_audio(f, audio_data, &f->ndi_sender_audio_mutex);
+		pthread_mutex_unlock(&f->audio_batch_mutex);
 	}
 
-	audio_frame.p_data = f->audio_conv_buffer;
-
-	pthread_mutex_lock(&f->ndi_sender_audio_mutex);
-	ndiLib->send_send_audio_v3(f->ndi_sender, &audio_frame);
-	pthread_mutex_unlock(&f->ndi_sender_audio_mutex);
-
 	return audio_data;
 }
 
@@ -702,6 +1164,8 @@ obs_source_info create_ndi_audiofilter_info()
 	ndi_filter_info.update = ndi_filter_update;
 	ndi_filter_info.destroy = ndi_filter_destroy_audioonly;
 
+	ndi_filter_info.video_tick = ndi_audiofilter_tick;
+
 	ndi_filter_info.filter_audio = ndi_filter_asyncaudio;
 
 	return ndi_filter_info;
@@ -1,62 +1,146 @@
 #include "ndi-finder.h"
 
+// How long one wait for source changes may block, which bounds the shutdown delay
+#define NDI_FINDER_WAIT_MS 500
+
 std::vector<std::string> NDIFinder::NDISourceList;
-std::chrono::time_point<std::chrono::steady_clock> NDIFinder::lastRefreshTime;
+std::map<void *, NDIFinder::Callback> NDIFinder::listeners;
 std::mutex NDIFinder::listMutex;
-bool NDIFinder::isRefreshing = false;
+std::mutex NDIFinder::listenerMutex;
+std::mutex NDIFinder::threadMutex;
+std::thread NDIFinder::finderThread;
+std::atomic<bool> NDIFinder::running{false};
+std::string NDIFinder::groups;
+std::string NDIFinder::extraIps;
+std::vector<std::string> NDIFinder::filters;
+bool NDIFinder::showLocalSources = true;
 
-std::vector<std::string> NDIFinder::getNDISourceList(Callback callback)
+std::vector<std::string> NDIFinder::getNDISourceList()
 {
+	start();
+
 	std::lock_guard<std::mutex> lock(listMutex);
-	auto now = std::chrono::steady_clock::now();
-	auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - lastRefreshTime).count();
+	return NDISourceList;
+}
+
+void NDIFinder::addListener(void *owner, Callback callback)
+{
+	std::lock_guard<std::mutex> lock(listenerMutex);
+	listeners[owner] = std::move(callback);
+}
+
+// Waits for a running notification, so the owner can be freed right after
+void NDIFinder::removeListener(void *owner)
+{
+	std::lock_guard<std::mutex> lock(listenerMutex);
+	listeners.erase(owner);
+}
+
+void NDIFinder::start()
+{
+	std::lock_guard<std::mutex> lock(threadMutex);
+	if (running || !ndiLib)
+		return;
+
+	// A finder that failed to start has exited on its own
+	if (finderThread.joinable())
+		finderThread.join();
 
-	if (duration > 5 && !isRefreshing) {
-		isRefreshing = true;
-		std::thread(refreshNDISourceList, callback).detach();
+	auto config = Config::Current();
+	groups = QT_TO_UTF8(config->FinderGroups);
+	extraIps = QT_TO_UTF8(config->FinderExtraIps);
+	showLocalSources = config->FinderShowLocalSources;
+	filters.clear();
+	for (const auto &filter : config->FinderFilter.split(',', Qt::SkipEmptyParts)) {
+		auto trimmed = filter.trimmed();
+		if (!trimmed.isEmpty())
+			filters.push_back(QT_TO_UTF8(trimmed.toLower()));
 	}
 
-	return NDISourceList;
+	running = true;
+	finderThread = std::thread(run);
 }
 
-void NDIFinder::refreshNDISourceList(Callback callback)
+void NDIFinder::restart()
 {
-	retrieveNDISourceList();
-	std::lock_guard<std::mutex> lock(listMutex);
-	lastRefreshTime = std::chrono::steady_clock::now();
-	callback(&NDISourceList);
-	isRefreshing = false;
+	if (!running)
+		return;
+
+	shutdown();
+	start();
+}
+
+// Case insensitive, any of the comma separated terms
+bool NDIFinder::matchesFilter(const std::string &name)
+{
+	if (filters.empty())
+		return true;
+
+	auto lower = QString::fromUtf8(name.c_str()).toLower().toStdString();
+	for (const auto &filter : filters) {
+		if (lower.find(filter) != std::string::npos)
+			return true;
+	}
+	return false;
 }
 
-void NDIFinder::retrieveNDISourceList()
+void NDIFinder::shutdown()
+{
+	std::lock_guard<std::mutex> lock(threadMutex);
+	running = false;
+	if (finderThread.joinable())
+		finderThread.join();
+
+	std::lock_guard<std::mutex> list_lock(listMutex);
+	NDISourceList.clear();
+}
+
+void NDIFinder::run()
 {
 	NDIlib_find_create_t find_desc = {0};
-	find_desc.show_local_sources = true;
-	find_desc.p_groups = NULL;
+	find_desc.show_local_sources = showLocalSources;
+	find_desc.p_groups = groups.empty() ? NULL : groups.c_str();
+	find_desc.p_extra_ips = extraIps.empty() ? NULL : extraIps.c_str();
 	NDIlib_find_instance_t ndi_find = ndiLib->find_create_v2(&find_desc);
 
 	if (!ndi_find) {
+		obs_log(LOG_WARNING, "WARN-431 - NDI source finder could not be created");
+		running = false;
 		return;
 	}
+	obs_log(LOG_INFO, "NDIFinder: discovery started (groups='%s', extra IPs='%s', local sources=%s, %zu filters)",
+		groups.c_str(), extraIps.c_str(), showLocalSources ? "true" : "false", filters.size());
 
-	uint32_t n_sources = 0;
-	uint32_t last_n_sources = 0;
-	const NDIlib_source_t *sources = NULL;
-	do {
-		ndiLib->find_wait_for_sources(ndi_find, 1000);
-		last_n_sources = n_sources;
-		sources = ndiLib->find_get_current_sources(ndi_find, &n_sources);
-	} while (n_sources > last_n_sources);
-
-	std::vector<std::string> newList;
-	for (uint32_t i = 0; i < n_sources; ++i) {
-		newList.push_back(sources[i].p_ndi_name);
-	}
+	while (running) {
+		// Returns early as soon as a source appears or disappears
+		if (!ndiLib->find_wait_for_sources(ndi_find, NDI_FINDER_WAIT_MS))
+			continue;
+
+		uint32_t n_sources = 0;
+		const NDIlib_source_t *sources = ndiLib->find_get_current_sources(ndi_find, &n_sources);
+
+		std::vector<std::string> newList;
+		newList.reserve(n_sources);
+		for (uint32_t i = 0; i < n_sources; ++i) {
+			if (matchesFilter(sources[i].p_ndi_name))
+				newList.push_back(sources[i].p_ndi_name);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(listMutex);
+			if (newList == NDISourceList)
+				continue;
+			NDISourceList = newList;
+		}
+		obs_log(LOG_DEBUG, "NDIFinder: %zu sources", newList.size());
 
-	{
-		std::lock_guard<std::mutex> lock(listMutex);
-		NDISourceList = newList;
+		// Listeners may query the list again, which only takes listMutex
+		std::lock_guard<std::mutex> lock(listenerMutex);
+		for (auto &listener : listeners) {
+			listener.second(newList);
+		}
 	}
 
 	ndiLib->find_destroy(ndi_find);
+	obs_log(LOG_DEBUG, "NDIFinder: discovery stopped");
 }
@@ -5,19 +5,50 @@
 #include <thread>
 #include <mutex>
 #include <functional>
-#include <chrono>
+#include <map>
+#include <atomic>
 #include <Processing.NDI.Lib.h>
 
+/**
+ * NDI source discovery. A single finder runs on a background thread from the first request until shutdown and
+ * keeps NDISourceList up to date, so the list is served from the cache and changes are pushed to listeners.
+ * It discovers the groups and extra IPs of the Config (and the Discovery Server of the NDI runtime configuration,
+ * which the finder uses on its own) and only keeps the sources matching Config::FinderFilter.
+ */
 class NDIFinder {
 public:
-	using Callback = std::function<void(void *)>;
-	static std::vector<std::string> getNDISourceList(Callback callback);
+	using Callback = std::function<void(const std::vector<std::string> &)>;
+
+	// Cached source names, starts the finder on first use
+	static std::vector<std::string> getNDISourceList();
+
+	// Called from the finder thread each time a source appears or disappears, until removed
+	static void addListener(void *owner, Callback callback);
+	static void removeListener(void *owner);
+
+	// Applies changed discovery settings: restarts the finder if it runs
+	static void restart();
+
+	// Stops the finder thread, before the NDI library is unloaded
+	static void shutdown();
 
 private:
 	static std::vector<std::string> NDISourceList;
-	static std::chrono::time_point<std::chrono::steady_clock> lastRefreshTime;
+	static std::map<void *, Callback> listeners;
+	// listMutex guards the list, listenerMutex the listeners and their notification, threadMutex starting and
+	// stopping the finder thread
 	static std::mutex listMutex;
-	static bool isRefreshing;
-	static void refreshNDISourceList(Callback callback);
-	static void retrieveNDISourceList();
+	static std::mutex listenerMutex;
+	static std::mutex threadMutex;
+	static std::thread finderThread;
+	static std::atomic<bool> running;
+	// Discovery settings of the running finder, copied from the Config on start
+	static std::string groups;
+	static std::string extraIps;
+	static std::vector<std::string> filters;
+	static bool showLocalSources;
+
+	static void start();
+	static void run();
+	static bool matchesFilter(const std::string &name);
 };
@@ -0,0 +1,363 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "plugin-main.h"
+#include "ndi-finder.h"
+#include "ndi-trace.h"
+
+#include <util/threading.h>
+#include <graphics/vec4.h>
+
+#include <QDesktopServices>
+#include <QUrl>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+//
+// NDI Multiview source ("ndi_multiview"): a grid of NDI sources for monitoring walls.
+// Each tile is a private "ndi_source_direct" receiver at lowest bandwidth without audio, received on the shared
+// receiver pool and decoded straight into its texture. Once per frame the tiles are drawn into one atlas
+// texture, which every view of the multiview then draws in a single pass.
+//
+
+#define PROP_TILES "ndi_multiview_tiles"
+#define PROP_COLUMNS "ndi_multiview_columns"
+#define PROP_TILE_WIDTH "ndi_multiview_tile_width"
+#define PROP_TILE_HEIGHT "ndi_multiview_tile_height"
+// Followed by the tile number, from 1
+#define PROP_TILE_SOURCE "ndi_multiview_source_"
+
+#define NDI_MULTIVIEW_MAX_TILES 64
+
+// Settings of the tile receivers, see ndi-source.cpp
+extern void ndi_source_set_tile_settings(obs_data_t *settings, const char *ndi_source_name);
+
+typedef struct ndi_multiview_t {
+	obs_source_t *obs_source;
+
+	// Guards the tiles against the graphics thread and enum_active_sources while update replaces them
+	pthread_mutex_t tiles_mutex;
+	obs_source_t *tiles[NDI_MULTIVIEW_MAX_TILES];
+	std::string tile_names[NDI_MULTIVIEW_MAX_TILES];
+	int tile_count;
+	int columns;
+	int rows;
+	uint32_t tile_width;
+	uint32_t tile_height;
+
+	// Graphics thread only
+	gs_texrender_t *atlas;
+	// Set by video_tick, the first video_render of the frame redraws the atlas
+	bool atlas_dirty;
+} ndi_multiview_t;
+
+static std::string ndi_multiview_tile_key(int index)
+{
+	return PROP_TILE_SOURCE + std::to_string(index + 1);
+}
+
+const char *ndi_multiview_getname(void *)
+{
+	return obs_module_text("NDIPlugin.NDIMultiviewName");
+}
+
+obs_properties_t *ndi_multiview_getproperties(void *)
+{
+	obs_properties_t *props = obs_properties_create();
+
+	obs_property_t *tiles = obs_properties_add_int_slider(
+		props, PROP_TILES, obs_module_text("NDIPlugin.MultiviewProps.Tiles"), 1, NDI_MULTIVIEW_MAX_TILES, 1);
+	obs_property_set_modified_callback(tiles, [](obs_properties_t *props_, obs_property_t *,
+						     obs_data_t *settings_) {
+		auto tile_count = obs_data_get_int(settings_, PROP_TILES);
+		for (int i = 0; i < NDI_MULTIVIEW_MAX_TILES; i++) {
+			obs_property_set_visible(obs_properties_get(props_, ndi_multiview_tile_key(i).c_str()),
+						 i < tile_count);
+		}
+		return true;
+	});
+
+	obs_properties_add_int(props, PROP_COLUMNS, obs_module_text("NDIPlugin.MultiviewProps.Columns"), 0,
+			       NDI_MULTIVIEW_MAX_TILES, 1);
+
+	obs_property_t *tile_width = obs_properties_add_int(
+		props, PROP_TILE_WIDTH, obs_module_text("NDIPlugin.MultiviewProps.TileWidth"), 16, 3840, 2);
+	obs_property_int_set_suffix(tile_width, " px");
+	obs_property_t *tile_height = obs_properties_add_int(
+		props, PROP_TILE_HEIGHT, obs_module_text("NDIPlugin.MultiviewProps.TileHeight"), 16, 2160, 2);
+	obs_property_int_set_suffix(tile_height, " px");
+
+	// Served from the finder cache; the properties are refreshed when sources appear or disappear
+	auto ndi_sources = NDIFinder::getNDISourceList();
+	for (int i = 0; i < NDI_MULTIVIEW_MAX_TILES; i++) {
+		auto description = std::string(obs_module_text("NDIPlugin.MultiviewProps.Source")) + " " +
+				   std::to_string(i + 1);
+		obs_property_t *source_list =
+			obs_properties_add_list(props, ndi_multiview_tile_key(i).c_str(), description.c_str(),
+						OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
+		obs_property_list_add_string(source_list, "", "");
+		for (auto &source : ndi_sources) {
+			obs_property_list_add_string(source_list, source.c_str(), source.c_str());
+		}
+	}
+
+	auto group_ndi = obs_properties_create();
+	obs_properties_add_button(group_ndi, "ndi_website", NDI_OFFICIAL_WEB_URL,
+				  [](obs_properties_t *, obs_property_t *, void *) {
+					  QDesktopServices::openUrl(QUrl(rehostUrl(PLUGIN_REDIRECT_NDI_WEB_URL)));
+					  return false;
+				  });
+	obs_properties_add_group(props, "ndi", "NDI®", OBS_GROUP_NORMAL, group_ndi);
+
+	return props;
+}
+
+void ndi_multiview_getdefaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, PROP_TILES, 4);
+	obs_data_set_default_int(settings, PROP_COLUMNS, 0);
+	obs_data_set_default_int(settings, PROP_TILE_WIDTH, 640);
+	obs_data_set_default_int(settings, PROP_TILE_HEIGHT, 360);
+}
+
+static obs_source_t *ndi_multiview_create_tile(ndi_multiview_t *m, int index, const std::string &ndi_source_name)
+{
+	if (ndi_source_name.empty())
+		return nullptr;
+
+	auto tile_name = std::string(obs_source_get_name(m->obs_source)) + " [" + std::to_string(index + 1) + "]";
+	obs_data_t *tile_settings = obs_data_create();
+	ndi_source_set_tile_settings(tile_settings, ndi_source_name.c_str());
+	obs_source_t *tile = obs_source_create_private("ndi_source_direct", tile_name.c_str(), tile_settings);
+	obs_data_release(tile_settings);
+	return tile;
+}
+
+void ndi_multiview_update(void *data, obs_data_t *settings)
+{
+	auto m = (ndi_multiview_t *)data;
+
+	const int tile_count = (int)std::clamp(obs_data_get_int(settings, PROP_TILES), 1LL,
+					       (long long)NDI_MULTIVIEW_MAX_TILES);
+	int columns = (int)obs_data_get_int(settings, PROP_COLUMNS);
+	if (columns <= 0)
+		columns = (int)std::ceil(std::sqrt((double)tile_count));
+	columns = std::min(columns, tile_count);
+
+	// Only the tiles whose NDI source changed get a new receiver
+	obs_source_t *new_tiles[NDI_MULTIVIEW_MAX_TILES] = {};
+	bool replaced[NDI_MULTIVIEW_MAX_TILES] = {};
+	std::string names[NDI_MULTIVIEW_MAX_TILES];
+	for (int i = 0; i < tile_count; i++) {
+		names[i] = obs_data_get_string(settings, ndi_multiview_tile_key(i).c_str());
+		if (i < m->tile_count && names[i] == m->tile_names[i])
+			continue;
+		replaced[i] = true;
+		new_tiles[i] = ndi_multiview_create_tile(m, i, names[i]);
+	}
+
+	obs_source_t *old_tiles[NDI_MULTIVIEW_MAX_TILES] = {};
+	pthread_mutex_lock(&m->tiles_mutex);
+	for (int i = 0; i < NDI_MULTIVIEW_MAX_TILES; i++) {
+		if (i < tile_count && !replaced[i])
+			continue;
+		old_tiles[i] = m->tiles[i];
+		m->tiles[i] = new_tiles[i];
+		m->tile_names[i] = names[i];
+	}
+	m->tile_count = tile_count;
+	m->columns = columns;
+	m->rows = (tile_count + columns - 1) / columns;
+	m->tile_width = (uint32_t)obs_data_get_int(settings, PROP_TILE_WIDTH);
+	m->tile_height = (uint32_t)obs_data_get_int(settings, PROP_TILE_HEIGHT);
+	pthread_mutex_unlock(&m->tiles_mutex);
+
+	// Outside the lock: destroying a tile enters the graphics context, which video_render holds with the lock
+	for (int i = 0; i < NDI_MULTIVIEW_MAX_TILES; i++) {
+		if (old_tiles[i]) {
+			obs_source_remove_active_child(m->obs_source, old_tiles[i]);
+			obs_source_release(old_tiles[i]);
+		}
+		if (new_tiles[i])
+			obs_source_add_active_child(m->obs_source, new_tiles[i]);
+	}
+
+	obs_log(LOG_INFO, "NDI Multiview Updated: '%s' (%d sources, %dx%d tiles of %ux%u)",
+		obs_source_get_name(m->obs_source), tile_count, m->columns, m->rows, m->tile_width, m->tile_height);
+}
+
+void *ndi_multiview_create(obs_data_t *settings, obs_source_t *obs_source)
+{
+	auto m = new ndi_multiview_t();
+	m->obs_source = obs_source;
+	pthread_mutex_init(&m->tiles_mutex, nullptr);
+
+	obs_enter_graphics();
+	m->atlas = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	obs_leave_graphics();
+
+	ndi_multiview_update(m, settings);
+
+	NDIFinder::addListener(m,
+			       [m](const std::vector<std::string> &) { obs_source_update_properties(m->obs_source); });
+
+	return m;
+}
+
+void ndi_multiview_destroy(void *data)
+{
+	auto m = (ndi_multiview_t *)data;
+
+	NDIFinder::removeListener(m);
+
+	for (auto &tile : m->tiles) {
+		if (tile) {
+			obs_source_remove_active_child(m->obs_source, tile);
+			obs_source_release(tile);
+			tile = nullptr;
+		}
+	}
+
+	obs_enter_graphics();
+	gs_texrender_destroy(m->atlas);
+	obs_leave_graphics();
+
+	pthread_mutex_destroy(&m->tiles_mutex);
+	delete m;
+}
+
+uint32_t ndi_multiview_get_width(void *data)
+{
+	auto m = (ndi_multiview_t *)data;
+	return m->columns * m->tile_width;
+}
+
+uint32_t ndi_multiview_get_height(void *data)
+{
+	auto m = (ndi_multiview_t *)data;
+	return m->rows * m->tile_height;
+}
+
+void ndi_multiview_enum_active_sources(void *data, obs_source_enum_proc_t enum_callback, void *param)
+{
+	auto m = (ndi_multiview_t *)data;
+
+	pthread_mutex_lock(&m->tiles_mutex);
+	for (int i = 0; i < m->tile_count; i++) {
+		if (m->tiles[i])
+			enum_callback(m->obs_source, m->tiles[i], param);
+	}
+	pthread_mutex_unlock(&m->tiles_mutex);
+}
+
+void ndi_multiview_tick(void *data, float)
+{
+	auto m = (ndi_multiview_t *)data;
+	m->atlas_dirty = true;
+}
+
+// Each tile fitted in its cell, keeping its aspect ratio
+static void ndi_multiview_render_atlas(ndi_multiview_t *m, uint32_t width, uint32_t height)
+{
+	NDI_TRACE_ZONE("ndi_multiview atlas");
+
+	gs_texrender_reset(m->atlas);
+	if (!gs_texrender_begin(m->atlas, width, height))
+		return;
+
+	vec4 background;
+	vec4_zero(&background);
+	gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
+	gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	for (int i = 0; i < m->tile_count; i++) {
+		obs_source_t *tile = m->tiles[i];
+		uint32_t tile_source_width = tile ? obs_source_get_width(tile) : 0;
+		uint32_t tile_source_height = tile ? obs_source_get_height(tile) : 0;
+		if (tile_source_width == 0 || tile_source_height == 0)
+			continue;
+
+		float scale = std::min((float)m->tile_width / tile_source_width,
+				       (float)m->tile_height / tile_source_height);
+		float x = (float)((i % m->columns) * m->tile_width) + (m->tile_width - tile_source_width * scale) / 2;
+		float y = (float)((i / m->columns) * m->tile_height) +
+			  (m->tile_height - tile_source_height * scale) / 2;
+
+		gs_matrix_push();
+		gs_matrix_translate3f(x, y, 0.0f);
+		gs_matrix_scale3f(scale, scale, 1.0f);
+		obs_source_video_render(tile);
+		gs_matrix_pop();
+	}
+
+	gs_blend_state_pop();
+	gs_texrender_end(m->atlas);
+}
+
+void ndi_multiview_render(void *data, gs_effect_t *)
+{
+	auto m = (ndi_multiview_t *)data;
+
+	pthread_mutex_lock(&m->tiles_mutex);
+	const uint32_t width = m->columns * m->tile_width;
+	const uint32_t height = m->rows * m->tile_height;
+	if (m->atlas_dirty && width > 0 && height > 0) {
+		ndi_multiview_render_atlas(m, width, height);
+		m->atlas_dirty = false;
+	}
+	pthread_mutex_unlock(&m->tiles_mutex);
+
+	gs_texture_t *texture = gs_texrender_get_texture(m->atlas);
+	if (!texture)
+		return;
+
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+	while (gs_effect_loop(effect, "Draw")) {
+		gs_draw_sprite(texture, 0, width, height);
+	}
+}
+
+obs_source_info create_ndi_multiview_info()
+{
+	// https://docs.obsproject.com/reference-sources#source-definition-structure-obs-source-info
+	obs_source_info ndi_multiview_info = {};
+	ndi_multiview_info.id = "ndi_multiview";
+	ndi_multiview_info.type = OBS_SOURCE_TYPE_INPUT;
+	ndi_multiview_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_DO_NOT_DUPLICATE;
+
+	ndi_multiview_info.get_name = ndi_multiview_getname;
+	ndi_multiview_info.get_properties = ndi_multiview_getproperties;
+	ndi_multiview_info.get_defaults = ndi_multiview_getdefaults;
+
+	ndi_multiview_info.create = ndi_multiview_create;
+	ndi_multiview_info.update = ndi_multiview_update;
+	ndi_multiview_info.destroy = ndi_multiview_destroy;
+	ndi_multiview_info.enum_active_sources = ndi_multiview_enum_active_sources;
+	ndi_multiview_info.video_tick = ndi_multiview_tick;
+	ndi_multiview_info.video_render = ndi_multiview_render;
+
+	ndi_multiview_info.get_width = ndi_multiview_get_width;
+	ndi_multiview_info.get_height = ndi_multiview_get_height;
+
+	return ndi_multiview_info;
+}
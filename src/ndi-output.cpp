@@ -16,42 +16,39 @@
 ******************************************************************************/
 
 #include "plugin-main.h"
+#include "ndi-audio.h"
+#include "ndi-buffer-pool.h"
+#include "ndi-color-convert.h"
+#include "ndi-readback.h"
+#include "ndi-stripe-pool.h"
+#include "ndi-trace.h"
+#include "ndi-video-converter.h"
 // #include "plugin-support.h"
 
-static FORCE_INLINE uint32_t min_uint32(uint32_t a, uint32_t b)
-{
-	return a < b ? a : b;
-}
-
-typedef void (*uyvy_conv_function)(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
-				   uint8_t *output, uint32_t out_linesize);
-
-static void convert_i444_to_uyvy(uint8_t *input[], uint32_t in_linesize[], uint32_t start_y, uint32_t end_y,
-				 uint8_t *output, uint32_t out_linesize)
-{
-	uint8_t *_Y;
-	uint8_t *_U;
-	uint8_t *_V;
-	uint8_t *_out;
-	uint32_t width = min_uint32(in_linesize[0], out_linesize);
-	for (uint32_t y = start_y; y < end_y; ++y) {
-		_Y = input[0] + ((size_t)y * (size_t)in_linesize[0]);
-		_U = input[1] + ((size_t)y * (size_t)in_linesize[1]);
-		_V = input[2] + ((size_t)y * (size_t)in_linesize[2]);
-
-		_out = output + ((size_t)y * (size_t)out_linesize);
-
-		for (uint32_t x = 0; x < width; x += 2) {
-			// Quality loss here. Some chroma samples are ignored.
-			*(_out++) = *(_U++);
-			_U++;
-			*(_out++) = *(_Y++);
-			*(_out++) = *(_V++);
-			_V++;
-			*(_out++) = *(_Y++);
-		}
-	}
-}
+#include <util/threading.h>
+
+#include <atomic>
+
+// Async sends read the frame until the next send call, and that call blocks until NDI is done with the previous
+// frame: one buffer is read by NDI, one is being handed over by the send thread and one is filled by raw_video
+#define NDI_OUTPUT_SEND_BUFFERS 3
+
+//
+// Send telemetry, written by the video/audio/send threads and read from the proc handler without locking.
+// Counters restart with each output start.
+//
+typedef struct ndi_output_stats_t {
+	// Frames handed to NDI, and video frames skipped by the drop policy while the send thread was busy
+	std::atomic<int64_t> video_frames;
+	std::atomic<int64_t> video_skipped;
+	std::atomic<int64_t> audio_frames;
+	// Time spent in send_send_video_async_v2 (compression of the previous frame, clocking) and send_send_audio_v3
+	std::atomic<uint64_t> video_send_ns;
+	std::atomic<uint64_t> video_send_max_ns;
+	std::atomic<uint64_t> audio_send_ns;
+	// Time the OBS video thread waited for a free buffer (drop policy off)
+	std::atomic<uint64_t> video_wait_ns;
+} ndi_output_stats_t;
 
 typedef struct {
 	obs_output_t *output;
@@ -59,26 +56,67 @@ typedef struct {
 	const char *ndi_groups;
 	bool uses_video;
 	bool uses_audio;
+	// Keep sending while no receiver is connected, otherwise nothing is converted nor sent until one connects
+	bool always_send;
+	// Receiver state of the video path, for logging suspend/resume
+	bool video_suspended;
+	// Let the NDI SDK pace video/audio sends to the frame/sample rate (OBS already delivers them in real time)
+	bool clock_video;
+	bool clock_audio;
+	// Skip video frames while the send thread is still busy instead of blocking the OBS video thread
+	bool drop_frames;
 
 	bool started;
 
 	NDIlib_send_instance_t ndi_sender;
+	// Guards ndi_sender against get_connections, which other modules call from their own threads
+	pthread_mutex_t sender_mutex;
 
 	uint32_t frame_width;
 	uint32_t frame_height;
 	NDIlib_FourCC_video_type_e frame_fourcc;
 	uint32_t video_framerate_num;
 	uint32_t video_framerate_den;
+	// A private video_output (scaled video, preview and scene outputs) hands the repeats of a frame back to
+	// back; raw_video spreads them over their ticks. Never on the canvas video, whose thread feeds every output.
+	bool pace_video;
+	uint64_t video_frame_interval_ns;
+	ndi_frame_pacer_t video_pacer;
 
 	size_t audio_channels;
 	uint32_t audio_samplerate;
 
-	uint8_t *conv_buffer;
-	uint32_t conv_linesize;
+	// Owned frames handed to send_send_video_async_v2; OBS frame data is never referenced after raw_video returns
+	uint8_t *send_buffers[NDI_OUTPUT_SEND_BUFFERS];
+	size_t send_buffer_size;
+	uint32_t send_linesize;
+
+	// Video sends run on their own thread, so a slow or clocked NDI sender does not stall the OBS video thread.
+	// Buffer indices (-1 for none) are guarded by send_mutex: the one waiting for the send thread, the one
+	// being sent and the one NDI may still read.
+	pthread_t send_thread;
+	bool send_thread_active;
+	volatile bool send_thread_running;
+	pthread_mutex_t send_mutex;
+	os_event_t *send_event;
+	os_event_t *send_free_event;
+	int send_pending;
+	int send_active;
+	int send_in_flight;
+
+	ndi_output_stats_t stats;
 	uyvy_conv_function conv_function;
 
 	uint8_t *audio_conv_buffer;
 	size_t audio_conv_buffer_size;
+
+	// Resolution, crop and frame rate conversion. On the main canvas it runs on the GPU: the canvas texture is
+	// scaled into scale_texrender after each render and fed to the output through scaled_video instead of
+	// the canvas video.
+	ndi_video_converter_t converter;
+	video_t *scaled_video;
+	gs_texrender_t *scale_texrender;
+	ndi_readback_t scale_readback;
 } ndi_output_t;
 
 const char *ndi_output_getname(void *)
@@ -109,11 +147,145 @@ void ndi_output_getdefaults(obs_data_t *settings)
 	obs_data_set_default_string(settings, "ndi_groups", "DistroAV output (changeme)");
 	obs_data_set_default_bool(settings, "uses_video", true);
 	obs_data_set_default_bool(settings, "uses_audio", true);
+	obs_data_set_default_bool(settings, "always_send", false);
+	obs_data_set_default_bool(settings, "clock_video", false);
+	obs_data_set_default_bool(settings, "clock_audio", false);
+	obs_data_set_default_bool(settings, "drop_frames", true);
 	obs_log(LOG_DEBUG, "-ndi_output_getdefaults()");
 }
 
 void ndi_output_update(void *data, obs_data_t *settings);
 
+// "get_connections" proc: number of NDI receivers connected to the output, 0 when stopped
+static void ndi_output_get_connections(void *data, calldata_t *cd)
+{
+	auto o = (ndi_output_t *)data;
+	int connections = 0;
+	pthread_mutex_lock(&o->sender_mutex);
+	if (o->ndi_sender)
+		connections = ndiLib->send_get_no_connections(o->ndi_sender, 0);
+	pthread_mutex_unlock(&o->sender_mutex);
+	calldata_set_int(cd, "connections", connections);
+}
+
+static double ndi_output_stats_average_ms(uint64_t total_ns, int64_t count)
+{
+	return count > 0 ? (double)total_ns / (double)count / 1000000.0 : 0.0;
+}
+
+// "get_stats" proc: send telemetry since the output started
+static void ndi_output_get_stats(void *data, calldata_t *cd)
+{
+	auto o = (ndi_output_t *)data;
+	auto &stats = o->stats;
+	ndi_output_get_connections(data, cd);
+	calldata_set_int(cd, "video_frames", stats.video_frames);
+	calldata_set_int(cd, "video_skipped", stats.video_skipped);
+	calldata_set_float(cd, "video_send_ms", ndi_output_stats_average_ms(stats.video_send_ns, stats.video_frames));
+	calldata_set_float(cd, "video_send_max_ms", (double)stats.video_send_max_ns / 1000000.0);
+	calldata_set_float(cd, "video_wait_ms", (double)stats.video_wait_ns / 1000000.0);
+	calldata_set_int(cd, "audio_frames", stats.audio_frames);
+	calldata_set_float(cd, "audio_send_ms", ndi_output_stats_average_ms(stats.audio_send_ns, stats.audio_frames));
+}
+
+static void ndi_output_reset_stats(ndi_output_t *o)
+{
+	auto &stats = o->stats;
+	stats.video_frames = 0;
+	stats.video_skipped = 0;
+	stats.audio_frames = 0;
+	stats.video_send_ns = 0;
+	stats.video_send_max_ns = 0;
+	stats.audio_send_ns = 0;
+	stats.video_wait_ns = 0;
+}
+
+static void *ndi_output_send_thread(void *data)
+{
+	auto o = (ndi_output_t *)data;
+	os_set_thread_name("distroav-ndi-output-send");
+
+	NDIlib_video_frame_v2_t video_frame = {0};
+	video_frame.xres = o->frame_width;
+	video_frame.yres = o->frame_height;
+	video_frame.frame_rate_N = o->video_framerate_num;
+	video_frame.frame_rate_D = o->video_framerate_den;
+	video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
+	video_frame.timecode = NDIlib_send_timecode_synthesize;
+	video_frame.FourCC = o->frame_fourcc;
+	video_frame.line_stride_in_bytes = o->send_linesize;
+
+	while (true) {
+		os_event_wait(o->send_event);
+
+		pthread_mutex_lock(&o->send_mutex);
+		if (!o->send_thread_running) {
+			pthread_mutex_unlock(&o->send_mutex);
+			break;
+		}
+		int index = o->send_pending;
+		o->send_pending = -1;
+		o->send_active = index;
+		pthread_mutex_unlock(&o->send_mutex);
+		os_event_signal(o->send_free_event);
+		if (index < 0)
+			continue;
+
+		// Returns once NDI is done with the previous frame, after clock_video pacing when enabled
+		video_frame.p_data = o->send_buffers[index];
+		uint64_t start_ns = os_gettime_ns();
+		{
+			NDI_TRACE_ZONE("ndi_output send");
+			ndiLib->send_send_video_async_v2(o->ndi_sender, &video_frame);
+		}
+		uint64_t send_ns = os_gettime_ns() - start_ns;
+
+		auto &stats = o->stats;
+		stats.video_frames++;
+		stats.video_send_ns += send_ns;
+		if (send_ns > stats.video_send_max_ns)
+			stats.video_send_max_ns = send_ns;
+
+		pthread_mutex_lock(&o->send_mutex);
+		o->send_in_flight = index;
+		o->send_active = -1;
+		pthread_mutex_unlock(&o->send_mutex);
+	}
+
+	return nullptr;
+}
+
+static void ndi_output_start_send_thread(ndi_output_t *o)
+{
+	o->send_pending = -1;
+	o->send_active = -1;
+	o->send_in_flight = -1;
+	os_event_init(&o->send_event, OS_EVENT_TYPE_AUTO);
+	os_event_init(&o->send_free_event, OS_EVENT_TYPE_AUTO);
+	o->send_thread_running = true;
+	pthread_create(&o->send_thread, nullptr, ndi_output_send_thread, o);
+	o->send_thread_active = true;
+}
+
+// Call once raw_video can no longer run; a frame still pending is dropped
+static void ndi_output_stop_send_thread(ndi_output_t *o)
+{
+	if (!o->send_thread_active)
+		return;
+
+	pthread_mutex_lock(&o->send_mutex);
+	o->send_thread_running = false;
+	pthread_mutex_unlock(&o->send_mutex);
+	os_event_signal(o->send_event);
+	pthread_join(o->send_thread, nullptr);
+	o->send_thread_active = false;
+
+	os_event_destroy(o->send_event);
+	os_event_destroy(o->send_free_event);
+	o->send_event = nullptr;
+	o->send_free_event = nullptr;
+}
+
 void *ndi_output_create(obs_data_t *settings, obs_output_t *output)
 {
 	auto name = obs_data_get_string(settings, "ndi_name");
@@ -121,16 +293,188 @@ void *ndi_output_create(obs_data_t *settings, obs_output_t *output)
 	obs_log(LOG_DEBUG, "+ndi_output_create(name='%s', groups='%s', ...)", name, groups);
 	auto o = (ndi_output_t *)bzalloc(sizeof(ndi_output_t));
 	o->output = output;
+	pthread_mutex_init(&o->sender_mutex, nullptr);
+	pthread_mutex_init(&o->send_mutex, nullptr);
+	ndi_converter_init(&o->converter);
+	ndi_readback_init(&o->scale_readback);
 	ndi_output_update(o, settings);
 
+	proc_handler_add(obs_output_get_proc_handler(output), "void get_connections(out int connections)",
+			 ndi_output_get_connections, o);
+	proc_handler_add(obs_output_get_proc_handler(output),
+			 "void get_stats(out int connections, out int video_frames, out int video_skipped, "
+			 "out float video_send_ms, out float video_send_max_ms, out float video_wait_ms, "
+			 "out int audio_frames, out float audio_send_ms)",
+			 ndi_output_get_stats, o);
+
 	obs_log(LOG_DEBUG, "-ndi_output_create(name='%s', groups='%s', ...)", name, groups);
 	return o;
 }
 
-static const std::map<video_format, std::string> video_to_color_format_map = {{VIDEO_FORMAT_P010, "P010"},
-									      {VIDEO_FORMAT_I010, "I010"},
-									      {VIDEO_FORMAT_P216, "P216"},
-									      {VIDEO_FORMAT_P416, "P416"}};
+// Only called while capturing, when the sender exists
+static bool ndi_output_has_receivers(ndi_output_t *o)
+{
+	return o->always_send || ndiLib->send_get_no_connections(o->ndi_sender, 0) > 0;
+}
+
+// Video path only: logs the transitions, returns true while frames should be processed
+static bool ndi_output_update_suspended(ndi_output_t *o)
+{
+	bool suspended = !ndi_output_has_receivers(o);
+	if (suspended != o->video_suspended) {
+		o->video_suspended = suspended;
+		obs_log(LOG_INFO, suspended ? "NDI Output Suspended, no receiver connected. '%s'"
+					    : "NDI Output Resumed. '%s'",
+			o->ndi_name);
+	}
+	return !suspended;
+}
+
+static bool ndi_output_uses_converter(ndi_output_t *o)
+{
+	return o->converter.enable_custom_resolution || o->converter.enable_crop ||
+	       o->converter.enable_custom_framerate;
+}
+
+// Runs on the graphics thread once the canvas is rendered
+static void ndi_output_render_scaled(void *data)
+{
+	auto o = (ndi_output_t *)data;
+	ndi_video_converter_t *converter = &o->converter;
+
+	// Nothing is rendered nor read back without receivers. Staged frames would be stale on resume, and the
+	// frame rate conversion restarts from the first frame after the pause.
+	if (!ndi_output_update_suspended(o)) {
+		ndi_readback_reset(&o->scale_readback);
+		ndi_converter_reset_framerate(converter);
+		return;
+	}
+
+	// Frames dropped by the frame rate conversion cost no GPU work
+	uint64_t timestamp = obs_get_video_frame_time();
+	int frames_to_send = 1;
+	if (converter->enable_custom_framerate &&
+	    (!ndi_converter_should_send_frame(converter, timestamp, &frames_to_send) || frames_to_send == 0))
+		return;
+
+	gs_texture_t *canvas = obs_get_main_texture();
+	if (!canvas)
+		return;
+
+	uint32_t width = converter->output_width;
+	uint32_t height = converter->output_height;
+	if (!ndi_readback_configure(&o->scale_readback, width, height, GS_BGRA, 2))
+		return;
+
+	gs_texrender_reset(o->scale_texrender);
+	if (!gs_texrender_begin(o->scale_texrender, width, height))
+		return;
+
+	// Ortho covers the crop region in canvas coordinates, so the draw crops and scales at once
+	gs_ortho(converter->region_left, converter->region_left + converter->region_width, converter->region_top,
+		 converter->region_top + converter->region_height, -100.0f, 100.0f);
+
+	gs_blend_state_push();
+	gs_enable_blending(false);
+	gs_effect_t *effect;
+	if (ndi_converter_gpu_downscale(converter)) {
+		effect = ndi_converter_scale_effect(converter, canvas);
+	} else {
+		effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+		gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), canvas);
+	}
+	while (gs_effect_loop(effect, "Draw")) {
+		gs_draw_sprite(canvas, 0, gs_texture_get_width(canvas), gs_texture_get_height(canvas));
+	}
+	gs_blend_state_pop();
+	gs_texrender_end(o->scale_texrender);
+
+	// Maps the frame staged on the previous call, whose GPU copy is done
+	ndi_readback_stage(&o->scale_readback, gs_texrender_get_texture(o->scale_texrender), timestamp);
+	uint8_t *video_data;
+	uint32_t video_linesize;
+	uint64_t frame_timestamp = 0;
+	if (ndi_readback_map(&o->scale_readback, &video_data, &video_linesize, &frame_timestamp)) {
+		video_frame output_frame;
+		if (video_output_lock_frame(o->scaled_video, &output_frame, frames_to_send, frame_timestamp)) {
+			ndi_readback_copy_plane(output_frame.data[0], output_frame.linesize[0], video_data,
+						video_linesize, width * 4, height);
+			video_output_unlock_frame(o->scaled_video);
+		}
+		ndi_readback_unmap(&o->scale_readback);
+	}
+}
+
+// Replace the canvas video of the output by its GPU scaled version. Returns the video to send, or
+// nullptr on failure.
+static video_t *ndi_output_start_scaled_video(ndi_output_t *o, video_t *canvas)
+{
+	const struct video_output_info *canvas_info = video_output_get_info(canvas);
+	ndi_video_converter_t *converter = &o->converter;
+	ndi_converter_update_region(converter, canvas_info->width, canvas_info->height);
+	converter->accumulator_ns = 0;
+	converter->last_frame_timestamp = 0;
+
+	video_output_info voi = {0};
+	voi.name = o->ndi_name;
+	voi.format = VIDEO_FORMAT_BGRA;
+	voi.width = converter->output_width;
+	voi.height = converter->output_height;
+	voi.fps_num = canvas_info->fps_num;
+	voi.fps_den = canvas_info->fps_den;
+	if (converter->enable_custom_framerate && converter->target_fps_num && converter->target_fps_den) {
+		voi.fps_num = converter->target_fps_num;
+		voi.fps_den = converter->target_fps_den;
+	}
+	voi.cache_size = 16;
+	voi.colorspace = canvas_info->colorspace;
+	voi.range = canvas_info->range;
+
+	if (video_output_open(&o->scaled_video, &voi) != VIDEO_OUTPUT_SUCCESS) {
+		o->scaled_video = nullptr;
+		return nullptr;
+	}
+
+	obs_enter_graphics();
+	o->scale_texrender = gs_texrender_create(GS_BGRA, GS_ZS_NONE);
+	obs_leave_graphics();
+
+	obs_log(LOG_INFO, "NDI Output '%s': converting %ux%u@%u/%u to %ux%u@%u/%u on the GPU", o->ndi_name,
+		canvas_info->width, canvas_info->height, canvas_info->fps_num, canvas_info->fps_den, voi.width,
+		voi.height, voi.fps_num, voi.fps_den);
+
+	obs_output_set_media(o->output, o->scaled_video, obs_output_audio(o->output));
+	return o->scaled_video;
+}
+
+static void ndi_output_stop_scaled_video(ndi_output_t *o)
+{
+	obs_remove_main_rendered_callback(ndi_output_render_scaled, o);
+
+	obs_enter_graphics();
+	ndi_readback_destroy(&o->scale_readback);
+	gs_texrender_destroy(o->scale_texrender);
+	obs_leave_graphics();
+	o->scale_texrender = nullptr;
+
+	// scaled_video stays open: OBS disconnects the output from it on its own thread after stop. It is closed
+	// on the next start or on destroy, once that is done.
+}
+
+// The canvas video the output was created with, closing the scaled video of a previous start
+static video_t *ndi_output_release_scaled_video(ndi_output_t *o)
+{
+	video_t *video = obs_output_video(o->output);
+	if (o->scaled_video) {
+		if (video == o->scaled_video) {
+			video = obs_get_video();
+			obs_output_set_media(o->output, video, obs_output_audio(o->output));
+		}
+		video_output_close(o->scaled_video);
+		o->scaled_video = nullptr;
+	}
+	return video;
+}
 
 bool ndi_output_start(void *data)
 {
@@ -145,7 +489,7 @@ bool ndi_output_start(void *data)
 	}
 
 	uint32_t flags = 0;
-	video_t *video = obs_output_video(o->output);
+	video_t *video = ndi_output_release_scaled_video(o);
 	audio_t *audio = obs_output_audio(o->output);
 	obs_output_set_last_error(o->output, "");
 
@@ -157,48 +501,112 @@ bool ndi_output_start(void *data)
 	}
 
 	if (o->uses_video && video) {
+		if (video == obs_get_video() && ndi_output_uses_converter(o)) {
+			video = ndi_output_start_scaled_video(o, video);
+			if (!video) {
+				obs_log(LOG_ERROR, "ERR-433 - NDI Output cannot start: scaled video failed. ('%s')",
+					name);
+				obs_log(LOG_DEBUG, "-ndi_output_start(name='%s', groups='%s', ...)", name, groups);
+				return false;
+			}
+		}
+
 		video_format format = video_output_get_format(video);
 		uint32_t width = video_output_get_width(video);
 		uint32_t height = video_output_get_height(video);
 
+		// Size of one send buffer, laid out as NDI expects (planes back to back, strides derived from Y)
+		size_t send_buffer_size = 0;
 		switch (format) {
-		case VIDEO_FORMAT_I444:
-			o->conv_function = convert_i444_to_uyvy;
+		case VIDEO_FORMAT_I444: {
+			const char *conv_impl;
+			o->conv_function = ndi_select_i444_to_uyvy(&conv_impl);
+			obs_log(LOG_INFO, "NDI Output '%s': converting I444 to UYVY (%s)", name, conv_impl);
 			o->frame_fourcc = NDIlib_FourCC_video_type_UYVY;
-			o->conv_linesize = width * 2;
-			o->conv_buffer = new uint8_t[(size_t)height * (size_t)o->conv_linesize * 2]();
+			o->send_linesize = width * 2;
+			send_buffer_size = (size_t)height * o->send_linesize;
 			break;
+		}
+
+		case VIDEO_FORMAT_P010:
+		case VIDEO_FORMAT_I010:
+		case VIDEO_FORMAT_P216:
+		case VIDEO_FORMAT_P416: {
+			// High bit depth: 16-bit Y plane followed by a full height interleaved UV plane
+			const char *conv_impl;
+			o->conv_function = ndi_select_to_p216(format, &conv_impl);
+			obs_log(LOG_INFO, "NDI Output '%s': converting %s to P216 (%s)", name,
+				get_video_format_name(format), conv_impl);
+			o->frame_fourcc = NDIlib_FourCC_video_type_P216;
+			o->send_linesize = width * 2;
+			send_buffer_size = (size_t)height * o->send_linesize * 2;
+			break;
+		}
 
 		case VIDEO_FORMAT_NV12:
 			o->frame_fourcc = NDIlib_FourCC_video_type_NV12;
+			o->send_linesize = width;
+			send_buffer_size = (size_t)height * o->send_linesize * 3 / 2;
 			break;
 
 		case VIDEO_FORMAT_I420:
 			o->frame_fourcc = NDIlib_FourCC_video_type_I420;
+			o->send_linesize = width;
+			send_buffer_size = (size_t)height * o->send_linesize * 3 / 2;
 			break;
 
 		case VIDEO_FORMAT_RGBA:
 			o->frame_fourcc = NDIlib_FourCC_video_type_RGBA;
+			o->send_linesize = width * 4;
+			send_buffer_size = (size_t)height * o->send_linesize;
 			break;
 
 		case VIDEO_FORMAT_BGRA:
 			o->frame_fourcc = NDIlib_FourCC_video_type_BGRA;
+			o->send_linesize = width * 4;
+			send_buffer_size = (size_t)height * o->send_linesize;
 			break;
 
 		case VIDEO_FORMAT_BGRX:
 			o->frame_fourcc = NDIlib_FourCC_video_type_BGRX;
+			o->send_linesize = width * 4;
+			send_buffer_size = (size_t)height * o->send_linesize;
 			break;
 
 		default:
 			obs_log(LOG_ERROR, "ERR-410 - NDI Output cannot start : Unsupported pixel format %d. ('%s')",
 				format, name);
 			obs_log(LOG_DEBUG, "-ndi_output_start(name='%s', groups='%s', ...)", name, groups);
-			auto error_string = obs_module_text("NDIPlugin.OutputSettings.LastError") +
-					    video_to_color_format_map.at(format);
+			auto error_string = std::string(obs_module_text("NDIPlugin.OutputSettings.LastError")) +
+					    get_video_format_name(format);
 			obs_output_set_last_error(o->output, error_string.c_str());
+			if (o->scaled_video)
+				ndi_output_stop_scaled_video(o);
 			return false;
 		}
 
+		obs_log(LOG_DEBUG, "'%s' ndi_output_start: allocating %d x %zu bytes send buffers", name,
+			NDI_OUTPUT_SEND_BUFFERS, send_buffer_size);
+		for (auto &buffer : o->send_buffers) {
+			ndi_buffer_pool_free(buffer, o->send_buffer_size); // left over from a start that failed
+			buffer = nullptr;
+		}
+		for (auto &buffer : o->send_buffers) {
+			// All the same class, so the same capacity
+			buffer = ndi_buffer_pool_alloc(send_buffer_size, &o->send_buffer_size);
+			if (!buffer) {
+				obs_log(LOG_ERROR,
+					"ERR-435 - NDI Output cannot start: send buffers allocation failed. ('%s')",
+					name);
+				obs_log(LOG_DEBUG, "-ndi_output_start(name='%s', groups='%s', ...)", name, groups);
+				obs_output_set_last_error(o->output,
+							  obs_module_text("NDIPlugin.OutputSettings.LastError.Memory"));
+				if (o->scaled_video)
+					ndi_output_stop_scaled_video(o);
+				return false;
+			}
+		}
+
 		o->frame_width = width;
 		o->frame_height = height;
 
@@ -206,6 +614,9 @@ bool ndi_output_start(void *data)
 		const struct video_output_info *voi = video_output_get_info(video);
 		o->video_framerate_num = voi->fps_num;
 		o->video_framerate_den = voi->fps_den;
+		o->pace_video = video != obs_get_video();
+		o->video_frame_interval_ns = video_output_get_frame_time(video);
+		o->video_pacer = {};
 
 		flags |= OBS_OUTPUT_VIDEO;
 	}
@@ -213,6 +624,13 @@ bool ndi_output_start(void *data)
 	if (o->uses_audio && audio) {
 		o->audio_samplerate = audio_output_get_sample_rate(audio);
 		o->audio_channels = audio_output_get_channels(audio);
+
+		// OBS delivers output audio in AUDIO_OUTPUT_FRAMES ticks, size the gather buffer for that once
+		size_t audio_buffer_size = ndi_audio_fltp_buffer_size((uint32_t)o->audio_channels, AUDIO_OUTPUT_FRAMES);
+		if (audio_buffer_size > o->audio_conv_buffer_size) {
+			ndi_buffer_pool_free(o->audio_conv_buffer, o->audio_conv_buffer_size);
+			o->audio_conv_buffer = ndi_buffer_pool_alloc(audio_buffer_size, &o->audio_conv_buffer_size);
+		}
 		flags |= OBS_OUTPUT_AUDIO;
 	}
 
@@ -222,13 +640,23 @@ bool ndi_output_start(void *data)
 		send_desc.p_groups = groups;
 	else
 		send_desc.p_groups = nullptr;
-	send_desc.clock_video = false;
-	send_desc.clock_audio = false;
+	send_desc.clock_video = o->clock_video;
+	send_desc.clock_audio = o->clock_audio;
 
+	pthread_mutex_lock(&o->sender_mutex);
 	o->ndi_sender = ndiLib->send_create(&send_desc);
+	pthread_mutex_unlock(&o->sender_mutex);
 	if (o->ndi_sender) {
+		ndi_output_reset_stats(o);
+		if (flags & OBS_OUTPUT_VIDEO)
+			ndi_output_start_send_thread(o);
 		o->started = obs_output_begin_data_capture(o->output, flags);
 		if (o->started) {
+			obs_log(LOG_INFO, "NDI Output '%s': clock_video=%s, clock_audio=%s, drop_frames=%s", name,
+				o->clock_video ? "true" : "false", o->clock_audio ? "true" : "false",
+				o->drop_frames ? "true" : "false");
+			if (o->scaled_video)
+				obs_add_main_rendered_callback(ndi_output_render_scaled, o);
 			obs_log(LOG_DEBUG, "'%s' ndi_output_start: ndi output started", name);
 		} else {
 			obs_log(LOG_WARNING, "WARN-415 - NDI Sender data capture failed. '%s'", name);
@@ -239,6 +667,12 @@ bool ndi_output_start(void *data)
 		obs_log(LOG_DEBUG, "'%s' ndi_output_start: ndi sender init failed", name);
 	}
 
+	if (!o->started) {
+		ndi_output_stop_send_thread(o);
+		if (o->scaled_video)
+			ndi_output_stop_scaled_video(o);
+	}
+
 	obs_log(LOG_DEBUG, "-ndi_output_start(name='%s', groups='%s'...)", name, groups);
 
 	return o->started;
@@ -255,6 +689,15 @@ void ndi_output_update(void *data, obs_data_t *settings)
 	o->ndi_groups = groups;
 	o->uses_video = obs_data_get_bool(settings, "uses_video");
 	o->uses_audio = obs_data_get_bool(settings, "uses_audio");
+	o->always_send = obs_data_get_bool(settings, "always_send");
+	// The sender is created on start
+	o->clock_video = obs_data_get_bool(settings, "clock_video");
+	o->clock_audio = obs_data_get_bool(settings, "clock_audio");
+	o->drop_frames = obs_data_get_bool(settings, "drop_frames");
+
+	// The render callback reads the converter, so changes apply on the next start
+	if (!o->started)
+		ndi_converter_update(&o->converter, settings);
 
 	obs_log(LOG_INFO, "NDI Output Updated. '%s'", name);
 	obs_log(LOG_DEBUG, "ndi_output_update(name='%s', groups='%s', uses_video='%s', uses_audio='%s')", name, groups,
@@ -270,20 +713,38 @@ void ndi_output_stop(void *data, uint64_t)
 	if (o->started) {
 		o->started = false;
 
+		if (o->scaled_video)
+			ndi_output_stop_scaled_video(o);
+
 		obs_output_end_data_capture(o->output);
+		ndi_output_stop_send_thread(o);
+
+		auto &stats = o->stats;
+		obs_log(LOG_INFO,
+			"NDI Output '%s' sent %lld video frames (%lld skipped, %.2f ms average send, %.2f ms max, "
+			"%.1f ms waited) and %lld audio frames (%.2f ms average send)",
+			name, (long long)stats.video_frames.load(), (long long)stats.video_skipped.load(),
+			ndi_output_stats_average_ms(stats.video_send_ns, stats.video_frames),
+			(double)stats.video_send_max_ns / 1000000.0, (double)stats.video_wait_ns / 1000000.0,
+			(long long)stats.audio_frames.load(),
+			ndi_output_stats_average_ms(stats.audio_send_ns, stats.audio_frames));
 
 		if (o->ndi_sender) {
 			obs_log(LOG_DEBUG, "ndi_output_stop: +ndiLib->send_destroy(o->ndi_sender)");
+			pthread_mutex_lock(&o->sender_mutex);
 			ndiLib->send_destroy(o->ndi_sender);
-			obs_log(LOG_DEBUG, "ndi_output_stop: -ndiLib->send_destroy(o->ndi_sender)");
 			o->ndi_sender = nullptr;
+			pthread_mutex_unlock(&o->sender_mutex);
+			obs_log(LOG_DEBUG, "ndi_output_stop: -ndiLib->send_destroy(o->ndi_sender)");
 		}
 
-		if (o->conv_buffer) {
-			delete[] o->conv_buffer;
-			o->conv_buffer = nullptr;
-			o->conv_function = nullptr;
+		// The sender is destroyed, so NDI no longer reads the last async frame
+		for (auto &buffer : o->send_buffers) {
+			ndi_buffer_pool_free(buffer, o->send_buffer_size);
+			buffer = nullptr;
 		}
+		o->send_buffer_size = 0;
+		o->conv_function = nullptr;
 
 		o->frame_width = 0;
 		o->frame_height = 0;
@@ -291,6 +752,7 @@ void ndi_output_stop(void *data, uint64_t)
 		o->video_framerate_den = 0;
 		o->audio_channels = 0;
 		o->audio_samplerate = 0;
+		o->video_suspended = false;
 
 		obs_log(LOG_INFO, "NDI Output Stopped. '%s'", name);
 	}
@@ -307,9 +769,17 @@ void ndi_output_destroy(void *data)
 
 	if (o->audio_conv_buffer) {
 		obs_log(LOG_DEBUG, "ndi_output_destroy: freeing %zu bytes", o->audio_conv_buffer_size);
-		bfree(o->audio_conv_buffer);
+		ndi_buffer_pool_free(o->audio_conv_buffer, o->audio_conv_buffer_size);
 		o->audio_conv_buffer = nullptr;
 	}
+	for (auto &buffer : o->send_buffers) {
+		ndi_buffer_pool_free(buffer, o->send_buffer_size);
+		buffer = nullptr;
+	}
+	ndi_output_release_scaled_video(o);
+	ndi_converter_destroy(&o->converter);
+	pthread_mutex_destroy(&o->send_mutex);
+	pthread_mutex_destroy(&o->sender_mutex);
 	obs_log(LOG_DEBUG, "-ndi_output_destroy(name='%s', groups='%s', ...)", name, groups);
 	bfree(o);
 }
@@ -320,28 +790,86 @@ void ndi_output_rawvideo(void *data, video_data *frame)
 	if (!o->started || !o->frame_width || !o->frame_height)
 		return;
 
+	NDI_TRACE_ZONE("ndi_output_rawvideo");
+
+	// Scaled frames are already skipped by ndi_output_render_scaled
+	if (!o->scaled_video && !ndi_output_update_suspended(o))
+		return;
+
+	if (o->pace_video)
+		ndi_frame_pacer_wait(&o->video_pacer, frame->timestamp, o->video_frame_interval_ns);
+
 	uint32_t width = o->frame_width;
 	uint32_t height = o->frame_height;
 
-	NDIlib_video_frame_v2_t video_frame = {0};
-	video_frame.xres = width;
-	video_frame.yres = height;
-	video_frame.frame_rate_N = o->video_framerate_num;
-	video_frame.frame_rate_D = o->video_framerate_den;
-	video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
-	video_frame.timecode = NDIlib_send_timecode_synthesize;
-	video_frame.FourCC = o->frame_fourcc;
+	// Only one frame waits for the send thread: a newer one is skipped (nothing converted) or waits for the
+	// send thread to take the pending one
+	pthread_mutex_lock(&o->send_mutex);
+	if (o->send_pending >= 0) {
+		if (o->drop_frames) {
+			pthread_mutex_unlock(&o->send_mutex);
+			o->stats.video_skipped++;
+			return;
+		}
+		uint64_t wait_start_ns = os_gettime_ns();
+		while (o->send_pending >= 0) {
+			pthread_mutex_unlock(&o->send_mutex);
+			os_event_wait(o->send_free_event);
+			pthread_mutex_lock(&o->send_mutex);
+		}
+		o->stats.video_wait_ns += os_gettime_ns() - wait_start_ns;
+	}
+	// Any buffer neither sent nor still read by NDI
+	int index = 0;
+	while (index == o->send_active || index == o->send_in_flight)
+		index++;
+	pthread_mutex_unlock(&o->send_mutex);
+
+	uint8_t *send_buffer = o->send_buffers[index];
+	uint32_t stride = o->send_linesize;
+
+	switch (o->frame_fourcc) {
+	case NDIlib_FourCC_type_UYVY: {
+		// Striped across the worker pool; returns once the whole frame is converted
+		uint8_t *planes[] = {send_buffer};
+		uint32_t strides[] = {stride};
+		ndi_stripe_pool_convert(o->conv_function, frame->data, frame->linesize, height, planes, strides);
+		break;
+	}
 
-	if (video_frame.FourCC == NDIlib_FourCC_type_UYVY) {
-		o->conv_function(frame->data, frame->linesize, 0, height, o->conv_buffer, o->conv_linesize);
-		video_frame.p_data = o->conv_buffer;
-		video_frame.line_stride_in_bytes = o->conv_linesize;
-	} else {
-		video_frame.p_data = frame->data[0];
-		video_frame.line_stride_in_bytes = frame->linesize[0];
+	case NDIlib_FourCC_type_P216: {
+		uint8_t *planes[] = {send_buffer, send_buffer + (size_t)stride * height};
+		uint32_t strides[] = {stride, stride};
+		ndi_stripe_pool_convert(o->conv_function, frame->data, frame->linesize, height, planes, strides);
+		break;
+	}
+
+	case NDIlib_FourCC_type_NV12:
+		ndi_readback_copy_plane(send_buffer, stride, frame->data[0], frame->linesize[0], width, height);
+		ndi_readback_copy_plane(send_buffer + (size_t)stride * height, stride, frame->data[1],
+					frame->linesize[1], width, height / 2);
+		break;
+
+	case NDIlib_FourCC_type_I420: {
+		uint8_t *u_plane = send_buffer + (size_t)stride * height;
+		uint8_t *v_plane = u_plane + (size_t)(stride / 2) * (height / 2);
+		ndi_readback_copy_plane(send_buffer, stride, frame->data[0], frame->linesize[0], width, height);
+		ndi_readback_copy_plane(u_plane, stride / 2, frame->data[1], frame->linesize[1], width / 2,
+					height / 2);
+		ndi_readback_copy_plane(v_plane, stride / 2, frame->data[2], frame->linesize[2], width / 2,
+					height / 2);
+		break;
 	}
 
-	ndiLib->send_send_video_async_v2(o->ndi_sender, &video_frame);
+	default:
+		ndi_readback_copy_plane(send_buffer, stride, frame->data[0], frame->linesize[0], width * 4, height);
+		break;
+	}
+
+	pthread_mutex_lock(&o->send_mutex);
+	o->send_pending = index;
+	pthread_mutex_unlock(&o->send_mutex);
+	os_event_signal(o->send_event);
 }
 
 void ndi_output_rawaudio(void *data, audio_data *frame)
@@ -352,37 +880,20 @@ void ndi_output_rawaudio(void *data, audio_data *frame)
 	if (!o->started || !o->audio_samplerate || !o->audio_channels)
 		return;
 
+	if (!ndi_output_has_receivers(o))
+		return;
+
 	NDIlib_audio_frame_v3_t audio_frame = {0};
 	audio_frame.sample_rate = o->audio_samplerate;
 	audio_frame.no_channels = (int)o->audio_channels;
 	audio_frame.timecode = NDIlib_send_timecode_synthesize;
 	audio_frame.no_samples = frame->frames;
-	audio_frame.channel_stride_in_bytes = frame->frames * 4;
-	audio_frame.FourCC = NDIlib_FourCC_audio_type_FLTP;
-
-	const size_t data_size = audio_frame.no_channels * audio_frame.channel_stride_in_bytes;
-
-	if (data_size > o->audio_conv_buffer_size) {
-		obs_log(LOG_DEBUG, "ndi_output_rawaudio('%s'): growing audio_conv_buffer from %zu to %zu bytes",
-			o->ndi_name, o->audio_conv_buffer_size, data_size);
-		if (o->audio_conv_buffer) {
-			obs_log(LOG_DEBUG, "ndi_output_rawaudio('%s'): freeing %zu bytes", o->ndi_name,
-				o->audio_conv_buffer_size);
-			bfree(o->audio_conv_buffer);
-		}
-		obs_log(LOG_DEBUG, "ndi_output_rawaudio('%s'): allocating %zu bytes", o->ndi_name, data_size);
-		o->audio_conv_buffer = (uint8_t *)bmalloc(data_size);
-		o->audio_conv_buffer_size = data_size;
-	}
-
-	for (int i = 0; i < audio_frame.no_channels; ++i) {
-		memcpy(o->audio_conv_buffer + (i * audio_frame.channel_stride_in_bytes), frame->data[i],
-		       audio_frame.channel_stride_in_bytes);
-	}
-
-	audio_frame.p_data = o->audio_conv_buffer;
+	ndi_audio_set_fltp(&audio_frame, frame->data, &o->audio_conv_buffer, &o->audio_conv_buffer_size);
 
+	uint64_t start_ns = os_gettime_ns();
 	ndiLib->send_send_audio_v3(o->ndi_sender, &audio_frame);
+	o->stats.audio_frames++;
+	o->stats.audio_send_ns += os_gettime_ns() - start_ns;
 }
 
 obs_output_info create_ndi_output_info()
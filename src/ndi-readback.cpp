@@ -0,0 +1,134 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-readback.h"
+#include "ndi-trace.h"
+
+#include <cstring>
+
+void ndi_readback_init(ndi_readback_t *readback)
+{
+	memset(readback, 0, sizeof(ndi_readback_t));
+	readback->mapped_index = -1;
+}
+
+void ndi_readback_destroy(ndi_readback_t *readback)
+{
+	ndi_readback_unmap(readback);
+	for (auto &surface : readback->surfaces) {
+		gs_stagesurface_destroy(surface);
+		surface = nullptr;
+	}
+	readback->count = 0;
+	readback->write_index = 0;
+	readback->staged = 0;
+}
+
+bool ndi_readback_configure(ndi_readback_t *readback, uint32_t width, uint32_t height, enum gs_color_format format,
+			    uint32_t count)
+{
+	if (count < 1)
+		count = 1;
+	if (count > NDI_READBACK_MAX_SURFACES)
+		count = NDI_READBACK_MAX_SURFACES;
+
+	if (readback->count == count && readback->width == width && readback->height == height &&
+	    readback->format == format)
+		return true;
+
+	ndi_readback_destroy(readback);
+
+	readback->width = width;
+	readback->height = height;
+	readback->format = format;
+	for (uint32_t i = 0; i < count; ++i) {
+		readback->surfaces[i] = gs_stagesurface_create(width, height, format);
+		if (!readback->surfaces[i]) {
+			ndi_readback_destroy(readback);
+			return false;
+		}
+	}
+	readback->count = count;
+
+	return true;
+}
+
+void ndi_readback_stage(ndi_readback_t *readback, gs_texture_t *texture, uint64_t timestamp)
+{
+	NDI_TRACE_ZONE("ndi_readback_stage");
+	if (!readback->count || !texture)
+		return;
+
+	ndi_readback_unmap(readback);
+
+	gs_stage_texture(readback->surfaces[readback->write_index], texture);
+	readback->timestamps[readback->write_index] = timestamp;
+	readback->write_index = (readback->write_index + 1) % readback->count;
+	if (readback->staged < readback->count)
+		readback->staged++;
+}
+
+bool ndi_readback_map(ndi_readback_t *readback, uint8_t **data, uint32_t *linesize, uint64_t *timestamp)
+{
+	NDI_TRACE_ZONE("ndi_readback_map");
+	// After staging, write_index points at the oldest staged surface (the next one to be overwritten).
+	if (!readback->count || readback->staged < readback->count)
+		return false;
+
+	uint32_t index = readback->write_index;
+	if (!gs_stagesurface_map(readback->surfaces[index], data, linesize))
+		return false;
+
+	readback->mapped_index = (int)index;
+	if (timestamp)
+		*timestamp = readback->timestamps[index];
+
+	return true;
+}
+
+void ndi_readback_reset(ndi_readback_t *readback)
+{
+	ndi_readback_unmap(readback);
+	readback->write_index = 0;
+	readback->staged = 0;
+}
+
+void ndi_readback_copy_plane(uint8_t *dst, uint32_t dst_linesize, const uint8_t *src, uint32_t src_linesize,
+			     uint32_t row_bytes, uint32_t height)
+{
+	if (!height)
+		return;
+
+	if (dst_linesize == src_linesize) {
+		// Padding included: the rows are contiguous in both buffers
+		memcpy(dst, src, (size_t)src_linesize * (height - 1) + row_bytes);
+		return;
+	}
+
+	for (uint32_t i = 0; i < height; ++i) {
+		memcpy(dst + (size_t)dst_linesize * i, src + (size_t)src_linesize * i, row_bytes);
+	}
+}
+
+void ndi_readback_unmap(ndi_readback_t *readback)
+{
+	if (readback->mapped_index < 0)
+		return;
+
+	gs_stagesurface_unmap(readback->surfaces[readback->mapped_index]);
+	readback->mapped_index = -1;
+}
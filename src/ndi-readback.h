@@ -0,0 +1,112 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <obs-module.h>
+
+/**
+ * Asynchronous GPU readback through a ring of stage surfaces.
+ * A frame staged now is mapped (count - 1) frames later, once the GPU has finished the copy, so
+ * gs_stagesurface_map does not have to flush and wait for the render pipeline.
+ * A ring of 1 surface maps the frame it just staged (synchronous, no extra latency, stalls rendering).
+ * All functions must be called from the graphics thread (or within obs_enter_graphics).
+ */
+
+#define NDI_READBACK_MAX_SURFACES 3
+
+typedef struct {
+	gs_stagesurf_t *surfaces[NDI_READBACK_MAX_SURFACES];
+	uint64_t timestamps[NDI_READBACK_MAX_SURFACES];
+	uint32_t count;
+	uint32_t write_index;
+	uint32_t staged;
+	int mapped_index;
+
+	uint32_t width;
+	uint32_t height;
+	enum gs_color_format format;
+} ndi_readback_t;
+
+/**
+ * Initialize an empty readback ring. Does not need the graphics context.
+ * @param readback Pointer to readback structure to initialize
+ */
+void ndi_readback_init(ndi_readback_t *readback);
+
+/**
+ * (Re)create the stage surfaces if the size, format or ring length changed.
+ * Frames staged with the previous configuration are dropped.
+ * @param readback The readback instance
+ * @param width Stage surface width
+ * @param height Stage surface height
+ * @param format Stage surface format
+ * @param count Number of stage surfaces, 1 to NDI_READBACK_MAX_SURFACES
+ * @return true if the stage surfaces are ready
+ */
+bool ndi_readback_configure(ndi_readback_t *readback, uint32_t width, uint32_t height, enum gs_color_format format,
+			    uint32_t count);
+
+/**
+ * Queue a GPU copy of a texture into the next stage surface of the ring.
+ * @param readback The readback instance
+ * @param texture Texture of the configured size and format
+ * @param timestamp Timestamp of the rendered frame, handed back by ndi_readback_map
+ */
+void ndi_readback_stage(ndi_readback_t *readback, gs_texture_t *texture, uint64_t timestamp);
+
+/**
+ * Map the oldest staged frame, once the ring has filled up.
+ * Must be followed by ndi_readback_unmap before the next ndi_readback_stage.
+ * @param readback The readback instance
+ * @param data Output pointer to the mapped pixels
+ * @param linesize Output line size of the mapped pixels
+ * @param timestamp Output timestamp given when the frame was staged (may be NULL)
+ * @return true if a frame is mapped
+ */
+bool ndi_readback_map(ndi_readback_t *readback, uint8_t **data, uint32_t *linesize, uint64_t *timestamp);
+
+/**
+ * Drop the staged frames, e.g. after rendering was paused, so the next map waits for fresh ones.
+ * Keeps the stage surfaces.
+ * @param readback The readback instance
+ */
+void ndi_readback_reset(ndi_readback_t *readback);
+
+/**
+ * Unmap the frame mapped by ndi_readback_map.
+ * @param readback The readback instance
+ */
+void ndi_readback_unmap(ndi_readback_t *readback);
+
+/**
+ * Copy a mapped plane into another buffer, in a single memcpy when both pitches match.
+ * @param dst Destination pixels
+ * @param dst_linesize Destination line size
+ * @param src Source pixels (typically from ndi_readback_map)
+ * @param src_linesize Source line size
+ * @param row_bytes Bytes to copy per row
+ * @param height Number of rows
+ */
+void ndi_readback_copy_plane(uint8_t *dst, uint32_t dst_linesize, const uint8_t *src, uint32_t src_linesize,
+			     uint32_t row_bytes, uint32_t height);
+
+/**
+ * Destroy the stage surfaces.
+ * @param readback The readback instance
+ */
+void ndi_readback_destroy(ndi_readback_t *readback);
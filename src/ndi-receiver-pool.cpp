@@ -0,0 +1,204 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-receiver-pool.h"
+
+#include "plugin-main.h"
+
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// How long a worker waits after a pass over its receivers found nothing to do; add, remove and stop wake it early
+#define NDI_RECEIVER_POOL_IDLE_WAIT_MS 2
+// A new worker is started for every this many pooled receivers, up to one per logical core
+#define NDI_RECEIVER_POOL_RECEIVERS_PER_WORKER 8
+
+typedef struct {
+	void *data;
+	ndi_receiver_pool_step_t step;
+} pool_receiver_t;
+
+typedef struct {
+	pthread_t thread;
+	std::atomic<bool> running;
+	os_event_t *wake_event;
+	// Guards receivers and stepping; not held while a step runs
+	pthread_mutex_t mutex;
+	// Signalled each time a step returns, so removal can wait for the one in flight
+	pthread_cond_t step_done;
+	void *stepping;
+	std::vector<pool_receiver_t> receivers;
+} pool_worker_t;
+
+static struct {
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	std::vector<pool_worker_t *> workers;
+	// Atomic: a worker drops failed receivers under its own mutex, which must not take pool.mutex
+	std::atomic<size_t> receiver_count{0};
+} pool;
+
+static void *pool_worker_thread(void *data)
+{
+	auto worker = (pool_worker_t *)data;
+	os_set_thread_name("distroav-ndi-receiver-pool");
+
+	while (worker->running) {
+		bool did_work = false;
+
+		pthread_mutex_lock(&worker->mutex);
+		size_t i = 0;
+		while (worker->running && i < worker->receivers.size()) {
+			pool_receiver_t receiver = worker->receivers[i];
+			worker->stepping = receiver.data;
+			pthread_mutex_unlock(&worker->mutex);
+
+			auto result = receiver.step(receiver.data);
+
+			pthread_mutex_lock(&worker->mutex);
+			worker->stepping = nullptr;
+			pthread_cond_broadcast(&worker->step_done);
+
+			// The list may have changed while the lock was released
+			auto &receivers = worker->receivers;
+			void *stepped = receiver.data;
+			auto it = std::find_if(receivers.begin(), receivers.end(),
+					       [stepped](const pool_receiver_t &r) { return r.data == stepped; });
+			if (it == receivers.end())
+				continue; // removed meanwhile, i already points at the next one
+			i = (size_t)(it - receivers.begin());
+			if (result == NDI_RECEIVER_POOL_STEP_FAILED) {
+				receivers.erase(it);
+				pool.receiver_count--;
+				continue;
+			}
+			did_work |= (result == NDI_RECEIVER_POOL_STEP_WORK);
+			i++;
+		}
+		const bool idle = worker->receivers.empty();
+		pthread_mutex_unlock(&worker->mutex);
+
+		if (idle)
+			os_event_wait(worker->wake_event);
+		else if (!did_work)
+			os_event_timedwait(worker->wake_event, NDI_RECEIVER_POOL_IDLE_WAIT_MS);
+	}
+
+	return nullptr;
+}
+
+static pool_worker_t *pool_worker_start()
+{
+	auto worker = new pool_worker_t();
+	worker->running = true;
+	os_event_init(&worker->wake_event, OS_EVENT_TYPE_AUTO);
+	pthread_mutex_init(&worker->mutex, nullptr);
+	pthread_cond_init(&worker->step_done, nullptr);
+	pthread_create(&worker->thread, nullptr, pool_worker_thread, worker);
+	pool.workers.push_back(worker);
+	obs_log(LOG_DEBUG, "ndi_receiver_pool: started worker %zu", pool.workers.size());
+	return worker;
+}
+
+static void pool_worker_stop(pool_worker_t *worker)
+{
+	worker->running = false;
+	os_event_signal(worker->wake_event);
+	pthread_join(worker->thread, nullptr);
+	pthread_cond_destroy(&worker->step_done);
+	pthread_mutex_destroy(&worker->mutex);
+	os_event_destroy(worker->wake_event);
+	delete worker;
+}
+
+void ndi_receiver_pool_add(void *data, ndi_receiver_pool_step_t step)
+{
+	pthread_mutex_lock(&pool.mutex);
+
+	const size_t max_workers = (size_t)std::max(1, os_get_logical_cores());
+	const size_t per_worker = NDI_RECEIVER_POOL_RECEIVERS_PER_WORKER;
+	const size_t receiver_count = ++pool.receiver_count;
+	const size_t wanted_workers = std::min(max_workers, (receiver_count + per_worker - 1) / per_worker);
+
+	pool_worker_t *target = nullptr;
+	if (pool.workers.size() < wanted_workers) {
+		target = pool_worker_start();
+	} else {
+		size_t least_count = SIZE_MAX;
+		for (auto worker : pool.workers) {
+			pthread_mutex_lock(&worker->mutex);
+			size_t count = worker->receivers.size();
+			pthread_mutex_unlock(&worker->mutex);
+			if (count < least_count) {
+				least_count = count;
+				target = worker;
+			}
+		}
+	}
+
+	pthread_mutex_lock(&target->mutex);
+	target->receivers.push_back({data, step});
+	pthread_mutex_unlock(&target->mutex);
+	os_event_signal(target->wake_event);
+	pthread_mutex_unlock(&pool.mutex);
+}
+
+void ndi_receiver_pool_remove(void *data)
+{
+	pthread_mutex_lock(&pool.mutex);
+	for (auto it = pool.workers.begin(); it != pool.workers.end();) {
+		pool_worker_t *worker = *it;
+		pthread_mutex_lock(&worker->mutex);
+		auto &receivers = worker->receivers;
+		auto size = receivers.size();
+		receivers.erase(std::remove_if(receivers.begin(), receivers.end(),
+					       [data](const pool_receiver_t &r) { return r.data == data; }),
+				receivers.end());
+		pool.receiver_count -= size - receivers.size();
+		while (worker->stepping == data)
+			pthread_cond_wait(&worker->step_done, &worker->mutex);
+		const bool empty = receivers.empty();
+		pthread_mutex_unlock(&worker->mutex);
+
+		// The pool shrinks with its receivers, an empty worker is not kept around
+		if (empty) {
+			it = pool.workers.erase(it);
+			pool_worker_stop(worker);
+			obs_log(LOG_DEBUG, "ndi_receiver_pool: stopped an idle worker, %zu left", pool.workers.size());
+		} else {
+			++it;
+		}
+	}
+	pthread_mutex_unlock(&pool.mutex);
+}
+
+void ndi_receiver_pool_shutdown()
+{
+	pthread_mutex_lock(&pool.mutex);
+	if (!pool.workers.empty()) {
+		for (auto worker : pool.workers)
+			pool_worker_stop(worker);
+		pool.workers.clear();
+		pool.receiver_count = 0;
+		obs_log(LOG_DEBUG, "ndi_receiver_pool: stopped");
+	}
+	pthread_mutex_unlock(&pool.mutex);
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+/**
+ * Shared receiver pool: multiplexes many NDI receivers onto a few worker threads instead of one thread
+ * per source. Workers are started as receivers are added (one per 8 receivers, up to one per logical core)
+ * and stopped once they have none left. Intended for sources that receive little data (e.g. lowest
+ * bandwidth multiview previews) where a dedicated thread would mostly sit idle.
+ */
+
+// Result of one non-blocking step of a pooled receiver
+enum ndi_receiver_pool_step_result {
+	NDI_RECEIVER_POOL_STEP_IDLE = 0, // Nothing was received
+	NDI_RECEIVER_POOL_STEP_WORK,     // At least one frame was processed
+	NDI_RECEIVER_POOL_STEP_FAILED    // The receiver is unusable; the pool stops stepping it
+};
+
+typedef ndi_receiver_pool_step_result (*ndi_receiver_pool_step_t)(void *data);
+
+/**
+ * Add a receiver to the pool, starting a worker thread when the existing ones are full.
+ * @param data Opaque receiver context passed to step
+ * @param step Non-blocking step function, called repeatedly from a pool worker
+ */
+void ndi_receiver_pool_add(void *data, ndi_receiver_pool_step_t step);
+
+/**
+ * Remove a receiver from the pool, stopping its worker if it has no receivers left.
+ * On return, step is not running and will not be called again for data.
+ * @param data Receiver context previously passed to ndi_receiver_pool_add
+ */
+void ndi_receiver_pool_remove(void *data);
+
+/**
+ * Stop all pool worker threads. Called on module unload.
+ */
+void ndi_receiver_pool_shutdown();
@@ -16,37 +16,63 @@
 ******************************************************************************/
 
 #include "plugin-main.h"
+#include "ndi-control.h"
 #include "ndi-finder.h"
+#include "ndi-readback.h"
+#include "ndi-receiver-pool.h"
+#include "ndi-trace.h"
 
 #include <util/platform.h>
 #include <util/threading.h>
+#include <graphics/image-file.h>
 
 #include <QDesktopServices>
 #include <QUrl>
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <thread>
 
 #define PROP_SOURCE "ndi_source_name"
 #define PROP_BEHAVIOR "ndi_behavior"
 #define PROP_TIMEOUT "ndi_behavior_timeout"
+#define PROP_TIMEOUT_SECONDS "ndi_behavior_timeout_seconds"
+#define PROP_SLATE_IMAGE "ndi_behavior_slate_image"
 #define PROP_BANDWIDTH "ndi_bw_mode"
+#define PROP_BW_AUTO_THRESHOLD "ndi_bw_auto_threshold"
 #define PROP_SYNC "ndi_sync"
 #define PROP_FRAMESYNC "ndi_framesync"
 #define PROP_HW_ACCEL "ndi_recv_hw_accel"
 #define PROP_FIX_ALPHA "ndi_fix_alpha_blending"
+#define PROP_ALPHA_MODE "ndi_alpha_mode"
 #define PROP_YUV_RANGE "yuv_range"
 #define PROP_YUV_COLORSPACE "yuv_colorspace"
 #define PROP_LATENCY "latency"
+#define PROP_LATENCY_PROFILE "ndi_latency_profile"
+// Stored under its original jitter buffer name so existing scenes keep their setting
+#define PROP_OUTPUT_DELAY_FRAMES "ndi_jitter_buffer_frames"
 #define PROP_AUDIO "ndi_audio"
+#define PROP_AUDIO_THREAD "ndi_audio_thread"
+#define PROP_RECV_THREAD "ndi_recv_thread"
+#define PROP_COLOR_FORMAT "ndi_recv_color_format"
 #define PROP_PTZ "ndi_ptz"
 #define PROP_PAN "ndi_pan"
 #define PROP_TILT "ndi_tilt"
 #define PROP_ZOOM "ndi_zoom"
+#define PROP_STATS "ndi_stats"
+#define PROP_STATS_TEXT "ndi_stats_text"
+#define PROP_STATS_REFRESH "ndi_stats_refresh"
 
 #define PROP_BW_UNDEFINED -1
 #define PROP_BW_HIGHEST 0
 #define PROP_BW_LOWEST 1
 #define PROP_BW_AUDIO_ONLY 2
+#define PROP_BW_AUTO 3
+
+// How often the automatic bandwidth mode re-evaluates where the source is rendered
+#define NDI_SOURCE_BW_AUTO_CHECK_NS 500000000ULL
 
 #define PROP_BEHAVIOR_KEEP_ACTIVE 0
 #define PROP_BEHAVIOR_STOP_RESUME_BLANK 1
@@ -54,6 +80,7 @@
 
 #define PROP_TIMEOUT_CLEAR_CONTENT 0
 #define PROP_TIMEOUT_KEEP_CONTENT 1
+#define PROP_TIMEOUT_SLATE 2
 
 // sync mode "Internal" got removed 2020/04/28 ccbdf30f4929969fe58ede691b3030d1fc5ef590
 #define PROP_SYNC_INTERNAL 0
@@ -67,64 +94,202 @@
 #define PROP_YUV_SPACE_BT709 2
 #define PROP_YUV_SPACE_BT2100 3
 
+#define PROP_COLOR_FORMAT_AUTO 0
+#define PROP_COLOR_FORMAT_YUV_FASTEST 1
+#define PROP_COLOR_FORMAT_YUV_16BIT 2
+#define PROP_COLOR_FORMAT_BGRA 3
+
+#define PROP_RECV_THREAD_DEDICATED 0
+#define PROP_RECV_THREAD_POOL 1
+#define PROP_RECV_THREAD_POOL_LOWEST 2
+
 #define PROP_LATENCY_UNDEFINED -1
 #define PROP_LATENCY_NORMAL 0
 #define PROP_LATENCY_LOW 1
 #define PROP_LATENCY_LOWEST 2
 
-typedef struct ptz_t {
-	bool enabled;
-	float pan;
-	float tilt;
-	float zoom;
+// Presets for the latency mode, framesync and output delay; "Custom" uses the Latency Mode and Framesync settings
+#define PROP_LATENCY_PROFILE_CUSTOM 0
+#define PROP_LATENCY_PROFILE_LOWEST 1
+#define PROP_LATENCY_PROFILE_SMOOTH 2
+#define PROP_LATENCY_PROFILE_BROADCAST 3
 
-	ptz_t(bool enabled_ = false, float pan_ = 0.0f, float tilt_ = 0.0f, float zoom_ = 0.0f)
-		: enabled(enabled_),
-		  pan(pan_),
-		  tilt(tilt_),
-		  zoom(zoom_)
-	{
-	}
-} ptz_t;
+// Longest output delay of the broadcast profile, in video frames
+#define NDI_SOURCE_OUTPUT_DELAY_MAX_FRAMES 10
+
+#define PROP_ALPHA_MODE_NONE 0
+#define PROP_ALPHA_MODE_PREMULTIPLY 1
+#define PROP_ALPHA_MODE_UNPREMULTIPLY 2
 
 typedef struct ndi_source_config_t {
 	bool reset_ndi_receiver = true;
 	// Initialize value to true to ensure a receiver reset on OBS launch.
 
+	// Only the NDI source name changed: re-point the existing receiver with recv_connect
+	bool reconnect_ndi_receiver = false;
+
+	// Framesync was turned on or off: create or destroy it on the existing receiver
+	bool framesync_changed = false;
+
 	//
 	// Changes that require the NDI receiver to be reset:
 	//
 	char *ndi_receiver_name;
 	char *ndi_source_name;
 	int bandwidth;
+	int bw_auto_threshold;
 	int latency;
-	bool framesync_enabled;
+	int color_format;
 	bool hw_accel_enabled;
+	bool audio_thread_enabled;
 
 	//
 	// Changes that do NOT require the NDI receiver to be reset:
 	//
 	int behavior;
 	int timeout_action;
+	uint64_t timeout_ns;
 	int sync_mode;
 	video_range_type yuv_range;
 	video_colorspace yuv_colorspace;
 	bool audio_enabled;
-	ptz_t ptz;
+	int recv_thread_mode;
+	int latency_profile;
+	bool framesync_enabled;
+	// Broadcast profile: fixed delay, in video frames, added after framesync; 0 when it is off
+	int output_delay_frames;
+	// Direct GPU source: alpha conversion done by the decode pass (PROP_ALPHA_MODE_*)
+	int alpha_mode;
+	// Handed to the control path (ndi-control.h), which sends it to the receiver
 	NDIlib_tally_t tally;
 } ndi_source_config_t;
 
+//
+// Receive telemetry, written by the receive thread(s) and read from the UI/proc handler without locking.
+// Frame and processing counters are cumulative over the source lifetime;
+// dropped and queue counts come from the NDI SDK and are relative to the current receiver.
+//
+typedef struct ndi_source_stats_t {
+	std::atomic<int64_t> video_frames;
+	std::atomic<int64_t> audio_frames;
+	std::atomic<int64_t> video_dropped;
+	std::atomic<int64_t> audio_dropped;
+	std::atomic<int32_t> video_queue;
+	std::atomic<int32_t> audio_queue;
+	std::atomic<uint64_t> video_process_ns;
+	std::atomic<uint64_t> audio_process_ns;
+	// Last NDI send timestamp to OBS output delay; 0 while unknown
+	std::atomic<int64_t> video_latency_ns;
+	std::atomic<int64_t> audio_latency_ns;
+} ndi_source_stats_t;
+
+// Backoff between connection checks while an NDI source is unreachable
+#define NDI_SOURCE_CONNECT_BACKOFF_MIN_NS 100000000ULL
+#define NDI_SOURCE_CONNECT_BACKOFF_MAX_NS 2000000000ULL
+
+// Interval between NDI recv_get_performance/recv_get_queue polls
+#define NDI_SOURCE_STATS_POLL_NS 1000000000ULL
+
+struct ndi_receiver_state_t;
+
+// Texture sets of the direct GPU source: one shown, one mapped for the receive thread to write the next frame
+// into, and one for frames uploaded on the graphics thread when no mapped set was ready
+#define NDI_SOURCE_DIRECT_SLOTS 3
+
+#define NDI_DIRECT_SLOT_IDLE 0
+// Mapped by the graphics thread, waiting for the receive thread
+#define NDI_DIRECT_SLOT_MAPPED 1
+// Being written by the receive thread, outside direct_mutex
+#define NDI_DIRECT_SLOT_WRITING 2
+// Holds a new frame, unmapped and shown by the next video_render
+#define NDI_DIRECT_SLOT_FILLED 3
+
+// One plane of a direct source frame: its texture, and where it is in the NDI frame
+typedef struct ndi_direct_plane_t {
+	uint32_t width;
+	uint32_t height;
+	gs_color_format format;
+	const uint8_t *data;
+	uint32_t linesize;
+	uint32_t row_bytes;
+} ndi_direct_plane_t;
+
+typedef struct ndi_direct_slot_t {
+	int state;
+	// Layout the textures were created for
+	NDIlib_FourCC_video_type_e fourcc;
+	uint32_t width;
+	uint32_t height;
+	// One texture per plane: packed/luma, chroma (P216/PA16/NV12, U of I420), alpha (UYVA/PA16, V of I420)
+	gs_texture_t *textures[3];
+	uint8_t *mapped_data[3];
+	uint32_t mapped_linesize[3];
+} ndi_direct_slot_t;
+
 typedef struct ndi_source_t {
 	obs_source_t *obs_source;
 	ndi_source_config_t config;
 
 	bool running;
+	// true when driven by the shared receiver pool instead of av_thread
+	bool pooled;
 	pthread_t av_thread;
+	ndi_receiver_state_t *receiver_state;
+
+	ndi_source_stats_t stats;
+
+	// Tally and PTZ are sent by the shared control thread, never by the capture loop
+	ndi_control_t *control;
+
+	// Automatic bandwidth: decided on the video tick, applied by the receive thread
+	std::atomic<bool> bw_auto_highest;
+	uint64_t bw_auto_last_check_ns;
+
+	// Optional dedicated audio capture thread, so audio delivery does not wait on video processing.
+	// Only runs against the receiver it was started with; stopped before that receiver is destroyed.
+	bool audio_thread_running;
+	pthread_t audio_thread;
+	NDIlib_recv_instance_t audio_thread_receiver;
+
+	// Signalled on every OBS video tick; paces the framesync capture loop.
+	os_event_t *tick_event;
+	// Wakes a receive thread waiting out its no-connection backoff (settings change or stop).
+	os_event_t *wake_event;
 
 	uint32_t width;
 	uint32_t height;
 
 	uint64_t last_frame_timestamp;
+	// Set once the timeout action ran, so empty polls cost nothing until the next frame arrives.
+	bool timeout_fired;
+
+	// Slate shown by PROP_TIMEOUT_SLATE, decoded once when the setting changes.
+	// The async source outputs slate_frame once; the direct source draws slate_image's texture.
+	pthread_mutex_t slate_mutex;
+	char *slate_image_path;
+	gs_image_file_t slate_image;
+	obs_source_frame slate_frame;
+	std::atomic<bool> slate_active;
+
+	//
+	// Direct GPU rendering ("ndi_source_direct" source type), without the OBS async frame queue:
+	// video_render keeps a texture set mapped in the layout of the last frame, and the receive thread copies the
+	// next NDI frame straight into it and releases it back to NDI. When no mapped set matches (first frame,
+	// format change, or a frame arriving before the previous one was shown), the receive thread parks the frame
+	// in direct_frame without copying it and video_render uploads it.
+	// Slot states are guarded by direct_mutex; the textures are only created, mapped and drawn by the graphics
+	// thread.
+	//
+	bool direct_render;
+	pthread_mutex_t direct_mutex;
+	NDIlib_video_frame_v2_t direct_frame;
+	NDIlib_recv_instance_t direct_frame_receiver;
+	NDIlib_framesync_instance_t direct_frame_sync;
+	bool direct_frame_pending;
+	ndi_direct_slot_t direct_slots[NDI_SOURCE_DIRECT_SLOTS];
+	// Slot drawn by video_render, -1 before the first frame
+	int direct_shown;
+	gs_effect_t *direct_effect;
 } ndi_source_t;
 
 static obs_source_t *find_filter_by_id(obs_source_t *context, const char *id)
@@ -206,6 +371,54 @@ static video_range_type prop_to_range_type(int index)
 	}
 }
 
+static int64_t ndi_timestamp_latency_ns(int64_t ndi_timestamp)
+{
+	// NDI timestamps are UTC, in 100 ns units since the Unix epoch, stamped by the sender.
+	if (ndi_timestamp == NDIlib_recv_timestamp_undefined || ndi_timestamp <= 0)
+		return 0;
+	auto now_100ns = std::chrono::duration_cast<std::chrono::duration<int64_t, std::ratio<1, 10000000>>>(
+				 std::chrono::system_clock::now().time_since_epoch())
+				 .count();
+	return (now_100ns - ndi_timestamp) * 100;
+}
+
+static double stats_average_ms(uint64_t total_ns, int64_t count)
+{
+	return count > 0 ? (double)total_ns / (double)count / 1000000.0 : 0.0;
+}
+
+QString ndi_source_stats_text(ndi_source_t *s)
+{
+	auto &stats = s->stats;
+	return QTStr("NDIPlugin.SourceProps.Stats.Text")
+		.arg(stats.video_frames.load())
+		.arg(stats.video_dropped.load())
+		.arg(stats.video_queue.load())
+		.arg(stats_average_ms(stats.video_process_ns, stats.video_frames), 0, 'f', 2)
+		.arg((double)stats.video_latency_ns / 1000000.0, 0, 'f', 1)
+		.arg(stats.audio_frames.load())
+		.arg(stats.audio_dropped.load())
+		.arg(stats.audio_queue.load())
+		.arg(stats_average_ms(stats.audio_process_ns, stats.audio_frames), 0, 'f', 2)
+		.arg((double)stats.audio_latency_ns / 1000000.0, 0, 'f', 1);
+}
+
+void ndi_source_get_stats_proc(void *data, calldata_t *cd)
+{
+	auto s = (ndi_source_t *)data;
+	auto &stats = s->stats;
+	calldata_set_int(cd, "video_frames", stats.video_frames);
+	calldata_set_int(cd, "video_dropped", stats.video_dropped);
+	calldata_set_int(cd, "video_queue", stats.video_queue);
+	calldata_set_float(cd, "video_process_ms", stats_average_ms(stats.video_process_ns, stats.video_frames));
+	calldata_set_float(cd, "video_latency_ms", (double)stats.video_latency_ns / 1000000.0);
+	calldata_set_int(cd, "audio_frames", stats.audio_frames);
+	calldata_set_int(cd, "audio_dropped", stats.audio_dropped);
+	calldata_set_int(cd, "audio_queue", stats.audio_queue);
+	calldata_set_float(cd, "audio_process_ms", stats_average_ms(stats.audio_process_ns, stats.audio_frames));
+	calldata_set_float(cd, "audio_latency_ms", (double)stats.audio_latency_ns / 1000000.0);
+}
+
 const char *ndi_source_getname(void *)
 {
 	return obs_module_text("NDIPlugin.NDISourceName");
@@ -221,16 +434,8 @@ obs_properties_t *ndi_source_getproperties(void *data)
 	obs_property_t *source_list = obs_properties_add_list(props, PROP_SOURCE,
 							      obs_module_text("NDIPlugin.SourceProps.SourceName"),
 							      OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_FORMAT_STRING);
-	NDIFinder finder;
-	// Create a callback that is called when the NDI source list is complete
-	auto finder_callback = [source_list, s](void *ndi_names) {
-		auto ndi_sources = (std::vector<std::string> *)ndi_names;
-		for (auto &source : *ndi_sources) {
-			obs_property_list_add_string(source_list, source.c_str(), source.c_str());
-		}
-		obs_source_update_properties(s->obs_source);
-	};
-	auto ndi_sources = finder.getNDISourceList(finder_callback);
+	// Served from the finder cache; the properties are refreshed when sources appear or disappear
+	auto ndi_sources = NDIFinder::getNDISourceList();
 	for (auto &source : ndi_sources) {
 		obs_property_list_add_string(source_list, source.c_str(), source.c_str());
 	}
@@ -252,6 +457,27 @@ obs_properties_t *ndi_source_getproperties(void *data)
 				  PROP_TIMEOUT_KEEP_CONTENT);
 	obs_property_list_add_int(timeout_list, obs_module_text("NDIPlugin.SourceProps.Timeout.ClearContent"),
 				  PROP_TIMEOUT_CLEAR_CONTENT);
+	obs_property_list_add_int(timeout_list, obs_module_text("NDIPlugin.SourceProps.Timeout.Slate"),
+				  PROP_TIMEOUT_SLATE);
+	obs_property_set_modified_callback(timeout_list, [](obs_properties_t *props_, obs_property_t *,
+							    obs_data_t *settings_) {
+		auto timeout_action = obs_data_get_int(settings_, PROP_TIMEOUT);
+
+		obs_property_set_visible(obs_properties_get(props_, PROP_TIMEOUT_SECONDS),
+					 timeout_action != PROP_TIMEOUT_KEEP_CONTENT);
+		obs_property_set_visible(obs_properties_get(props_, PROP_SLATE_IMAGE),
+					 timeout_action == PROP_TIMEOUT_SLATE);
+
+		return true;
+	});
+
+	obs_property_t *timeout_seconds =
+		obs_properties_add_int(props, PROP_TIMEOUT_SECONDS,
+				       obs_module_text("NDIPlugin.SourceProps.TimeoutSeconds"), 1, 3600, 1);
+	obs_property_int_set_suffix(timeout_seconds, " s");
+
+	obs_properties_add_path(props, PROP_SLATE_IMAGE, obs_module_text("NDIPlugin.SourceProps.SlateImage"),
+				OBS_PATH_FILE, obs_module_text("NDIPlugin.SourceProps.SlateImage.Filter"), nullptr);
 
 	obs_property_t *bw_modes = obs_properties_add_list(props, PROP_BANDWIDTH,
 							   obs_module_text("NDIPlugin.SourceProps.Bandwidth"),
@@ -259,19 +485,28 @@ obs_properties_t *ndi_source_getproperties(void *data)
 	obs_property_list_add_int(bw_modes, obs_module_text("NDIPlugin.BWMode.Highest"), PROP_BW_HIGHEST);
 	obs_property_list_add_int(bw_modes, obs_module_text("NDIPlugin.BWMode.Lowest"), PROP_BW_LOWEST);
 	obs_property_list_add_int(bw_modes, obs_module_text("NDIPlugin.BWMode.AudioOnly"), PROP_BW_AUDIO_ONLY);
+	obs_property_list_add_int(bw_modes, obs_module_text("NDIPlugin.BWMode.Auto"), PROP_BW_AUTO);
 	obs_property_set_modified_callback(bw_modes, [](obs_properties_t *props_, obs_property_t *,
 							obs_data_t *settings_) {
 		bool is_audio_only = (obs_data_get_int(settings_, PROP_BANDWIDTH) == PROP_BW_AUDIO_ONLY);
+		bool is_auto = (obs_data_get_int(settings_, PROP_BANDWIDTH) == PROP_BW_AUTO);
 
 		obs_property_t *yuv_range = obs_properties_get(props_, PROP_YUV_RANGE);
 		obs_property_t *yuv_colorspace = obs_properties_get(props_, PROP_YUV_COLORSPACE);
+		obs_property_t *bw_auto_threshold = obs_properties_get(props_, PROP_BW_AUTO_THRESHOLD);
 
 		obs_property_set_visible(yuv_range, !is_audio_only);
 		obs_property_set_visible(yuv_colorspace, !is_audio_only);
+		obs_property_set_visible(bw_auto_threshold, is_auto);
 
 		return true;
 	});
 
+	obs_property_t *bw_auto_threshold =
+		obs_properties_add_int(props, PROP_BW_AUTO_THRESHOLD,
+				       obs_module_text("NDIPlugin.SourceProps.BWAutoThreshold"), 0, 8640, 1);
+	obs_property_int_set_suffix(bw_auto_threshold, " px");
+
 	obs_property_t *sync_modes = obs_properties_add_list(props, PROP_SYNC,
 							     obs_module_text("NDIPlugin.SourceProps.Sync"),
 							     OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
@@ -280,11 +515,57 @@ obs_properties_t *ndi_source_getproperties(void *data)
 	obs_property_list_add_int(sync_modes, obs_module_text("NDIPlugin.SyncMode.NDISourceTimecode"),
 				  PROP_SYNC_NDI_SOURCE_TIMECODE);
 
+	obs_property_t *latency_profiles = obs_properties_add_list(
+		props, PROP_LATENCY_PROFILE, obs_module_text("NDIPlugin.SourceProps.LatencyProfile"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(latency_profiles, obs_module_text("NDIPlugin.SourceProps.LatencyProfile.Custom"),
+				  PROP_LATENCY_PROFILE_CUSTOM);
+	obs_property_list_add_int(latency_profiles, obs_module_text("NDIPlugin.SourceProps.LatencyProfile.Lowest"),
+				  PROP_LATENCY_PROFILE_LOWEST);
+	obs_property_list_add_int(latency_profiles, obs_module_text("NDIPlugin.SourceProps.LatencyProfile.Smooth"),
+				  PROP_LATENCY_PROFILE_SMOOTH);
+	obs_property_list_add_int(latency_profiles,
+				  obs_module_text("NDIPlugin.SourceProps.LatencyProfile.Broadcast"),
+				  PROP_LATENCY_PROFILE_BROADCAST);
+	obs_property_set_modified_callback(latency_profiles, [](obs_properties_t *props_, obs_property_t *,
+								obs_data_t *settings_) {
+		auto latency_profile = obs_data_get_int(settings_, PROP_LATENCY_PROFILE);
+
+		obs_property_set_visible(obs_properties_get(props_, PROP_FRAMESYNC),
+					 latency_profile == PROP_LATENCY_PROFILE_CUSTOM);
+		obs_property_set_visible(obs_properties_get(props_, PROP_LATENCY),
+					 latency_profile == PROP_LATENCY_PROFILE_CUSTOM);
+		obs_property_set_visible(obs_properties_get(props_, PROP_OUTPUT_DELAY_FRAMES),
+					 latency_profile == PROP_LATENCY_PROFILE_BROADCAST);
+
+		return true;
+	});
+
+	obs_property_t *output_delay = obs_properties_add_int_slider(
+		props, PROP_OUTPUT_DELAY_FRAMES, obs_module_text("NDIPlugin.SourceProps.OutputDelay"), 1,
+		NDI_SOURCE_OUTPUT_DELAY_MAX_FRAMES, 1);
+	obs_property_int_set_suffix(output_delay, " frames");
+
 	obs_properties_add_bool(props, PROP_FRAMESYNC, obs_module_text("NDIPlugin.NDIFrameSync"));
 
 	obs_properties_add_bool(props, PROP_HW_ACCEL, obs_module_text("NDIPlugin.SourceProps.HWAccel"));
 
-	obs_properties_add_bool(props, PROP_FIX_ALPHA, obs_module_text("NDIPlugin.SourceProps.AlphaBlendingFix"));
+	if (s && s->direct_render) {
+		// Folded into the decode pass, the async source draws its frames through the alpha filter instead
+		obs_property_t *alpha_modes = obs_properties_add_list(
+			props, PROP_ALPHA_MODE, obs_module_text("NDIPlugin.SourceProps.AlphaMode"), OBS_COMBO_TYPE_LIST,
+			OBS_COMBO_FORMAT_INT);
+		obs_property_list_add_int(alpha_modes, obs_module_text("NDIPlugin.SourceProps.AlphaMode.None"),
+					  PROP_ALPHA_MODE_NONE);
+		obs_property_list_add_int(alpha_modes, obs_module_text("NDIPlugin.SourceProps.AlphaMode.Premultiply"),
+					  PROP_ALPHA_MODE_PREMULTIPLY);
+		obs_property_list_add_int(alpha_modes,
+					  obs_module_text("NDIPlugin.SourceProps.AlphaMode.Unpremultiply"),
+					  PROP_ALPHA_MODE_UNPREMULTIPLY);
+	} else {
+		obs_properties_add_bool(props, PROP_FIX_ALPHA,
+					obs_module_text("NDIPlugin.SourceProps.AlphaBlendingFix"));
+	}
 
 	obs_property_t *yuv_ranges = obs_properties_add_list(props, PROP_YUV_RANGE,
 							     obs_module_text("NDIPlugin.SourceProps.ColorRange"),
@@ -301,6 +582,18 @@ obs_properties_t *ndi_source_getproperties(void *data)
 	obs_property_list_add_int(yuv_spaces, "BT.601", PROP_YUV_SPACE_BT601);
 	obs_property_list_add_int(yuv_spaces, "BT.2100", PROP_YUV_SPACE_BT2100);
 
+	obs_property_t *color_formats = obs_properties_add_list(props, PROP_COLOR_FORMAT,
+								obs_module_text("NDIPlugin.SourceProps.ColorFormat"),
+								OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(color_formats, obs_module_text("NDIPlugin.SourceProps.ColorFormat.Auto"),
+				  PROP_COLOR_FORMAT_AUTO);
+	obs_property_list_add_int(color_formats, obs_module_text("NDIPlugin.SourceProps.ColorFormat.YUVFastest"),
+				  PROP_COLOR_FORMAT_YUV_FASTEST);
+	obs_property_list_add_int(color_formats, obs_module_text("NDIPlugin.SourceProps.ColorFormat.YUV16Bit"),
+				  PROP_COLOR_FORMAT_YUV_16BIT);
+	obs_property_list_add_int(color_formats, obs_module_text("NDIPlugin.SourceProps.ColorFormat.BGRA"),
+				  PROP_COLOR_FORMAT_BGRA);
+
 	obs_property_t *latency_modes = obs_properties_add_list(props, PROP_LATENCY,
 								obs_module_text("NDIPlugin.SourceProps.Latency"),
 								OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
@@ -313,6 +606,18 @@ obs_properties_t *ndi_source_getproperties(void *data)
 
 	obs_properties_add_bool(props, PROP_AUDIO, obs_module_text("NDIPlugin.SourceProps.Audio"));
 
+	obs_properties_add_bool(props, PROP_AUDIO_THREAD, obs_module_text("NDIPlugin.SourceProps.AudioThread"));
+
+	obs_property_t *recv_thread_modes = obs_properties_add_list(
+		props, PROP_RECV_THREAD, obs_module_text("NDIPlugin.SourceProps.RecvThread"), OBS_COMBO_TYPE_LIST,
+		OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(recv_thread_modes, obs_module_text("NDIPlugin.SourceProps.RecvThread.Dedicated"),
+				  PROP_RECV_THREAD_DEDICATED);
+	obs_property_list_add_int(recv_thread_modes, obs_module_text("NDIPlugin.SourceProps.RecvThread.PoolLowest"),
+				  PROP_RECV_THREAD_POOL_LOWEST);
+	obs_property_list_add_int(recv_thread_modes, obs_module_text("NDIPlugin.SourceProps.RecvThread.Pool"),
+				  PROP_RECV_THREAD_POOL);
+
 	obs_properties_t *group_ptz = obs_properties_create();
 	obs_properties_add_float_slider(group_ptz, PROP_PAN, obs_module_text("NDIPlugin.SourceProps.Pan"), -1.0, 1.0,
 					0.001);
@@ -323,6 +628,23 @@ obs_properties_t *ndi_source_getproperties(void *data)
 	obs_properties_add_group(props, PROP_PTZ, obs_module_text("NDIPlugin.SourceProps.PTZ"), OBS_GROUP_CHECKABLE,
 				 group_ptz);
 
+	if (s) {
+		obs_properties_t *group_stats = obs_properties_create();
+		obs_properties_add_text(group_stats, PROP_STATS_TEXT, QT_TO_UTF8(ndi_source_stats_text(s)),
+					OBS_TEXT_INFO);
+		obs_properties_add_button2(
+			group_stats, PROP_STATS_REFRESH, obs_module_text("NDIPlugin.SourceProps.Stats.Refresh"),
+			[](obs_properties_t *props_, obs_property_t *, void *data_) {
+				auto s_ = (ndi_source_t *)data_;
+				obs_property_t *text = obs_properties_get(props_, PROP_STATS_TEXT);
+				obs_property_set_description(text, QT_TO_UTF8(ndi_source_stats_text(s_)));
+				return true;
+			},
+			s);
+		obs_properties_add_group(props, PROP_STATS, obs_module_text("NDIPlugin.SourceProps.Stats"),
+					 OBS_GROUP_NORMAL, group_stats);
+	}
+
 	auto group_ndi = obs_properties_create();
 	obs_properties_add_button(group_ndi, "ndi_website", NDI_OFFICIAL_WEB_URL,
 				  [](obs_properties_t *, obs_property_t *, void *) {
@@ -340,13 +662,20 @@ void ndi_source_getdefaults(obs_data_t *settings)
 {
 	obs_log(LOG_DEBUG, "+ndi_source_getdefaults(…)");
 	obs_data_set_default_int(settings, PROP_BANDWIDTH, PROP_BW_HIGHEST);
+	obs_data_set_default_int(settings, PROP_BW_AUTO_THRESHOLD, 540);
 	obs_data_set_default_int(settings, PROP_BEHAVIOR, PROP_BEHAVIOR_STOP_RESUME_LAST_FRAME);
 	obs_data_set_default_int(settings, PROP_TIMEOUT, PROP_TIMEOUT_KEEP_CONTENT);
+	obs_data_set_default_int(settings, PROP_TIMEOUT_SECONDS, 3);
 	obs_data_set_default_int(settings, PROP_SYNC, PROP_SYNC_NDI_SOURCE_TIMECODE);
 	obs_data_set_default_int(settings, PROP_YUV_RANGE, PROP_YUV_RANGE_PARTIAL);
 	obs_data_set_default_int(settings, PROP_YUV_COLORSPACE, PROP_YUV_SPACE_BT709);
 	obs_data_set_default_int(settings, PROP_LATENCY, PROP_LATENCY_NORMAL);
+	obs_data_set_default_int(settings, PROP_LATENCY_PROFILE, PROP_LATENCY_PROFILE_CUSTOM);
+	obs_data_set_default_int(settings, PROP_OUTPUT_DELAY_FRAMES, 3);
+	obs_data_set_default_int(settings, PROP_COLOR_FORMAT, PROP_COLOR_FORMAT_AUTO);
 	obs_data_set_default_bool(settings, PROP_AUDIO, true);
+	obs_data_set_default_int(settings, PROP_RECV_THREAD, PROP_RECV_THREAD_DEDICATED);
+	obs_data_set_default_int(settings, PROP_ALPHA_MODE, PROP_ALPHA_MODE_NONE);
 	obs_log(LOG_DEBUG, "-ndi_source_getdefaults(…)");
 }
 
@@ -362,391 +691,1071 @@ void deactivate_source_output_video_texture(ndi_source_t *source)
 
 	source->width = 0;
 	source->height = 0;
+	source->slate_active = false;
 	obs_log(LOG_DEBUG, "'%s' deactivate_source_output_video_texture(…)", obs_source_get_name(source->obs_source));
+	if (source->direct_render)
+		return; // ndi_source_direct_render draws nothing while width/height are 0
 	obs_source_output_video(source->obs_source, NULL);
 }
 
+static bool ndi_source_show_slate(ndi_source_t *source)
+{
+	pthread_mutex_lock(&source->slate_mutex);
+	bool loaded = source->slate_image.loaded;
+	if (loaded) {
+		obs_log(LOG_DEBUG, "'%s' ndi_source_show_slate(…)", obs_source_get_name(source->obs_source));
+		source->width = source->slate_image.cx;
+		source->height = source->slate_image.cy;
+		if (source->direct_render) {
+			source->slate_active = true;
+		} else {
+			source->slate_frame.timestamp = os_gettime_ns();
+			obs_source_output_video(source->obs_source, &source->slate_frame);
+		}
+	}
+	pthread_mutex_unlock(&source->slate_mutex);
+	return loaded;
+}
+
 void process_empty_frame(ndi_source_t *source)
 {
-	if (source->config.timeout_action == PROP_TIMEOUT_KEEP_CONTENT)
+	if (source->timeout_fired || source->config.timeout_action == PROP_TIMEOUT_KEEP_CONTENT)
 		return;
 
-	uint64_t now = os_gettime_ns();
+	if (os_gettime_ns() < source->last_frame_timestamp + source->config.timeout_ns)
+		return;
 
-	// 3 second timeout on no new data received for the source
-	uint64_t source_timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::seconds(3)).count();
+	// The last frame stays up (frozen) until here; from now on run the timeout action once.
+	source->timeout_fired = true;
+	if (source->config.timeout_action == PROP_TIMEOUT_SLATE && ndi_source_show_slate(source))
+		return;
 
-	uint64_t target_timestamp = source->last_frame_timestamp + source_timeout;
+	deactivate_source_output_video_texture(source);
+}
 
-	if (now > target_timestamp) {
-		deactivate_source_output_video_texture(source);
+static void ndi_source_load_slate(ndi_source_t *s, const char *path)
+{
+	auto obs_source_name = obs_source_get_name(s->obs_source);
+
+	pthread_mutex_lock(&s->slate_mutex);
+	if (s->slate_image.texture) {
+		obs_enter_graphics();
+		gs_image_file_free(&s->slate_image);
+		obs_leave_graphics();
+	} else {
+		gs_image_file_free(&s->slate_image);
 	}
+	s->slate_image = {};
+	s->slate_frame = {};
+
+	if (path && *path) {
+		gs_image_file_init(&s->slate_image, path);
+		if (s->slate_image.loaded &&
+		    (s->slate_image.format == GS_BGRA || s->slate_image.format == GS_RGBA)) {
+			s->slate_frame.data[0] = s->slate_image.texture_data;
+			s->slate_frame.linesize[0] = s->slate_image.cx * 4;
+			s->slate_frame.width = s->slate_image.cx;
+			s->slate_frame.height = s->slate_image.cy;
+			s->slate_frame.format = (s->slate_image.format == GS_BGRA) ? VIDEO_FORMAT_BGRA
+										   : VIDEO_FORMAT_RGBA;
+			s->slate_frame.full_range = true;
+			obs_log(LOG_DEBUG, "'%s' ndi_source_load_slate: loaded '%s' (%ux%u)", obs_source_name, path,
+				s->slate_image.cx, s->slate_image.cy);
+		} else {
+			obs_log(LOG_WARNING, "WARN-427 - Could not load the slate image '%s' for source '%s'", path,
+				obs_source_name);
+			gs_image_file_free(&s->slate_image);
+			s->slate_image = {};
+		}
+	}
+	pthread_mutex_unlock(&s->slate_mutex);
 }
 
 void ndi_source_thread_process_audio3(ndi_source_config_t *config, NDIlib_audio_frame_v3_t *ndi_audio_frame,
-				      obs_source_t *obs_source, obs_source_audio *obs_audio_frame);
+				      obs_source_t *obs_source, obs_source_audio *obs_audio_frame,
+				      ndi_source_stats_t *stats);
 
 void ndi_source_thread_process_video2(ndi_source_t *source, NDIlib_video_frame_v2_t *ndi_video_frame,
 				      obs_source *obs_source, obs_source_frame *obs_video_frame);
 
-void *ndi_source_thread(void *data)
+static void ndi_source_free_video(NDIlib_recv_instance_t ndi_receiver, NDIlib_framesync_instance_t ndi_frame_sync,
+				  NDIlib_video_frame_v2_t *video_frame)
+{
+	if (ndi_frame_sync)
+		ndiLib->framesync_free_video(ndi_frame_sync, video_frame);
+	else
+		ndiLib->recv_free_video_v2(ndi_receiver, video_frame);
+}
+
+/**
+ * Plane layout of an NDI frame for the direct source's textures.
+ * @param planes Output planes, by texture index; unused ones have GS_UNKNOWN as format
+ * @return false for formats the decode effect does not handle
+ */
+static bool ndi_source_direct_planes(const NDIlib_video_frame_v2_t *video_frame, ndi_direct_plane_t planes[3])
+{
+	const uint32_t width = video_frame->xres;
+	const uint32_t height = video_frame->yres;
+	const uint32_t stride = video_frame->line_stride_in_bytes;
+	const uint8_t *data = video_frame->p_data;
+	const uint32_t chroma_width = (width + 1) / 2;
+	const uint32_t chroma_height = (height + 1) / 2;
+
+	planes[0] = {width, height, GS_UNKNOWN, data, stride, width * 4};
+	planes[1] = {};
+	planes[2] = {};
+
+	switch (video_frame->FourCC) {
+	case NDIlib_FourCC_type_BGRA:
+		planes[0].format = GS_BGRA;
+		return true;
+
+	case NDIlib_FourCC_type_BGRX:
+		planes[0].format = GS_BGRX;
+		return true;
+
+	case NDIlib_FourCC_type_RGBA:
+	case NDIlib_FourCC_type_RGBX:
+		planes[0].format = GS_RGBA;
+		return true;
+
+	case NDIlib_FourCC_type_UYVY:
+	case NDIlib_FourCC_type_UYVA:
+		// One BGRA texel per U Y0 V Y1 macropixel; decoded by the effect
+		planes[0] = {chroma_width, height, GS_BGRA, data, stride, chroma_width * 4};
+		if (video_frame->FourCC == NDIlib_FourCC_type_UYVA) {
+			// The alpha plane follows the UYVY plane, one byte per pixel; it is padded like the UYVY rows,
+			// so its lines are half the UYVY stride (as for the I420 chroma planes)
+			planes[2] = {width, height, GS_R8, data + (size_t)stride * height, stride / 2, width};
+		}
+		return true;
+
+	case NDIlib_FourCC_type_P216:
+	case NDIlib_FourCC_type_PA16:
+		planes[0] = {width, height, GS_R16, data, stride, width * 2};
+		planes[1] = {chroma_width, height, GS_RG16, data + (size_t)stride * height, stride, chroma_width * 4};
+		if (video_frame->FourCC == NDIlib_FourCC_type_PA16) {
+			planes[2] = {width, height, GS_R16, data + (size_t)stride * height * 2, stride, width * 2};
+		}
+		return true;
+
+	case NDIlib_FourCC_type_NV12:
+		planes[0] = {width, height, GS_R8, data, stride, width};
+		planes[1] = {chroma_width, chroma_height, GS_R8G8, data + (size_t)stride * height, stride,
+			     chroma_width * 2};
+		return true;
+
+	case NDIlib_FourCC_type_I420: {
+		// U then V, at half the Y stride
+		const uint8_t *u_plane = data + (size_t)stride * height;
+		planes[0] = {width, height, GS_R8, data, stride, width};
+		planes[1] = {chroma_width, chroma_height, GS_R8, u_plane, stride / 2, chroma_width};
+		planes[2] = {chroma_width, chroma_height, GS_R8, u_plane + (size_t)(stride / 2) * chroma_height,
+			     stride / 2, chroma_width};
+		return true;
+	}
+
+	default:
+		return false;
+	}
+}
+
+void ndi_source_direct_park_video(ndi_source_t *s, NDIlib_recv_instance_t ndi_receiver,
+				  NDIlib_framesync_instance_t ndi_frame_sync, NDIlib_video_frame_v2_t *video_frame)
+{
+	pthread_mutex_lock(&s->direct_mutex);
+	ndi_direct_slot_t *slot = nullptr;
+	for (auto &candidate : s->direct_slots) {
+		if (candidate.state == NDI_DIRECT_SLOT_MAPPED && candidate.fourcc == video_frame->FourCC &&
+		    candidate.width == (uint32_t)video_frame->xres && candidate.height == (uint32_t)video_frame->yres)
+			slot = &candidate;
+	}
+	if (s->direct_frame_pending) {
+		// The previous frame never got rendered; drop it in favor of the newer one.
+		ndi_source_free_video(s->direct_frame_receiver, s->direct_frame_sync, &s->direct_frame);
+		s->direct_frame_pending = false;
+	}
+	if (slot) {
+		slot->state = NDI_DIRECT_SLOT_WRITING;
+	} else {
+		s->direct_frame = *video_frame;
+		s->direct_frame_receiver = ndi_receiver;
+		s->direct_frame_sync = ndi_frame_sync;
+		s->direct_frame_pending = true;
+	}
+
+	s->width = video_frame->xres;
+	s->height = video_frame->yres;
+	s->last_frame_timestamp = obs_get_video_frame_time();
+	s->timeout_fired = false;
+	s->slate_active = false;
+	pthread_mutex_unlock(&s->direct_mutex);
+
+	if (slot) {
+		// The slot's layout matches the frame, so the planes are valid
+		NDI_TRACE_ZONE("ndi_source_direct_write");
+		ndi_direct_plane_t planes[3];
+		ndi_source_direct_planes(video_frame, planes);
+		for (int i = 0; i < 3; i++) {
+			if (planes[i].format != GS_UNKNOWN)
+				ndi_readback_copy_plane(slot->mapped_data[i], slot->mapped_linesize[i], planes[i].data,
+							planes[i].linesize, planes[i].row_bytes, planes[i].height);
+		}
+		ndi_source_free_video(ndi_receiver, ndi_frame_sync, video_frame);
+
+		pthread_mutex_lock(&s->direct_mutex);
+		slot->state = NDI_DIRECT_SLOT_FILLED;
+		pthread_mutex_unlock(&s->direct_mutex);
+	}
+
+	s->stats.video_frames++;
+	s->stats.video_latency_ns = ndi_timestamp_latency_ns(video_frame->timestamp);
+}
+
+void ndi_source_direct_drop_video(ndi_source_t *s)
+{
+	// Must be called before the receiver or framesync owning the parked frame is destroyed.
+	pthread_mutex_lock(&s->direct_mutex);
+	if (s->direct_frame_pending) {
+		ndi_source_free_video(s->direct_frame_receiver, s->direct_frame_sync, &s->direct_frame);
+		s->direct_frame_pending = false;
+	}
+	pthread_mutex_unlock(&s->direct_mutex);
+}
+
+void *ndi_source_audio_thread(void *data)
 {
 	auto s = (ndi_source_t *)data;
 	auto obs_source_name = obs_source_get_name(s->obs_source);
-	obs_log(LOG_DEBUG, "'%s' +ndi_source_thread(…)", obs_source_name);
+	obs_log(LOG_DEBUG, "'%s' +ndi_source_audio_thread(…)", obs_source_name);
 
-	auto config = Config::Current();
-	ptz_t ptz;
-	NDIlib_tally_t tally;
+	auto ndi_receiver = s->audio_thread_receiver;
+	obs_source_audio obs_audio_frame = {};
+	NDIlib_audio_frame_v3_t audio_frame;
+
+	while (s->audio_thread_running) {
+		// Audio-only capture: video frames stay queued for ndi_source_thread
+		if (ndiLib->recv_capture_v3(ndi_receiver, nullptr, &audio_frame, nullptr, 100) ==
+		    NDIlib_frame_type_audio) {
+			ndi_source_thread_process_audio3(&s->config, &audio_frame, s->obs_source, &obs_audio_frame,
+							 &s->stats);
+			ndiLib->recv_free_audio_v3(ndi_receiver, &audio_frame);
+		}
+	}
+
+	obs_log(LOG_DEBUG, "'%s' -ndi_source_audio_thread(…)", obs_source_name);
+
+	return nullptr;
+}
+
+static void ndi_source_audio_thread_start(ndi_source_t *s, NDIlib_recv_instance_t ndi_receiver)
+{
+	s->audio_thread_receiver = ndi_receiver;
+	s->audio_thread_running = true;
+	pthread_create(&s->audio_thread, nullptr, ndi_source_audio_thread, s);
+	obs_log(LOG_DEBUG, "'%s' ndi_source_audio_thread_start: Started audio ndi_source_audio_thread",
+		obs_source_get_name(s->obs_source));
+}
+
+static void ndi_source_audio_thread_stop(ndi_source_t *s)
+{
+	if (s->audio_thread_running) {
+		s->audio_thread_running = false;
+		pthread_join(s->audio_thread, NULL);
+		s->audio_thread_receiver = nullptr;
+		obs_log(LOG_DEBUG, "'%s' ndi_source_audio_thread_stop: Stopped audio ndi_source_audio_thread",
+			obs_source_get_name(s->obs_source));
+	}
+}
+
+//
+// Receiver state that survives between ndi_source_thread_step calls.
+// Owned by whichever thread (dedicated or pooled worker) currently drives the source.
+//
+typedef struct ndi_receiver_state_t {
+	NDIlib_recv_create_v3_t recv_desc;
+	// Own copies of the names recv_desc points at: ndi_source_update replaces the config strings, and the
+	// pre-warmed automatic bandwidth receiver is created from recv_desc long after a reset or reconnect.
+	char *recv_name = nullptr;
+	char *source_name = nullptr;
+	NDIlib_recv_instance_t ndi_receiver = nullptr;
+	NDIlib_framesync_instance_t ndi_frame_sync = nullptr;
 
 	obs_source_audio obs_audio_frame = {};
 	obs_source_frame obs_video_frame = {};
 
-	NDIlib_recv_create_v3_t recv_desc;
-	recv_desc.allow_video_fields = true;
+	int64_t timestamp_audio = 0;
+	int64_t timestamp_video = 0;
+
+	// Framesync audio is pulled by elapsed time: audio_sample_debt holds the samples owed since the
+	// last pull, scaled by 1e9 so the fractional part carries over instead of drifting.
+	int audio_sample_rate = 48000;
+	uint64_t last_audio_pull_ns = 0;
+	uint64_t audio_sample_debt = 0;
+
+	uint64_t last_stats_poll_ns = 0;
+
+	uint64_t connect_backoff_ns = 0;
+	uint64_t next_connect_check_ns = 0;
+
+	// A receiver (or framesync) that could not be created is reset again once next_reset_ns is reached,
+	// backing off like the connection check
+	uint64_t reset_backoff_ns = 0;
+	uint64_t next_reset_ns = 0;
+
+	// Automatic bandwidth: bandwidth of ndi_receiver, and a pre-warmed receiver at the other bandwidth.
+	// The pending receiver replaces ndi_receiver once it delivers its first video frame, so there is no gap.
+	NDIlib_recv_bandwidth_e current_bandwidth = NDIlib_recv_bandwidth_highest;
+	NDIlib_recv_instance_t pending_receiver = nullptr;
+	NDIlib_recv_bandwidth_e pending_bandwidth = NDIlib_recv_bandwidth_highest;
+
+	// Broadcast profile output delay: framesync video frames held, oldest first, until output_delay_frames newer
+	// ones arrived; audio is only pulled once the framesync queue holds as long, and again after it ran dry.
+	// Framesync already corrected the timing, so this only shifts the output later (e.g. to line up with
+	// other sources); it does not absorb network jitter.
+	NDIlib_video_frame_v2_t delay_frames[NDI_SOURCE_OUTPUT_DELAY_MAX_FRAMES + 1] = {};
+	int delay_head = 0;
+	int delay_count = 0;
+	bool audio_primed = false;
+} ndi_receiver_state_t;
+
+// Must be called before the framesync holding the frames is destroyed
+static void ndi_source_delay_flush(ndi_receiver_state_t *r)
+{
+	for (; r->delay_count > 0; r->delay_count--) {
+		ndiLib->framesync_free_video(r->ndi_frame_sync, &r->delay_frames[r->delay_head]);
+		r->delay_head = (r->delay_head + 1) % (NDI_SOURCE_OUTPUT_DELAY_MAX_FRAMES + 1);
+	}
+	r->delay_head = 0;
+	r->audio_primed = false;
+}
+
+/**
+ * Queue a new framesync video frame in the output delay line and take the one to output instead.
+ * Frames beyond the configured depth (after it was lowered) are freed.
+ * @param video_frame In: the new frame, now owned by the delay line. Out: the frame to output.
+ * @return false while the delay line is filling up, with nothing to output
+ */
+static bool ndi_source_delay_push(ndi_source_t *s, ndi_receiver_state_t *r, NDIlib_video_frame_v2_t *video_frame)
+{
+	const int ring_size = NDI_SOURCE_OUTPUT_DELAY_MAX_FRAMES + 1;
+	int depth = std::min(s->config.output_delay_frames, NDI_SOURCE_OUTPUT_DELAY_MAX_FRAMES);
+	if (depth <= 0 && r->delay_count == 0)
+		return true;
+
+	r->delay_frames[(r->delay_head + r->delay_count) % ring_size] = *video_frame;
+	r->delay_count++;
+	while (r->delay_count > depth + 1) {
+		ndiLib->framesync_free_video(r->ndi_frame_sync, &r->delay_frames[r->delay_head]);
+		r->delay_head = (r->delay_head + 1) % ring_size;
+		r->delay_count--;
+	}
+	if (r->delay_count <= depth)
+		return false;
+
+	*video_frame = r->delay_frames[r->delay_head];
+	r->delay_head = (r->delay_head + 1) % ring_size;
+	r->delay_count--;
+	return true;
+}
+
+static NDIlib_recv_bandwidth_e ndi_source_bw_auto_target(ndi_source_t *s)
+{
+	return s->bw_auto_highest ? NDIlib_recv_bandwidth_highest : NDIlib_recv_bandwidth_lowest;
+}
+
+static void ndi_source_bw_auto_discard_pending(ndi_source_t *s, ndi_receiver_state_t *r)
+{
+	if (r->pending_receiver) {
+		obs_log(LOG_DEBUG, "'%s' ndi_source_thread: bw_auto: destroying pending receiver",
+			obs_source_get_name(s->obs_source));
+		ndiLib->recv_destroy(r->pending_receiver);
+		r->pending_receiver = nullptr;
+	}
+}
+
+/**
+ * Automatic bandwidth: pre-warm a receiver at the wanted bandwidth and swap it in on its first video frame.
+ * @return true if a video frame from the new receiver was processed
+ */
+static bool ndi_source_bw_auto_step(ndi_source_t *s, ndi_receiver_state_t *r)
+{
+	auto obs_source_name = obs_source_get_name(s->obs_source);
+	auto target = ndi_source_bw_auto_target(s);
+
+	if (target == r->current_bandwidth) {
+		ndi_source_bw_auto_discard_pending(s, r);
+		return false;
+	}
+
+	if (r->pending_receiver && r->pending_bandwidth != target)
+		ndi_source_bw_auto_discard_pending(s, r);
+
+	if (!r->pending_receiver) {
+		NDIlib_recv_create_v3_t pending_desc = r->recv_desc;
+		pending_desc.bandwidth = target;
+		obs_log(LOG_DEBUG, "'%s' ndi_source_thread: bw_auto: pre-warming receiver with bandwidth=%d",
+			obs_source_name, target);
+		r->pending_receiver = ndiLib->recv_create_v3(&pending_desc);
+		r->pending_bandwidth = target;
+		if (r->pending_receiver && s->config.hw_accel_enabled) {
+			// Same request as in reset_ndi_receiver; the metadata is bound to the receiver instance.
+			NDIlib_metadata_frame_t hwAccelMetadata;
+			hwAccelMetadata.p_data = (char *)"<ndi_video_codec type=\"hardware\"/>";
+			ndiLib->recv_send_metadata(r->pending_receiver, &hwAccelMetadata);
+		}
+		return false;
+	}
 
-	NDIlib_recv_instance_t ndi_receiver = nullptr;
 	NDIlib_video_frame_v2_t video_frame;
+	if (ndiLib->recv_capture_v3(r->pending_receiver, &video_frame, nullptr, nullptr, 0) !=
+	    NDIlib_frame_type_video)
+		return false;
 
-	NDIlib_metadata_frame_t metadata_frame;
-	NDIlib_framesync_instance_t ndi_frame_sync = nullptr;
+	//
+	// The pre-warmed receiver is live: retire the old one.
+	//
+	obs_log(LOG_INFO, "'%s': Automatic bandwidth switched to %s", obs_source_name,
+		target == NDIlib_recv_bandwidth_highest ? "highest" : "lowest");
+
+	ndi_source_direct_drop_video(s);
+	ndi_source_audio_thread_stop(s);
+	if (r->ndi_frame_sync) {
+		ndi_source_delay_flush(r);
+		ndiLib->framesync_destroy(r->ndi_frame_sync);
+		r->ndi_frame_sync = nullptr;
+	}
+	// The control path moves to the new receiver (tally is sent again) before the old one goes away
+	ndi_control_set_receiver(s->control, r->pending_receiver);
+	ndiLib->recv_destroy(r->ndi_receiver);
+
+	r->ndi_receiver = r->pending_receiver;
+	r->current_bandwidth = target;
+	r->recv_desc.bandwidth = target;
+	r->pending_receiver = nullptr;
+
+	if (s->config.framesync_enabled) {
+		r->ndi_frame_sync = ndiLib->framesync_create(r->ndi_receiver);
+		r->timestamp_audio = 0;
+		r->last_audio_pull_ns = 0;
+		r->audio_sample_debt = 0;
+		r->timestamp_video = 0;
+		ndiLib->recv_free_video_v2(r->ndi_receiver, &video_frame);
+		return true;
+	}
+
+	if (s->config.audio_thread_enabled)
+		ndi_source_audio_thread_start(s, r->ndi_receiver);
+
+	if (s->direct_render) {
+		ndi_source_direct_park_video(s, r->ndi_receiver, nullptr, &video_frame);
+	} else {
+		ndi_source_thread_process_video2(s, &video_frame, s->obs_source, &r->obs_video_frame);
+		ndiLib->recv_free_video_v2(r->ndi_receiver, &video_frame);
+	}
+	return true;
+}
+
+/**
+ * Create or destroy the framesync of the current receiver after config.framesync_enabled changed, without
+ * resetting the receiver. The optional audio thread only runs without framesync.
+ * @return false if the framesync could not be created
+ */
+static bool ndi_source_apply_framesync(ndi_source_t *s, ndi_receiver_state_t *r)
+{
+	auto obs_source_name = obs_source_get_name(s->obs_source);
+	bool enabled = s->config.framesync_enabled;
+	if (enabled == (r->ndi_frame_sync != nullptr))
+		return true;
+
+	// A parked direct frame belongs to the receiver or framesync it came from
+	ndi_source_direct_drop_video(s);
+	r->timestamp_audio = 0;
+	r->timestamp_video = 0;
+	r->last_audio_pull_ns = 0;
+	r->audio_sample_debt = 0;
+
+	if (enabled) {
+		ndi_source_audio_thread_stop(s);
+		r->ndi_frame_sync = ndiLib->framesync_create(r->ndi_receiver);
+		if (!r->ndi_frame_sync) {
+			obs_log(LOG_ERROR, "ERR-408 - Error creating the NDI Frame Sync for '%s' for '%s'",
+				r->recv_desc.source_to_connect_to.p_ndi_name, obs_source_name);
+			return false;
+		}
+	} else {
+		ndi_source_delay_flush(r);
+		ndiLib->framesync_destroy(r->ndi_frame_sync);
+		r->ndi_frame_sync = nullptr;
+		if (s->config.audio_thread_enabled && s->config.bandwidth != PROP_BW_AUDIO_ONLY)
+			ndi_source_audio_thread_start(s, r->ndi_receiver);
+	}
+
+	obs_log(LOG_INFO, "'%s': Framesync %s on the current receiver", obs_source_name,
+		enabled ? "enabled" : "disabled");
+	return true;
+}
+
+// Schedule another reset after a failed one; the source stays in its receive loop (or pool) meanwhile
+static ndi_receiver_pool_step_result ndi_source_retry_reset(ndi_source_t *s, ndi_receiver_state_t *r)
+{
+	if (r->reset_backoff_ns == 0)
+		r->reset_backoff_ns = NDI_SOURCE_CONNECT_BACKOFF_MIN_NS;
+	else
+		r->reset_backoff_ns = std::min<uint64_t>(r->reset_backoff_ns * 2, NDI_SOURCE_CONNECT_BACKOFF_MAX_NS);
+	r->next_reset_ns = os_gettime_ns() + r->reset_backoff_ns;
+	s->config.reset_ndi_receiver = true;
+	return NDI_RECEIVER_POOL_STEP_IDLE;
+}
+
+/**
+ * Run one iteration of the receive loop for a source: reset the receiver if requested
+ * and capture at most one frame.
+ * @param pooled true when called from the shared receiver pool; the step then never blocks
+ */
+ndi_receiver_pool_step_result ndi_source_thread_step(ndi_source_t *s, bool pooled)
+{
+	auto r = s->receiver_state;
+	auto obs_source_name = obs_source_get_name(s->obs_source);
+
+	auto &recv_desc = r->recv_desc;
+	auto &ndi_receiver = r->ndi_receiver;
+	auto &ndi_frame_sync = r->ndi_frame_sync;
+	auto &obs_audio_frame = r->obs_audio_frame;
+	auto &obs_video_frame = r->obs_video_frame;
+	auto &timestamp_audio = r->timestamp_audio;
+	auto &timestamp_video = r->timestamp_video;
+	auto &audio_sample_rate = r->audio_sample_rate;
+
+	NDIlib_video_frame_v2_t video_frame;
 	NDIlib_audio_frame_v3_t audio_frame;
 	NDIlib_frame_type_e frame_received = NDIlib_frame_type_none;
 
-	int64_t timestamp_audio = 0;
-	int64_t timestamp_video = 0;
+	// Retrying a failed reset: pooled receivers are skipped until it is due, dedicated threads wait for it,
+	// unless woken early by a settings change or a stop request.
+	uint64_t reset_now_ns = os_gettime_ns();
+	if (s->config.reset_ndi_receiver && reset_now_ns < r->next_reset_ns) {
+		if (!pooled)
+			os_event_timedwait(s->wake_event,
+					   (unsigned long)((r->next_reset_ns - reset_now_ns) / 1000000ULL) + 1);
+		return NDI_RECEIVER_POOL_STEP_IDLE;
+	}
 
 	//
-	// Main NDI receiver loop: BEGIN
+	// reset_ndi_receiver: BEGIN
 	//
-	while (s->running) {
-		//
-		// reset_ndi_receiver: BEGIN
-		//
-		if (s->config.reset_ndi_receiver) {
-			s->config.reset_ndi_receiver = false;
+	if (s->config.reset_ndi_receiver) {
+		s->config.reset_ndi_receiver = false;
 
-			// If config.ndi_receiver_name changed, then so did obs_source_name
-			obs_source_name = obs_source_get_name(s->obs_source);
+		// If config.ndi_receiver_name changed, then so did obs_source_name
+		obs_source_name = obs_source_get_name(s->obs_source);
 
-			//
-			// Update recv_desc.p_ndi_recv_name
-			//
-			recv_desc.p_ndi_recv_name = s->config.ndi_receiver_name;
-			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.p_ndi_recv_name='%s'",
-				obs_source_name, //
-				recv_desc.p_ndi_recv_name);
+		//
+		// Update recv_desc.p_ndi_recv_name
+		//
+		bfree(r->recv_name);
+		r->recv_name = bstrdup(s->config.ndi_receiver_name);
+		recv_desc.p_ndi_recv_name = r->recv_name;
+		obs_log(LOG_DEBUG,
+			"'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.p_ndi_recv_name='%s'",
+			obs_source_name, //
+			recv_desc.p_ndi_recv_name);
 
-			//
-			// Update recv_desc.source_to_connect_to.p_ndi_name
-			//
-			recv_desc.source_to_connect_to.p_ndi_name = s->config.ndi_source_name;
-			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.source_to_connect_to.p_ndi_name='%s'",
-				obs_source_name, //
-				recv_desc.source_to_connect_to.p_ndi_name);
+		//
+		// Update recv_desc.source_to_connect_to.p_ndi_name
+		//
+		bfree(r->source_name);
+		r->source_name = bstrdup(s->config.ndi_source_name);
+		recv_desc.source_to_connect_to.p_ndi_name = r->source_name;
+		obs_log(LOG_DEBUG,
+			"'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.source_to_connect_to.p_ndi_name='%s'",
+			obs_source_name, //
+			recv_desc.source_to_connect_to.p_ndi_name);
 
-			//
-			// Update recv_desc.bandwidth
-			//
-			switch (s->config.bandwidth) {
-			case PROP_BW_HIGHEST:
-			default:
-				recv_desc.bandwidth = NDIlib_recv_bandwidth_highest;
-				break;
-			case PROP_BW_LOWEST:
-				recv_desc.bandwidth = NDIlib_recv_bandwidth_lowest;
-				break;
-			case PROP_BW_AUDIO_ONLY:
-				recv_desc.bandwidth = NDIlib_recv_bandwidth_audio_only;
-				break;
-			}
-			obs_log(LOG_DEBUG, "'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.bandwidth=%d",
-				obs_source_name, //
-				recv_desc.bandwidth);
+		//
+		// Update recv_desc.bandwidth
+		//
+		switch (s->config.bandwidth) {
+		case PROP_BW_HIGHEST:
+		default:
+			recv_desc.bandwidth = NDIlib_recv_bandwidth_highest;
+			break;
+		case PROP_BW_LOWEST:
+			recv_desc.bandwidth = NDIlib_recv_bandwidth_lowest;
+			break;
+		case PROP_BW_AUDIO_ONLY:
+			recv_desc.bandwidth = NDIlib_recv_bandwidth_audio_only;
+			break;
+		case PROP_BW_AUTO:
+			recv_desc.bandwidth = ndi_source_bw_auto_target(s);
+			break;
+		}
+		r->current_bandwidth = recv_desc.bandwidth;
+		obs_log(LOG_DEBUG, "'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.bandwidth=%d",
+			obs_source_name, //
+			recv_desc.bandwidth);
 
-			//
-			// Update recv_desc.latency
-			//
-			if (s->config.latency == PROP_LATENCY_NORMAL)
+		//
+		// Update recv_desc.latency
+		//
+		switch (s->config.color_format) {
+		case PROP_COLOR_FORMAT_YUV_FASTEST:
+			// UYVY, or UYVA when the sender has alpha
+			recv_desc.color_format = NDIlib_recv_color_format_fastest;
+			break;
+		case PROP_COLOR_FORMAT_YUV_16BIT:
+			// P216, or PA16 when the sender has alpha
+			recv_desc.color_format = NDIlib_recv_color_format_best;
+			break;
+		case PROP_COLOR_FORMAT_BGRA:
+			recv_desc.color_format = NDIlib_recv_color_format_BGRX_BGRA;
+			break;
+		case PROP_COLOR_FORMAT_AUTO:
+		default:
+			// Direct rendering decodes UYVA on the GPU, so it can keep alpha in YUV
+			if (s->config.latency == PROP_LATENCY_NORMAL && !s->direct_render)
 				recv_desc.color_format = NDIlib_recv_color_format_UYVY_BGRA;
 			else
 				recv_desc.color_format = NDIlib_recv_color_format_fastest;
-			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.color_format=%d",
-				obs_source_name, //
-				recv_desc.color_format);
+			break;
+		}
+		obs_log(LOG_DEBUG,
+			"'%s' ndi_source_thread: reset_ndi_receiver; Setting recv_desc.color_format=%d",
+			obs_source_name, //
+			recv_desc.color_format);
 
-			video_format_get_parameters(s->config.yuv_colorspace, s->config.yuv_range,
-						    obs_video_frame.color_matrix, obs_video_frame.color_range_min,
-						    obs_video_frame.color_range_max);
+		// Color parameters depend on the frame format; recomputed on the next video frame
+		obs_video_frame.format = VIDEO_FORMAT_NONE;
 
-			//
-			// recv_desc is fully populated;
-			// now reset the NDI receiver, destroying any existing ndi_frame_sync or ndi_receiver.
-			//
-			obs_log(LOG_DEBUG, "'%s' ndi_source_thread: reset_ndi_receiver: Resetting NDI receiver…",
+		//
+		// recv_desc is fully populated;
+		// now reset the NDI receiver, destroying any existing ndi_frame_sync or ndi_receiver.
+		//
+		obs_log(LOG_DEBUG, "'%s' ndi_source_thread: reset_ndi_receiver: Resetting NDI receiver…",
+			obs_source_name);
+
+		ndi_source_bw_auto_discard_pending(s, r);
+
+		s->config.reconnect_ndi_receiver = false;
+		s->config.framesync_changed = false;
+		r->connect_backoff_ns = 0;
+		r->next_connect_check_ns = 0;
+
+		ndi_source_direct_drop_video(s);
+		ndi_source_audio_thread_stop(s);
+
+		if (ndi_frame_sync) {
+			obs_log(LOG_DEBUG, "'%s' ndi_source_thread: ndiLib->framesync_destroy(ndi_frame_sync)",
 				obs_source_name);
+			ndi_source_delay_flush(r);
+			ndiLib->framesync_destroy(ndi_frame_sync);
+			ndi_frame_sync = nullptr;
+		}
 
-			if (ndi_frame_sync) {
-				obs_log(LOG_DEBUG, "'%s' ndi_source_thread: ndiLib->framesync_destroy(ndi_frame_sync)",
-					obs_source_name);
-				ndiLib->framesync_destroy(ndi_frame_sync);
-				ndi_frame_sync = nullptr;
-			}
+		if (ndi_receiver) {
+			obs_log(LOG_DEBUG,
+				"'%s' ndi_source_thread: reset_ndi_receiver: ndiLib->recv_destroy(ndi_receiver)",
+				obs_source_name);
+			ndi_control_set_receiver(s->control, nullptr);
+			ndiLib->recv_destroy(ndi_receiver);
+			ndi_receiver = nullptr;
+		}
 
-			if (ndi_receiver) {
-				obs_log(LOG_DEBUG,
-					"'%s' ndi_source_thread: reset_ndi_receiver: ndiLib->recv_destroy(ndi_receiver)",
-					obs_source_name);
-				ndiLib->recv_destroy(ndi_receiver);
-				ndi_receiver = nullptr;
-			}
+		obs_log(LOG_DEBUG,
+			"'%s' ndi_source_thread: reset_ndi_receiver: recv_desc = { p_ndi_recv_name='%s', source_to_connect_to.p_ndi_name='%s' }",
+			obs_source_name, //
+			recv_desc.p_ndi_recv_name, recv_desc.source_to_connect_to.p_ndi_name);
+		obs_log(LOG_DEBUG,
+			"'%s' ndi_source_thread: reset_ndi_receiver: +ndi_receiver = ndiLib->recv_create_v3(&recv_desc)",
+			obs_source_name);
+
+		ndi_receiver = ndiLib->recv_create_v3(&recv_desc);
 
+		obs_log(LOG_DEBUG,
+			"'%s' ndi_source_thread: reset_ndi_receiver: -ndi_receiver = ndiLib->recv_create_v3(&recv_desc)",
+			obs_source_name);
+		if (!ndi_receiver) {
+			obs_log(LOG_ERROR, "ERR-407 - Error creating the NDI Receiver '%s' set for '%s'",
+				recv_desc.source_to_connect_to.p_ndi_name, obs_source_name);
 			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: reset_ndi_receiver: recv_desc = { p_ndi_recv_name='%s', source_to_connect_to.p_ndi_name='%s' }",
-				obs_source_name, //
-				recv_desc.p_ndi_recv_name, recv_desc.source_to_connect_to.p_ndi_name);
+				"'%s' ndi_source_thread: reset_ndi_receiver: Cannot create ndi_receiver for NDI source '%s'",
+				obs_source_name, recv_desc.source_to_connect_to.p_ndi_name);
+			return ndi_source_retry_reset(s, r);
+		}
+		ndi_control_set_receiver(s->control, ndi_receiver);
+
+		if (s->config.hw_accel_enabled) {
+			//
+			// From https://docs.ndi.video/docs/sdk/performance-and-implementation#receiving-video :
+			// > * In the modern versions of NDI, there are internal heuristics that attempt to guess whether hardware
+			// > acceleration would enable better performance. That said, it is possible to explicitly enable hardware
+			// > acceleration if you believe that it would be beneficial for your application. This can be enabled by
+			// > sending an XML metadata message to a receiver as follows:
+			// >	<ndi_video_codec type="hardware"/>
+			//
+			// The wording of this says very unambiguously "it is possible to explicitly enable hardware acceleration",
+			// but this can in reality only ever be a **REQUEST** to enable. The enable could possibly fail for the
+			// obvious reason that the device may not have/support hardware acceleration.
+			//
+			// Furthermore, there is no documented way to request to *disable* hardware acceleration.
+			// I have tried setting the metadata to `<ndi_video_codec type=""/>` or `<ndi_video_codec/>` and it does not
+			// crash, but I was unable to confirm if this actually disabled hardware acceleration, and am skeptical that
+			// it could/would.
+			// So, it seems like there is no way to disable this.
+			// I have asked on the NewTek NDI SDK forum here:
+			// https://forum.vizrt.com/index.php?threads/any-way-to-explicitly-turn-off-hardware-acceleration.253766/
+			//
+			// Regardless, it makes little sense to have a checkbox that requests to enable this when
+			// checked but do nothing when unchecked.
+			// But that is basically what we are going to do here.
+			//
+			// One other way we try to mitigate this is to reset the NDI receiver when hw_accel_enabled is changed
+			// [in `ndi_source_update`]
+			// The theory is that the below `recv_send_metadata` is bound to the NDI receiver instance.
+			// Destroy that receiver instance and you also destroy the metadata and thus the hardware acceleration.
+			// There is no confirmation that this works as theorized.
+			//
+			// Receiving the compressed H.264/HEVC frames of NDI|HX sources (to record them without decoding) needs
+			// the compressed color formats and FourCCs of the NDI Advanced SDK, which are not part of the standard
+			// SDK this plugin ships with and loads at runtime. The decoded frames are always used here.
+			//
+			NDIlib_metadata_frame_t hwAccelMetadata;
+			hwAccelMetadata.p_data = (char *)"<ndi_video_codec type=\"hardware\"/>";
 			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: reset_ndi_receiver: +ndi_receiver = ndiLib->recv_create_v3(&recv_desc)",
-				obs_source_name);
+				"'%s' ndi_source_thread: reset_ndi_receiver; Sending NDI Hardware Acceleration metadata: '%s'",
+				obs_source_name, hwAccelMetadata.p_data);
+			ndiLib->recv_send_metadata(ndi_receiver, &hwAccelMetadata);
+		}
 
-			ndi_receiver = ndiLib->recv_create_v3(&recv_desc);
+		if (s->config.audio_thread_enabled && !s->config.framesync_enabled &&
+		    s->config.bandwidth != PROP_BW_AUDIO_ONLY) {
+			// Framesync pulls audio in step with the video tick, so it keeps audio on this thread.
+			ndi_source_audio_thread_start(s, ndi_receiver);
+		}
 
+		if (s->config.framesync_enabled) {
+			timestamp_audio = 0;
+			timestamp_video = 0;
+			r->last_audio_pull_ns = 0;
+			r->audio_sample_debt = 0;
 			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: reset_ndi_receiver: -ndi_receiver = ndiLib->recv_create_v3(&recv_desc)",
+				"'%s' ndi_source_thread: +ndi_frame_sync = ndiLib->framesync_create(ndi_receiver)",
 				obs_source_name);
-			if (!ndi_receiver) {
-				obs_log(LOG_ERROR, "ERR-407 - Error creating the NDI Receiver '%s' set for '%s'",
+			ndi_frame_sync = ndiLib->framesync_create(ndi_receiver);
+			obs_log(LOG_DEBUG,
+				"'%s' ndi_source_thread: -ndi_frame_sync = ndiLib->framesync_create(ndi_receiver); ndi_frame_sync=%p",
+				obs_source_name, //
+				ndi_frame_sync);
+			if (!ndi_frame_sync) {
+				obs_log(LOG_ERROR,
+					"ERR-408 - Error creating the NDI Frame Sync for '%s' for '%s'",
 					recv_desc.source_to_connect_to.p_ndi_name, obs_source_name);
 				obs_log(LOG_DEBUG,
-					"'%s' ndi_source_thread: reset_ndi_receiver: Cannot create ndi_receiver for NDI source '%s'",
+					"'%s' ndi_source_thread: Cannot create ndi_frame_sync for NDI source '%s'",
 					obs_source_name, recv_desc.source_to_connect_to.p_ndi_name);
-				break;
+				return ndi_source_retry_reset(s, r);
 			}
+		}
+		r->reset_backoff_ns = 0;
+		r->next_reset_ns = 0;
+	}
+	//
+	// reset_ndi_receiver: END
+	//
 
-			if (s->config.hw_accel_enabled) {
-				//
-				// From https://docs.ndi.video/docs/sdk/performance-and-implementation#receiving-video :
-				// > * In the modern versions of NDI, there are internal heuristics that attempt to guess whether hardware
-				// > acceleration would enable better performance. That said, it is possible to explicitly enable hardware
-				// > acceleration if you believe that it would be beneficial for your application. This can be enabled by
-				// > sending an XML metadata message to a receiver as follows:
-				// >	<ndi_video_codec type="hardware"/>
-				//
-				// The wording of this says very unambiguously "it is possible to explicitly enable hardware acceleration",
-				// but this can in reality only ever be a **REQUEST** to enable. The enable could possibly fail for the
-				// obvious reason that the device may not have/support hardware acceleration.
-				//
-				// Furthermore, there is no documented way to request to *disable* hardware acceleration.
-				// I have tried setting the metadata to `<ndi_video_codec type=""/>` or `<ndi_video_codec/>` and it does not
-				// crash, but I was unable to confirm if this actually disabled hardware acceleration, and am skeptical that
-				// it could/would.
-				// So, it seems like there is no way to disable this.
-				// I have asked on the NewTek NDI SDK forum here:
-				// https://forum.vizrt.com/index.php?threads/any-way-to-explicitly-turn-off-hardware-acceleration.253766/
-				//
-				// Regardless, it makes little sense to have a checkbox that requests to enable this when
-				// checked but do nothing when unchecked.
-				// But that is basically what we are going to do here.
-				//
-				// One other way we try to mitigate this is to reset the NDI receiver when hw_accel_enabled is changed
-				// [in `ndi_source_update`]
-				// The theory is that the below `recv_send_metadata` is bound to the NDI receiver instance.
-				// Destroy that receiver instance and you also destroy the metadata and thus the hardware acceleration.
-				// There is no confirmation that this works as theorized.
-				//
-				NDIlib_metadata_frame_t hwAccelMetadata;
-				hwAccelMetadata.p_data = (char *)"<ndi_video_codec type=\"hardware\"/>";
-				obs_log(LOG_DEBUG,
-					"'%s' ndi_source_thread: reset_ndi_receiver; Sending NDI Hardware Acceleration metadata: '%s'",
-					obs_source_name, hwAccelMetadata.p_data);
-				ndiLib->recv_send_metadata(ndi_receiver, &hwAccelMetadata);
-			}
+	//
+	// reconnect_ndi_receiver: Only the NDI source name changed.
+	// Re-point the existing receiver (and its framesync) instead of destroying it;
+	// the last frame stays up until the new source delivers.
+	//
+	if (s->config.reconnect_ndi_receiver) {
+		s->config.reconnect_ndi_receiver = false;
+		bfree(r->source_name);
+		r->source_name = bstrdup(s->config.ndi_source_name);
+		recv_desc.source_to_connect_to.p_ndi_name = r->source_name;
+		obs_log(LOG_DEBUG, "'%s' ndi_source_thread: reconnect_ndi_receiver; recv_connect to '%s'",
+			obs_source_name, recv_desc.source_to_connect_to.p_ndi_name);
+		ndi_source_bw_auto_discard_pending(s, r);
+		ndiLib->recv_connect(ndi_receiver, &recv_desc.source_to_connect_to);
+		// The new sender gets the current tally and PTZ state
+		ndi_control_set_receiver(s->control, ndi_receiver);
+		timestamp_audio = 0;
+		timestamp_video = 0;
+		r->last_audio_pull_ns = 0;
+		r->audio_sample_debt = 0;
+		r->connect_backoff_ns = 0;
+		r->next_connect_check_ns = 0;
+	}
 
-			if (s->config.framesync_enabled) {
-				timestamp_audio = 0;
-				timestamp_video = 0;
-				obs_log(LOG_DEBUG,
-					"'%s' ndi_source_thread: +ndi_frame_sync = ndiLib->framesync_create(ndi_receiver)",
-					obs_source_name);
-				ndi_frame_sync = ndiLib->framesync_create(ndi_receiver);
-				obs_log(LOG_DEBUG,
-					"'%s' ndi_source_thread: -ndi_frame_sync = ndiLib->framesync_create(ndi_receiver); ndi_frame_sync=%p",
-					obs_source_name, //
-					ndi_frame_sync);
-				if (!ndi_frame_sync) {
-					obs_log(LOG_ERROR,
-						"ERR-408 - Error creating the NDI Frame Sync for '%s' for '%s'",
-						recv_desc.source_to_connect_to.p_ndi_name, obs_source_name);
-					obs_log(LOG_DEBUG,
-						"'%s' ndi_source_thread: Cannot create ndi_frame_sync for NDI source '%s'",
-						obs_source_name, recv_desc.source_to_connect_to.p_ndi_name);
-					break;
-				}
-			}
-		}
-		//
-		// reset_ndi_receiver: END
-		//
+	// Latency profile or Framesync setting change: keep the receiver, only add or remove its framesync
+	if (s->config.framesync_changed) {
+		s->config.framesync_changed = false;
+		// Starts over with a new receiver and framesync
+		if (!ndi_source_apply_framesync(s, r))
+			return ndi_source_retry_reset(s, r);
+	}
+
+	if (s->config.bandwidth == PROP_BW_AUTO && ndi_source_bw_auto_step(s, r) && !ndi_frame_sync) {
+		return NDI_RECEIVER_POOL_STEP_WORK;
+	}
 
-		//
-		// Now that we have a stable usable ndi_receiver,
-		// check if there are any connections.
-		// If not then micro-pause and restart the loop.
-		//
-		if (ndiLib->recv_get_no_connections(ndi_receiver) == 0) {
+	//
+	// Now that we have a stable usable ndi_receiver,
+	// check if there are any connections.
+	// If not then back off (exponentially, so hundreds of dead sources don't spin) and restart the loop.
+	//
+	uint64_t connect_now_ns = os_gettime_ns();
+	if (connect_now_ns < r->next_connect_check_ns || ndiLib->recv_get_no_connections(ndi_receiver) == 0) {
 #if 0
-			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: No connection; sleep and restart loop",
-				obs_source_name);
+		obs_log(LOG_DEBUG,
+			"'%s' ndi_source_thread: No connection; sleep and restart loop",
+			obs_source_name);
 #endif
-			process_empty_frame(s);
+		if (connect_now_ns >= r->next_connect_check_ns) {
+			if (r->connect_backoff_ns == 0)
+				r->connect_backoff_ns = NDI_SOURCE_CONNECT_BACKOFF_MIN_NS;
+			else
+				r->connect_backoff_ns =
+					std::min<uint64_t>(r->connect_backoff_ns * 2, NDI_SOURCE_CONNECT_BACKOFF_MAX_NS);
+			r->next_connect_check_ns = connect_now_ns + r->connect_backoff_ns;
+		}
 
-			// This will also slow down the shutdown of OBS when no NDI feed is received.
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
-			continue;
+		process_empty_frame(s);
+
+		// Pooled receivers are simply skipped until their next check; dedicated threads wait for it,
+		// unless woken early by a settings change or a stop request.
+		if (!pooled) {
+			unsigned long wait_ms =
+				(unsigned long)((r->next_connect_check_ns - connect_now_ns) / 1000000ULL) + 1;
+			os_event_timedwait(s->wake_event, wait_ms);
 		}
+		return NDI_RECEIVER_POOL_STEP_IDLE;
+	}
+	r->connect_backoff_ns = 0;
+	r->next_connect_check_ns = 0;
+
+	//
+	// Telemetry: sample the SDK's drop counters and queue depth
+	//
+	uint64_t stats_now_ns = os_gettime_ns();
+	if (stats_now_ns - r->last_stats_poll_ns >= NDI_SOURCE_STATS_POLL_NS) {
+		r->last_stats_poll_ns = stats_now_ns;
+		NDIlib_recv_performance_t perf_total;
+		NDIlib_recv_performance_t perf_dropped;
+		NDIlib_recv_queue_t queue;
+		ndiLib->recv_get_performance(ndi_receiver, &perf_total, &perf_dropped);
+		ndiLib->recv_get_queue(ndi_receiver, &queue);
+		s->stats.video_dropped = perf_dropped.video_frames;
+		s->stats.audio_dropped = perf_dropped.audio_frames;
+		s->stats.video_queue = queue.video_frames;
+		s->stats.audio_queue = queue.audio_frames;
+	}
 
+	if (ndi_frame_sync) {
 		//
-		// Change PTZ: Realtime updated from Source settings UI
+		// ndi_frame_sync
 		//
-		if (s->config.ptz.enabled) {
-			const static float tollerance = 0.001f;
-			if (fabs(s->config.ptz.pan - ptz.pan) > tollerance ||
-			    fabs(s->config.ptz.tilt - ptz.tilt) > tollerance ||
-			    fabs(s->config.ptz.zoom - ptz.zoom) > tollerance) {
-				ptz = s->config.ptz;
-				if (ndiLib->recv_ptz_is_supported(ndi_receiver)) {
-					obs_log(LOG_DEBUG,
-						"'%s' ndi_source_thread: ptz changed; Sending PTZ pan=%f, tilt=%f, zoom=%f",
-						obs_source_name, //
-						ptz.pan, ptz.tilt, ptz.zoom);
-					ndiLib->recv_ptz_pan_tilt(ndi_receiver, ptz.pan, ptz.tilt);
-					ndiLib->recv_ptz_zoom(ndi_receiver, ptz.zoom);
-				}
-			}
-		}
+		uint64_t loop_start_ns = os_gettime_ns();
 
 		//
-		// Change Tally: Enable/Disable updated from Plugin settings UI
+		// AUDIO
+		// Ask for exactly the samples that elapsed since the last pull, but never more than are queued:
+		// framesync would pad the difference with silence. Whatever is not served is owed to the next pull.
 		//
-#if 0
-		obs_log(LOG_DEBUG, "'%s' t{pre=%d,pro=%d}",
-			obs_source_name, //
-			s->config.tally2.on_preview,
-			s->config.tally2.on_program);
-#endif
-		if ((config->TallyPreviewEnabled && s->config.tally.on_preview != tally.on_preview) ||
-		    (config->TallyProgramEnabled && s->config.tally.on_program != tally.on_program)) {
-			tally.on_preview = s->config.tally.on_preview;
-			tally.on_program = s->config.tally.on_program;
-			obs_log(LOG_INFO, "'%s': Tally status : on_preview=%d, on_program=%d", obs_source_name,
-				tally.on_preview, tally.on_program);
-			obs_log(LOG_DEBUG,
-				"'%s' ndi_source_thread: tally changed; Sending tally on_preview=%d, on_program=%d",
-				obs_source_name, tally.on_preview, tally.on_program);
-			ndiLib->recv_set_tally(ndi_receiver, &tally);
+		uint64_t frame_interval_ns = obs_get_frame_interval_ns();
+		if (r->last_audio_pull_ns == 0 || loop_start_ns < r->last_audio_pull_ns)
+			r->last_audio_pull_ns = loop_start_ns - frame_interval_ns;
+		r->audio_sample_debt += (loop_start_ns - r->last_audio_pull_ns) * (uint64_t)audio_sample_rate;
+		r->last_audio_pull_ns = loop_start_ns;
+
+		int audio_samples = (int)(r->audio_sample_debt / 1000000000ULL);
+		int audio_queue_depth = ndiLib->framesync_audio_queue_depth(ndi_frame_sync);
+		if (s->config.output_delay_frames > 0 && audio_queue_depth >= 0) {
+			// Output delay: let the queue fill up to the video delay before pulling, so audio stays in
+			// sync with the delayed video instead of being output ahead of it
+			uint64_t audio_reserve = frame_interval_ns * (uint64_t)s->config.output_delay_frames *
+						 (uint64_t)audio_sample_rate / 1000000000ULL;
+			if (audio_queue_depth == 0)
+				r->audio_primed = false;
+			else if (!r->audio_primed && (uint64_t)audio_queue_depth >= audio_reserve)
+				r->audio_primed = true;
+			if (!r->audio_primed) {
+				audio_samples = 0;
+				r->audio_sample_debt = 0;
+			}
 		}
+		if (audio_queue_depth >= 0 && audio_samples > audio_queue_depth)
+			audio_samples = audio_queue_depth;
+		r->audio_sample_debt -= (uint64_t)audio_samples * 1000000000ULL;
 
-		if (ndi_frame_sync) {
-			//
-			// ndi_frame_sync
-			//
+		// Cap the debt at 100 ms so a stalled sender does not cause a burst (and latency) when it resumes.
+		uint64_t max_audio_sample_debt = (uint64_t)audio_sample_rate / 10 * 1000000000ULL;
+		if (r->audio_sample_debt > max_audio_sample_debt)
+			r->audio_sample_debt = max_audio_sample_debt;
 
-			//
-			// AUDIO
-			//
+		if (audio_samples > 0) {
 			audio_frame = {};
 			ndiLib->framesync_capture_audio_v2(
 				ndi_frame_sync, &audio_frame,
-				0,     // "The desired sample rate. 0 to get the source value."
-				0,     // "The desired channel count. 0 to get the source value."
-				1024); // "The desired sample count. 0 to get the source value."
-			// Note: "This function will always return data immediately, inserting silence if no current audio data is present."
+				0,              // "The desired sample rate. 0 to get the source value."
+				0,              // "The desired channel count. 0 to get the source value."
+				audio_samples); // "The desired sample count. 0 to get the source value."
 			if (audio_frame.p_data && (audio_frame.timestamp > timestamp_audio)) {
 				timestamp_audio = audio_frame.timestamp;
+				if (audio_frame.sample_rate > 0)
+					audio_sample_rate = audio_frame.sample_rate;
 				// obs_log(LOG_DEBUG, "%s: New Audio Frame (Framesync ON): ts=%d tc=%d", obs_source_name, audio_frame.timestamp, audio_frame.timecode);
 				ndi_source_thread_process_audio3(&s->config, &audio_frame, s->obs_source,
-								 &obs_audio_frame);
+								 &obs_audio_frame, &s->stats);
 			}
 			ndiLib->framesync_free_audio_v2(ndi_frame_sync, &audio_frame);
+		}
 
-			//
-			// VIDEO
-			//
-			video_frame = {};
+		//
+		// VIDEO
+		//
+		video_frame = {};
+		{
+			NDI_TRACE_ZONE("framesync_capture_video");
 			ndiLib->framesync_capture_video(ndi_frame_sync, &video_frame,
 							NDIlib_frame_format_type_progressive);
-			if (video_frame.p_data && (video_frame.timestamp > timestamp_video)) {
-				timestamp_video = video_frame.timestamp;
-				// obs_log(LOG_DEBUG, "%s: New Video Frame (Framesync ON): ts=%d tc=%d", obs_source_name, video_frame.timestamp, video_frame.timecode);
-				ndi_source_thread_process_video2(s, &video_frame, s->obs_source, &obs_video_frame);
+		}
+		if (video_frame.p_data && (video_frame.timestamp > timestamp_video)) {
+			timestamp_video = video_frame.timestamp;
+			// obs_log(LOG_DEBUG, "%s: New Video Frame (Framesync ON): ts=%d tc=%d", obs_source_name, video_frame.timestamp, video_frame.timecode);
+			// While the delay line fills up, the frame is held and nothing is output
+			bool output_frame = ndi_source_delay_push(s, r, &video_frame);
+			if (output_frame && s->direct_render) {
+				ndi_source_direct_park_video(s, nullptr, ndi_frame_sync, &video_frame);
+			} else if (output_frame) {
+				ndi_source_thread_process_video2(s, &video_frame, s->obs_source,
+								 &obs_video_frame);
+				ndiLib->framesync_free_video(ndi_frame_sync, &video_frame);
 			}
+		} else {
 			ndiLib->framesync_free_video(ndi_frame_sync, &video_frame);
+			// Framesync keeps repeating the last frame of a vanished sender; only new timestamps count.
+			process_empty_frame(s);
+		}
 
-			// TODO: More accurate sleep that subtracts the duration of this loop iteration?
-			std::this_thread::sleep_for(std::chrono::milliseconds(5));
-		} else {
+		//
+		// Capture once per OBS output frame, in phase with the mix, by waiting for the next video tick.
+		// If ticks stop arriving (e.g. the video thread is stalled), fall back to a deadline one frame
+		// interval after this iteration started so the loop's own duration is not added on top.
+		//
+		uint64_t deadline_ns = loop_start_ns + frame_interval_ns;
+		uint64_t now_ns = os_gettime_ns();
+		unsigned long wait_ms =
+			deadline_ns > now_ns ? (unsigned long)((deadline_ns - now_ns) / 1000000ULL) + 1 : 1;
+		if (os_event_timedwait(s->tick_event, wait_ms) == ETIMEDOUT) {
+			os_sleepto_ns(deadline_ns);
+		}
+		return NDI_RECEIVER_POOL_STEP_WORK;
+	} else {
+		//
+		// !ndi_frame_sync
+		//
+		// Pooled receivers share a worker with other sources and must never block in capture.
+		{
+			NDI_TRACE_ZONE("recv_capture_v3");
+			frame_received = ndiLib->recv_capture_v3(ndi_receiver, &video_frame,
+								 s->audio_thread_running ? nullptr : &audio_frame,
+								 nullptr, pooled ? 0 : 100);
+		}
+
+		if (frame_received == NDIlib_frame_type_audio) {
 			//
-			// !ndi_frame_sync
+			// AUDIO
 			//
-			frame_received =
-				ndiLib->recv_capture_v3(ndi_receiver, &video_frame, &audio_frame, nullptr, 100);
-
-			if (frame_received == NDIlib_frame_type_audio) {
-				//
-				// AUDIO
-				//
-				// obs_log(LOG_DEBUG, "%s: New Audio Frame (Framesync OFF): ts=%d tc=%d", obs_source_name, audio_frame.timestamp, audio_frame.timecode);
-				ndi_source_thread_process_audio3(&s->config, &audio_frame, s->obs_source,
-								 &obs_audio_frame);
+			// obs_log(LOG_DEBUG, "%s: New Audio Frame (Framesync OFF): ts=%d tc=%d", obs_source_name, audio_frame.timestamp, audio_frame.timecode);
+			ndi_source_thread_process_audio3(&s->config, &audio_frame, s->obs_source,
+							 &obs_audio_frame, &s->stats);
+
+			ndiLib->recv_free_audio_v3(ndi_receiver, &audio_frame);
+			return NDI_RECEIVER_POOL_STEP_WORK;
+		}
 
-				ndiLib->recv_free_audio_v3(ndi_receiver, &audio_frame);
-				continue;
+		if (frame_received == NDIlib_frame_type_video) {
+			//
+			// VIDEO
+			//
+			// obs_log(LOG_DEBUG, "%s: New Video Frame (Framesync OFF): ts=%d tc=%d", obs_source_name, video_frame.timestamp, video_frame.timecode);
+			if (s->direct_render) {
+				// Ownership moves to the render thread, which frees the frame after uploading it.
+				ndi_source_direct_park_video(s, ndi_receiver, nullptr, &video_frame);
+				return NDI_RECEIVER_POOL_STEP_WORK;
 			}
 
-			if (frame_received == NDIlib_frame_type_video) {
-				//
-				// VIDEO
-				//
-				// obs_log(LOG_DEBUG, "%s: New Video Frame (Framesync OFF): ts=%d tc=%d", obs_source_name, video_frame.timestamp, video_frame.timecode);
-				ndi_source_thread_process_video2(s, &video_frame, s->obs_source, &obs_video_frame);
+			ndi_source_thread_process_video2(s, &video_frame, s->obs_source, &obs_video_frame);
 
-				ndiLib->recv_free_video_v2(ndi_receiver, &video_frame);
-				continue;
-			}
+			ndiLib->recv_free_video_v2(ndi_receiver, &video_frame);
+			return NDI_RECEIVER_POOL_STEP_WORK;
+		}
 
-			if (frame_received == NDIlib_frame_type_none) {
-				process_empty_frame(s);
-			}
+		if (frame_received == NDIlib_frame_type_none) {
+			process_empty_frame(s);
 		}
 	}
-	//
-	// Main NDI receiver loop: END
-	//
 
-	if (ndi_frame_sync) {
+	return NDI_RECEIVER_POOL_STEP_IDLE;
+}
+
+void ndi_source_thread_teardown(ndi_source_t *s)
+{
+	auto r = s->receiver_state;
+	auto obs_source_name = obs_source_get_name(s->obs_source);
+
+	ndi_source_direct_drop_video(s);
+	ndi_source_audio_thread_stop(s);
+	ndi_source_bw_auto_discard_pending(s, r);
+
+	if (r->ndi_frame_sync) {
 		if (ndiLib) {
 			obs_log(LOG_DEBUG,
 				"'%s' ndi_source_thread: (out of loop) ndiLib->framesync_destroy(ndi_frame_sync)",
 				obs_source_name);
-			ndiLib->framesync_destroy(ndi_frame_sync);
+			ndi_source_delay_flush(r);
+			ndiLib->framesync_destroy(r->ndi_frame_sync);
 		}
-		ndi_frame_sync = nullptr; // TODO: Investigate if this should be put right after framesync_destroy() ?
+		r->ndi_frame_sync = nullptr;
 		obs_log(LOG_DEBUG, "'%s' ndi_source_thread: Reset NDI Frame Sync", obs_source_name);
 	}
 
-	if (ndi_receiver) {
+	if (r->ndi_receiver) {
+		ndi_control_set_receiver(s->control, nullptr);
 		if (ndiLib) {
 			obs_log(LOG_DEBUG, "'%s' ndi_source_thread: ndiLib->recv_destroy(ndi_receiver)",
 				obs_source_name);
-			ndiLib->recv_destroy(ndi_receiver);
+			ndiLib->recv_destroy(r->ndi_receiver);
 		}
 		obs_log(LOG_DEBUG, "'%s' ndi_source_thread: Reset NDI Receiver", obs_source_name);
-		ndi_receiver = nullptr;
+		r->ndi_receiver = nullptr;
+	}
+
+	bfree(r->recv_name);
+	bfree(r->source_name);
+	delete r;
+	s->receiver_state = nullptr;
+}
+
+void *ndi_source_thread(void *data)
+{
+	auto s = (ndi_source_t *)data;
+	auto obs_source_name = obs_source_get_name(s->obs_source);
+	obs_log(LOG_DEBUG, "'%s' +ndi_source_thread(…)", obs_source_name);
+
+	//
+	// Main NDI receiver loop: BEGIN
+	//
+	while (s->running) {
+		if (ndi_source_thread_step(s, false) == NDI_RECEIVER_POOL_STEP_FAILED)
+			break;
 	}
+	//
+	// Main NDI receiver loop: END
+	//
+
+	ndi_source_thread_teardown(s);
 
 	obs_log(LOG_DEBUG, "'%s' -ndi_source_thread(…)", obs_source_name);
 
@@ -754,12 +1763,15 @@ void *ndi_source_thread(void *data)
 }
 
 void ndi_source_thread_process_audio3(ndi_source_config_t *config, NDIlib_audio_frame_v3_t *ndi_audio_frame,
-				      obs_source_t *obs_source, obs_source_audio *obs_audio_frame)
+				      obs_source_t *obs_source, obs_source_audio *obs_audio_frame,
+				      ndi_source_stats_t *stats)
 {
 	if (!config->audio_enabled) {
 		return;
 	}
 
+	uint64_t process_start_ns = os_gettime_ns();
+
 	const int channelCount = ndi_audio_frame->no_channels > 8 ? 8 : ndi_audio_frame->no_channels;
 
 	obs_audio_frame->speakers = channel_count_to_layout(channelCount);
@@ -783,11 +1795,19 @@ void ndi_source_thread_process_audio3(ndi_source_config_t *config, NDIlib_audio_
 	}
 
 	obs_source_output_audio(obs_source, obs_audio_frame);
+
+	stats->audio_frames++;
+	stats->audio_process_ns += os_gettime_ns() - process_start_ns;
+	stats->audio_latency_ns = ndi_timestamp_latency_ns(ndi_audio_frame->timestamp);
 }
 
 void ndi_source_thread_process_video2(ndi_source_t *source, NDIlib_video_frame_v2_t *ndi_video_frame,
 				      obs_source *obs_source, obs_source_frame *obs_video_frame)
 {
+	NDI_TRACE_ZONE("ndi_source_thread_process_video2");
+	uint64_t process_start_ns = os_gettime_ns();
+	auto previous_format = obs_video_frame->format;
+
 	switch (ndi_video_frame->FourCC) {
 	case NDIlib_FourCC_type_BGRA:
 		obs_video_frame->format = VIDEO_FORMAT_BGRA;
@@ -815,6 +1835,13 @@ void ndi_source_thread_process_video2(ndi_source_t *source, NDIlib_video_frame_v
 		obs_video_frame->format = VIDEO_FORMAT_NV12;
 		break;
 
+	case NDIlib_FourCC_type_P216:
+	case NDIlib_FourCC_type_PA16:
+		// OBS has no async semi-planar format with alpha: PA16's trailing alpha plane is ignored here.
+		// Use the Direct GPU source type to keep it.
+		obs_video_frame->format = VIDEO_FORMAT_P216;
+		break;
+
 	default:
 		obs_log(LOG_ERROR, "ERR-430 - NDI Source uses an unsupported video pixel format: %d.",
 			ndi_video_frame->FourCC);
@@ -838,22 +1865,71 @@ void ndi_source_thread_process_video2(ndi_source_t *source, NDIlib_video_frame_v
 	source->width = ndi_video_frame->xres;
 	source->height = ndi_video_frame->yres;
 	source->last_frame_timestamp = obs_get_video_frame_time();
+	source->timeout_fired = false;
+
+	if (obs_video_frame->format != previous_format) {
+		video_format_get_parameters_for_format(config->yuv_colorspace, config->yuv_range,
+						       obs_video_frame->format, obs_video_frame->color_matrix,
+						       obs_video_frame->color_range_min,
+						       obs_video_frame->color_range_max);
+	}
 
 	obs_video_frame->width = ndi_video_frame->xres;
 	obs_video_frame->height = ndi_video_frame->yres;
 	obs_video_frame->linesize[0] = ndi_video_frame->line_stride_in_bytes;
 	obs_video_frame->data[0] = ndi_video_frame->p_data;
 
+	if (obs_video_frame->format == VIDEO_FORMAT_P216) {
+		// Interleaved UV plane follows the Y plane with the same stride
+		obs_video_frame->linesize[1] = ndi_video_frame->line_stride_in_bytes;
+		obs_video_frame->data[1] =
+			ndi_video_frame->p_data + ndi_video_frame->line_stride_in_bytes * ndi_video_frame->yres;
+	}
+
 	obs_source_output_video(obs_source, obs_video_frame);
+
+	source->stats.video_frames++;
+	source->stats.video_process_ns += os_gettime_ns() - process_start_ns;
+	source->stats.video_latency_ns = ndi_timestamp_latency_ns(ndi_video_frame->timestamp);
+}
+
+ndi_receiver_pool_step_result ndi_source_pool_step(void *data)
+{
+	return ndi_source_thread_step((ndi_source_t *)data, true);
+}
+
+bool ndi_source_use_pool(ndi_source_t *s)
+{
+	// Framesync is paced by the video tick and the audio thread needs its own receiver loop;
+	// both require a dedicated thread.
+	if (s->config.framesync_enabled || s->config.audio_thread_enabled)
+		return false;
+
+	switch (s->config.recv_thread_mode) {
+	case PROP_RECV_THREAD_POOL:
+		return true;
+	case PROP_RECV_THREAD_POOL_LOWEST:
+		return s->config.bandwidth == PROP_BW_LOWEST;
+	case PROP_RECV_THREAD_DEDICATED:
+	default:
+		return false;
+	}
 }
 
 void ndi_source_thread_start(ndi_source_t *s)
 {
 	s->config.reset_ndi_receiver = true;
+	s->receiver_state = new ndi_receiver_state_t();
+	s->receiver_state->recv_desc.allow_video_fields = true;
+	s->pooled = ndi_source_use_pool(s);
 	s->running = true;
-	pthread_create(&s->av_thread, nullptr, ndi_source_thread, s);
-	obs_log(LOG_INFO, "'Started Receiver Thread for OBS source: '%s' and NDI Source Name: %s'",
-		obs_source_get_name(s->obs_source), s->config.ndi_source_name);
+	if (s->pooled) {
+		ndi_receiver_pool_add(s, ndi_source_pool_step);
+	} else {
+		pthread_create(&s->av_thread, nullptr, ndi_source_thread, s);
+	}
+	obs_log(LOG_INFO, "'Started Receiver %s for OBS source: '%s' and NDI Source Name: %s'",
+		s->pooled ? "(shared pool)" : "Thread", obs_source_get_name(s->obs_source), s->config.ndi_source_name);
 	obs_log(LOG_DEBUG, "'%s' ndi_source_thread_start: Started A/V ndi_source_thread for NDI source '%s'",
 		obs_source_get_name(s->obs_source), s->config.ndi_source_name);
 }
@@ -862,7 +1938,16 @@ void ndi_source_thread_stop(ndi_source_t *s)
 {
 	if (s->running) {
 		s->running = false;
-		pthread_join(s->av_thread, NULL);
+		if (s->pooled) {
+			// Once removed, no pool worker touches the receiver any more; tear it down here.
+			ndi_receiver_pool_remove(s);
+			ndi_source_thread_teardown(s);
+		} else {
+			// Wake the framesync loop and any connection backoff so the stop request is seen right away.
+			os_event_signal(s->tick_event);
+			os_event_signal(s->wake_event);
+			pthread_join(s->av_thread, NULL);
+		}
 		auto obs_source = s->obs_source;
 		auto obs_source_name = obs_source_get_name(obs_source);
 		obs_log(LOG_DEBUG, "'%s' ndi_source_thread_stop: Stopped A/V ndi_source_thread for NDI source '%s'",
@@ -895,18 +1980,19 @@ void ndi_source_update(void *data, obs_data_t *settings)
 	bool reset_ndi_receiver = false;
 	// TODO : Should this ba a if statement and simplify each following check ?
 
+	// A source name change alone does not need a new receiver: it gets re-pointed with recv_connect.
 	auto new_ndi_source_name = obs_data_get_string(settings, PROP_SOURCE);
-	reset_ndi_receiver |= safe_strcmp(s->config.ndi_source_name, new_ndi_source_name) != 0;
+	bool reconnect_ndi_receiver = safe_strcmp(s->config.ndi_source_name, new_ndi_source_name) != 0;
 	obs_log(LOG_DEBUG,
 		"'%s' ndi_source_update: Check for 'NDI Source Name' changes: new_ndi_source_name='%s' vs config.ndi_source_name='%s'",
 		obs_source_name, new_ndi_source_name, s->config.ndi_source_name);
 
-	if (s->config.ndi_source_name != nullptr) {
+	// Only replaced when it changed: the receive thread copies it when it sees the reconnect request
+	if (reconnect_ndi_receiver) {
 		bfree(s->config.ndi_source_name);
+		s->config.ndi_source_name = bstrdup(new_ndi_source_name);
 	}
 
-	s->config.ndi_source_name = bstrdup(new_ndi_source_name);
-
 	auto new_bandwidth = (int)obs_data_get_int(settings, PROP_BANDWIDTH);
 	reset_ndi_receiver |= (s->config.bandwidth != new_bandwidth);
 	obs_log(LOG_DEBUG,
@@ -914,15 +2000,50 @@ void ndi_source_update(void *data, obs_data_t *settings)
 		obs_source_name, new_bandwidth, s->config.bandwidth);
 	s->config.bandwidth = new_bandwidth;
 
+	// Changing the threshold only changes which receiver gets pre-warmed; no reset needed
+	s->config.bw_auto_threshold = (int)obs_data_get_int(settings, PROP_BW_AUTO_THRESHOLD);
+	if (s->config.bandwidth == PROP_BW_AUTO && reset_ndi_receiver) {
+		// Start in the right mode instead of switching right after connecting
+		s->bw_auto_highest = obs_source_active(obs_source);
+	}
+
+	// Latency profiles set the latency mode, framesync and output delay on top of the other settings. None of
+	// them needs a new receiver: the latency mode only picks the automatic color format (the same for every
+	// profile) and OBS buffering, framesync is added to or removed from the running receiver.
+	s->config.latency_profile = (int)obs_data_get_int(settings, PROP_LATENCY_PROFILE);
 	auto new_latency = (int)obs_data_get_int(settings, PROP_LATENCY);
-	reset_ndi_receiver |= (s->config.latency != new_latency);
+	auto new_framesync_enabled = obs_data_get_bool(settings, PROP_FRAMESYNC);
+	s->config.output_delay_frames = 0;
+	switch (s->config.latency_profile) {
+	case PROP_LATENCY_PROFILE_LOWEST:
+		new_latency = PROP_LATENCY_LOWEST;
+		new_framesync_enabled = false;
+		break;
+	case PROP_LATENCY_PROFILE_SMOOTH:
+		new_latency = PROP_LATENCY_LOW;
+		new_framesync_enabled = true;
+		break;
+	case PROP_LATENCY_PROFILE_BROADCAST:
+		new_latency = PROP_LATENCY_LOW;
+		new_framesync_enabled = true;
+		s->config.output_delay_frames = (int)obs_data_get_int(settings, PROP_OUTPUT_DELAY_FRAMES);
+		break;
+	}
+
+	reset_ndi_receiver |= (s->config.latency == PROP_LATENCY_NORMAL) != (new_latency == PROP_LATENCY_NORMAL);
 	obs_log(LOG_DEBUG,
 		"'%s' ndi_source_update: Check for 'Latency' setting changes: new_latency='%d' vs config.latency='%d'",
 		obs_source_name, new_latency, s->config.latency);
 	s->config.latency = new_latency;
 
-	auto new_framesync_enabled = obs_data_get_bool(settings, PROP_FRAMESYNC);
-	reset_ndi_receiver |= (s->config.framesync_enabled != new_framesync_enabled);
+	auto new_color_format = (int)obs_data_get_int(settings, PROP_COLOR_FORMAT);
+	reset_ndi_receiver |= (s->config.color_format != new_color_format);
+	obs_log(LOG_DEBUG,
+		"'%s' ndi_source_update: Check for 'Color Format' setting changes: new_color_format='%d' vs config.color_format='%d'",
+		obs_source_name, new_color_format, s->config.color_format);
+	s->config.color_format = new_color_format;
+
+	bool framesync_changed = (s->config.framesync_enabled != new_framesync_enabled);
 	obs_log(LOG_DEBUG,
 		"'%s' ndi_source_update: Check for 'Framesync' setting changes: new_framesync_enabled='%s' vs config.framesync_enabled='%s'",
 		obs_source_name, new_framesync_enabled ? "true" : "false",
@@ -937,6 +2058,17 @@ void ndi_source_update(void *data, obs_data_t *settings)
 		s->config.hw_accel_enabled ? "true" : "false");
 	s->config.hw_accel_enabled = new_hw_accel_enabled;
 
+	auto new_audio_thread_enabled = obs_data_get_bool(settings, PROP_AUDIO_THREAD);
+	reset_ndi_receiver |= (s->config.audio_thread_enabled != new_audio_thread_enabled);
+	obs_log(LOG_DEBUG,
+		"'%s' ndi_source_update: Check for 'Audio Thread' setting changes: new_audio_thread_enabled='%s' vs config.audio_thread_enabled='%s'",
+		obs_source_name, new_audio_thread_enabled ? "true" : "false",
+		s->config.audio_thread_enabled ? "true" : "false");
+	s->config.audio_thread_enabled = new_audio_thread_enabled;
+
+	s->config.recv_thread_mode = (int)obs_data_get_int(settings, PROP_RECV_THREAD);
+	s->config.alpha_mode = (int)obs_data_get_int(settings, PROP_ALPHA_MODE);
+
 	auto new_yuv_range = prop_to_range_type((int)obs_data_get_int(settings, PROP_YUV_RANGE));
 	reset_ndi_receiver |= (s->config.yuv_range != new_yuv_range);
 	obs_log(LOG_DEBUG,
@@ -1009,6 +2141,18 @@ void ndi_source_update(void *data, obs_data_t *settings)
 	}
 
 	s->config.timeout_action = obs_data_get_int(settings, PROP_TIMEOUT);
+	s->config.timeout_ns = (uint64_t)obs_data_get_int(settings, PROP_TIMEOUT_SECONDS) * 1000000000ULL;
+
+	const char *slate_image_path = obs_data_get_string(settings, PROP_SLATE_IMAGE);
+	if (s->config.timeout_action != PROP_TIMEOUT_SLATE)
+		slate_image_path = "";
+	if (safe_strcmp(slate_image_path, s->slate_image_path) != 0) {
+		bfree(s->slate_image_path);
+		s->slate_image_path = bstrdup(slate_image_path);
+		ndi_source_load_slate(s, slate_image_path);
+	}
+	// Re-arm the timeout action so it runs once with the new settings
+	s->timeout_fired = false;
 
 	// Clean the source content when settings change unless requested otherwise.
 	// Always clean if the source is set to Audio Only.
@@ -1058,12 +2202,13 @@ void ndi_source_update(void *data, obs_data_t *settings)
 	float pan = (float)obs_data_get_double(settings, PROP_PAN);
 	float tilt = (float)obs_data_get_double(settings, PROP_TILT);
 	float zoom = (float)obs_data_get_double(settings, PROP_ZOOM);
-	s->config.ptz = ptz_t(ptz_enabled, pan, tilt, zoom);
+	ndi_control_set_ptz(s->control, ptz_enabled, pan, tilt, zoom);
 
 	// Update tally status
 	auto config = Config::Current();
 	s->config.tally.on_preview = config->TallyPreviewEnabled && obs_source_showing(obs_source);
 	s->config.tally.on_program = config->TallyProgramEnabled && obs_source_active(obs_source);
+	ndi_control_set_tally(s->control, s->config.tally.on_preview, s->config.tally.on_program);
 
 	if (strlen(s->config.ndi_source_name) == 0) {
 		obs_log(LOG_DEBUG, "'%s' ndi_source_update: No NDI Source selected; Requesting Source Thread Stop.",
@@ -1077,6 +2222,18 @@ void ndi_source_update(void *data, obs_data_t *settings)
 			// Thread is running; notify it if it needs to reset the NDI receiver
 			//
 			s->config.reset_ndi_receiver = reset_ndi_receiver;
+			s->config.reconnect_ndi_receiver = reconnect_ndi_receiver && !reset_ndi_receiver;
+			if (framesync_changed)
+				s->config.framesync_changed = true;
+			if (reset_ndi_receiver || reconnect_ndi_receiver || framesync_changed)
+				os_event_signal(s->wake_event);
+
+			if (s->pooled != ndi_source_use_pool(s)) {
+				obs_log(LOG_DEBUG, "'%s' ndi_source_update: Receive thread mode changed; Restarting.",
+					obs_source_name);
+				ndi_source_thread_stop(s);
+				ndi_source_thread_start(s);
+			}
 		} else {
 			//
 			// Thread is not running; start it if either:
@@ -1093,9 +2250,9 @@ void ndi_source_update(void *data, obs_data_t *settings)
 	}
 	// Provide all the source config when updated
 	obs_log(LOG_INFO,
-		"NDI Source Updated: '%s', 'Bandwidth'='%d', Latency='%d', Framesync='%s', HardwareAcceleration='%s', behavior='%d', timeoutmode='%d', sync_mode='%d', yuv_range='%d', yuv_colorspace='%d'",
-		s->config.ndi_source_name, s->config.bandwidth, s->config.latency,
-		s->config.framesync_enabled ? "enabled" : "disabled",
+		"NDI Source Updated: '%s', 'Bandwidth'='%d', LatencyProfile='%d', Latency='%d', Framesync='%s', OutputDelayFrames='%d', HardwareAcceleration='%s', behavior='%d', timeoutmode='%d', sync_mode='%d', yuv_range='%d', yuv_colorspace='%d'",
+		s->config.ndi_source_name, s->config.bandwidth, s->config.latency_profile, s->config.latency,
+		s->config.framesync_enabled ? "enabled" : "disabled", s->config.output_delay_frames,
 		s->config.hw_accel_enabled ? "enabled" : "disabled", s->config.behavior, s->config.timeout_action,
 		s->config.sync_mode, s->config.yuv_range, s->config.yuv_colorspace);
 
@@ -1109,6 +2266,7 @@ void ndi_source_shown(void *data)
 	auto obs_source_name = obs_source_get_name(s->obs_source);
 	obs_log(LOG_DEBUG, "'%s' ndi_source_shown(…)", obs_source_name);
 	s->config.tally.on_preview = (Config::Current())->TallyPreviewEnabled;
+	ndi_control_set_tally(s->control, s->config.tally.on_preview, s->config.tally.on_program);
 	if (!s->running) {
 		obs_log(LOG_DEBUG, "'%s' ndi_source_shown: Requesting Source Thread Start.", obs_source_name);
 		ndi_source_thread_start(s);
@@ -1122,6 +2280,7 @@ void ndi_source_hidden(void *data)
 	auto obs_source_name = obs_source_get_name(s->obs_source);
 	obs_log(LOG_DEBUG, "'%s' ndi_source_hidden(…)", obs_source_name);
 	s->config.tally.on_preview = false;
+	ndi_control_set_tally(s->control, s->config.tally.on_preview, s->config.tally.on_program);
 	if (s->running && s->config.behavior != PROP_BEHAVIOR_KEEP_ACTIVE) {
 		obs_log(LOG_DEBUG, "'%s' ndi_source_hidden: Requesting Source Thread Stop.", obs_source_name);
 		// Stopping the thread may result in `on_preview=false` not getting sent,
@@ -1136,6 +2295,7 @@ void ndi_source_activated(void *data)
 	auto obs_source_name = obs_source_get_name(s->obs_source);
 	obs_log(LOG_DEBUG, "'%s' ndi_source_activated(…)", obs_source_name);
 	s->config.tally.on_program = (Config::Current())->TallyProgramEnabled;
+	ndi_control_set_tally(s->control, s->config.tally.on_preview, s->config.tally.on_program);
 	if (!s->running) {
 		obs_log(LOG_DEBUG, "'%s' ndi_source_activated: Requesting Source Thread Start.", obs_source_name);
 		ndi_source_thread_start(s);
@@ -1147,6 +2307,83 @@ void ndi_source_deactivated(void *data)
 	auto s = (ndi_source_t *)data;
 	obs_log(LOG_DEBUG, "'%s' ndi_source_deactivated(…)", obs_source_get_name(s->obs_source));
 	s->config.tally.on_program = false;
+	ndi_control_set_tally(s->control, s->config.tally.on_preview, s->config.tally.on_program);
+}
+
+typedef struct {
+	obs_source_t *source;
+	uint32_t source_height;
+	float max_height;
+	// Studio mode preview scene, which is showing too but must not switch to highest
+	obs_source_t *preview_scene;
+} bw_auto_search_t;
+
+static bool bw_auto_search_item(obs_scene_t *, obs_sceneitem_t *item, void *param)
+{
+	auto search = (bw_auto_search_t *)param;
+	if (!obs_sceneitem_visible(item))
+		return true;
+
+	if (obs_sceneitem_is_group(item)) {
+		obs_sceneitem_group_enum_items(item, bw_auto_search_item, param);
+		return true;
+	}
+
+	if (obs_sceneitem_get_source(item) != search->source)
+		return true;
+
+	float height;
+	if (obs_sceneitem_get_bounds_type(item) != OBS_BOUNDS_NONE) {
+		struct vec2 bounds;
+		obs_sceneitem_get_bounds(item, &bounds);
+		height = bounds.y;
+	} else {
+		struct vec2 scale;
+		obs_sceneitem_get_scale(item, &scale);
+		height = (float)search->source_height * fabsf(scale.y);
+	}
+	search->max_height = std::max(search->max_height, height);
+	return true;
+}
+
+static float ndi_source_rendered_height(ndi_source_t *s)
+{
+	// Largest on-canvas height of this source across the scenes that are currently shown (e.g. in a projector),
+	// other than the studio mode preview
+	bw_auto_search_t search = {s->obs_source, s->height, 0.0f, nullptr};
+	if (obs_frontend_preview_program_mode_active())
+		search.preview_scene = obs_frontend_get_current_preview_scene();
+	obs_enum_scenes(
+		[](void *param, obs_source_t *scene_source) {
+			auto search_ = (bw_auto_search_t *)param;
+			if (scene_source != search_->preview_scene && obs_source_showing(scene_source)) {
+				obs_scene_t *scene = obs_scene_from_source(scene_source);
+				if (scene)
+					obs_scene_enum_items(scene, bw_auto_search_item, param);
+			}
+			return true;
+		},
+		&search);
+	obs_source_release(search.preview_scene);
+	return search.max_height;
+}
+
+void ndi_source_tick(void *data, float)
+{
+	auto s = (ndi_source_t *)data;
+	if (s->running && s->config.framesync_enabled)
+		os_event_signal(s->tick_event);
+
+	if (s->config.bandwidth == PROP_BW_AUTO) {
+		uint64_t now = os_gettime_ns();
+		if (now - s->bw_auto_last_check_ns >= NDI_SOURCE_BW_AUTO_CHECK_NS) {
+			s->bw_auto_last_check_ns = now;
+			// Highest on program or when rendered large outside the preview; lowest (proxy) while small or
+			// only in preview
+			s->bw_auto_highest = obs_source_active(s->obs_source) ||
+					     ndi_source_rendered_height(s) >= (float)s->config.bw_auto_threshold;
+		}
+	}
 }
 
 void new_ndi_receiver_name(const char *obs_source_name, char **ndi_receiver_name)
@@ -1171,25 +2408,64 @@ void on_ndi_source_renamed(void *data, calldata_t *)
 		s->config.ndi_receiver_name);
 }
 
-void *ndi_source_create(obs_data_t *settings, obs_source_t *obs_source)
+static void *ndi_source_create_internal(obs_data_t *settings, obs_source_t *obs_source, bool direct_render)
 {
 	auto obs_source_name = obs_source_get_name(obs_source);
 	obs_log(LOG_DEBUG, "'%s' +ndi_source_create(…)", obs_source_name);
 
 	auto s = (ndi_source_t *)bzalloc(sizeof(ndi_source_t));
 	s->obs_source = obs_source;
+	os_event_init(&s->tick_event, OS_EVENT_TYPE_AUTO);
+	os_event_init(&s->wake_event, OS_EVENT_TYPE_AUTO);
+	s->control = ndi_control_create(obs_source);
+
+	s->direct_render = direct_render;
+	s->direct_shown = -1;
+	pthread_mutex_init(&s->direct_mutex, nullptr);
+	pthread_mutex_init(&s->slate_mutex, nullptr);
+	if (direct_render) {
+		char *effect_path = obs_module_file("effects/ndi-decode.effect");
+		obs_enter_graphics();
+		s->direct_effect = gs_effect_create_from_file(effect_path, nullptr);
+		obs_leave_graphics();
+		bfree(effect_path);
+		if (!s->direct_effect) {
+			obs_log(LOG_ERROR, "ERR-431 - Error loading the NDI decode effect for '%s'", obs_source_name);
+		}
+	}
 	new_ndi_receiver_name(obs_source_name, &(s->config.ndi_receiver_name));
 
 	auto sh = obs_source_get_signal_handler(s->obs_source);
 	signal_handler_connect(sh, "rename", on_ndi_source_renamed, s);
 
+	auto ph = obs_source_get_proc_handler(s->obs_source);
+	proc_handler_add(ph,
+			 "void get_stats(out int video_frames, out int video_dropped, out int video_queue, "
+			 "out float video_process_ms, out float video_latency_ms, "
+			 "out int audio_frames, out int audio_dropped, out int audio_queue, "
+			 "out float audio_process_ms, out float audio_latency_ms)",
+			 ndi_source_get_stats_proc, s);
+
 	ndi_source_update(s, settings);
 
+	NDIFinder::addListener(s,
+			       [s](const std::vector<std::string> &) { obs_source_update_properties(s->obs_source); });
+
 	obs_log(LOG_DEBUG, "'%s' -ndi_source_create(…)", obs_source_name);
 
 	return s;
 }
 
+void *ndi_source_create(obs_data_t *settings, obs_source_t *obs_source)
+{
+	return ndi_source_create_internal(settings, obs_source, false);
+}
+
+void *ndi_source_direct_create(obs_data_t *settings, obs_source_t *obs_source)
+{
+	return ndi_source_create_internal(settings, obs_source, true);
+}
+
 void ndi_source_destroy(void *data)
 {
 	auto s = (ndi_source_t *)data;
@@ -1198,8 +2474,32 @@ void ndi_source_destroy(void *data)
 
 	auto sh = obs_source_get_signal_handler(s->obs_source);
 	signal_handler_disconnect(sh, "rename", on_ndi_source_renamed, s);
+	NDIFinder::removeListener(s);
 
 	ndi_source_thread_stop(s);
+	ndi_control_destroy(s->control);
+
+	os_event_destroy(s->tick_event);
+	os_event_destroy(s->wake_event);
+
+	if (s->direct_render) {
+		obs_enter_graphics();
+		for (auto &slot : s->direct_slots) {
+			// The receive thread is stopped, so no slot is being written
+			for (int i = 0; i < 3; i++) {
+				if (slot.mapped_data[i])
+					gs_texture_unmap(slot.textures[i]);
+				gs_texture_destroy(slot.textures[i]);
+			}
+		}
+		gs_effect_destroy(s->direct_effect);
+		obs_leave_graphics();
+	}
+	pthread_mutex_destroy(&s->direct_mutex);
+
+	ndi_source_load_slate(s, nullptr);
+	pthread_mutex_destroy(&s->slate_mutex);
+	bfree(s->slate_image_path);
 
 	if (s->config.ndi_receiver_name) {
 		bfree(s->config.ndi_receiver_name);
@@ -1228,6 +2528,242 @@ uint32_t ndi_source_get_height(void *data)
 	return s->height;
 }
 
+static void ndi_source_direct_unmap(ndi_direct_slot_t *slot)
+{
+	for (int i = 0; i < 3; i++) {
+		if (slot->mapped_data[i])
+			gs_texture_unmap(slot->textures[i]);
+		slot->mapped_data[i] = nullptr;
+	}
+}
+
+// Recreate the slot's textures when the frame layout changed
+static bool ndi_source_direct_prepare_slot(ndi_direct_slot_t *slot, const NDIlib_video_frame_v2_t *video_frame,
+					   const ndi_direct_plane_t planes[3])
+{
+	slot->fourcc = video_frame->FourCC;
+	slot->width = video_frame->xres;
+	slot->height = video_frame->yres;
+	for (int i = 0; i < 3; i++) {
+		auto &texture = slot->textures[i];
+		if (planes[i].format == GS_UNKNOWN) {
+			gs_texture_destroy(texture);
+			texture = nullptr;
+			continue;
+		}
+		if (!texture || gs_texture_get_width(texture) != planes[i].width ||
+		    gs_texture_get_height(texture) != planes[i].height ||
+		    gs_texture_get_color_format(texture) != planes[i].format) {
+			gs_texture_destroy(texture);
+			texture = gs_texture_create(planes[i].width, planes[i].height, planes[i].format, 1, nullptr,
+						    GS_DYNAMIC);
+			if (!texture)
+				return false;
+		}
+	}
+	return true;
+}
+
+static ndi_direct_slot_t *ndi_source_direct_idle_slot(ndi_source_t *s)
+{
+	for (int i = 0; i < NDI_SOURCE_DIRECT_SLOTS; i++) {
+		if (i != s->direct_shown && s->direct_slots[i].state == NDI_DIRECT_SLOT_IDLE)
+			return &s->direct_slots[i];
+	}
+	return nullptr;
+}
+
+static void ndi_source_direct_show(ndi_source_t *s, ndi_direct_slot_t *slot)
+{
+	slot->state = NDI_DIRECT_SLOT_IDLE;
+	s->direct_shown = (int)(slot - s->direct_slots);
+}
+
+/**
+ * Graphics thread, under direct_mutex: show the newest frame (written by the receive thread, or parked and
+ * uploaded here), then map a texture set in its layout for the receive thread to write the next one into.
+ */
+static void ndi_source_direct_update_slots(ndi_source_t *s)
+{
+	NDI_TRACE_ZONE("ndi_source_direct_upload");
+
+	for (auto &slot : s->direct_slots) {
+		if (slot.state == NDI_DIRECT_SLOT_FILLED) {
+			ndi_source_direct_unmap(&slot);
+			ndi_source_direct_show(s, &slot);
+		}
+	}
+
+	if (s->direct_frame_pending) {
+		ndi_direct_plane_t planes[3];
+		ndi_direct_slot_t *slot = ndi_source_direct_idle_slot(s);
+		if (!ndi_source_direct_planes(&s->direct_frame, planes)) {
+			obs_log(LOG_ERROR, "ERR-430 - NDI Source uses an unsupported video pixel format: %d.",
+				s->direct_frame.FourCC);
+		} else if (slot && ndi_source_direct_prepare_slot(slot, &s->direct_frame, planes)) {
+			for (int i = 0; i < 3; i++) {
+				if (planes[i].format != GS_UNKNOWN)
+					gs_texture_set_image(slot->textures[i], planes[i].data, planes[i].linesize,
+							     false);
+			}
+			ndi_source_direct_show(s, slot);
+		}
+		ndi_source_free_video(s->direct_frame_receiver, s->direct_frame_sync, &s->direct_frame);
+		s->direct_frame_pending = false;
+	}
+
+	if (s->direct_shown < 0)
+		return;
+
+	// Only one set is offered to the receive thread, in the layout of the shown frame
+	const ndi_direct_slot_t *shown = &s->direct_slots[s->direct_shown];
+	for (auto &slot : s->direct_slots) {
+		if (slot.state == NDI_DIRECT_SLOT_WRITING)
+			return;
+		if (slot.state != NDI_DIRECT_SLOT_MAPPED)
+			continue;
+		if (slot.fourcc == shown->fourcc && slot.width == shown->width && slot.height == shown->height)
+			return;
+		ndi_source_direct_unmap(&slot);
+		slot.state = NDI_DIRECT_SLOT_IDLE;
+	}
+
+	ndi_direct_slot_t *slot = ndi_source_direct_idle_slot(s);
+	if (!slot)
+		return;
+
+	NDIlib_video_frame_v2_t layout = {};
+	layout.FourCC = shown->fourcc;
+	layout.xres = shown->width;
+	layout.yres = shown->height;
+	// Only the texture sizes and formats are used; the mapped pitch is what the receive thread writes with
+	layout.line_stride_in_bytes = shown->width * 4;
+	ndi_direct_plane_t planes[3];
+	if (!ndi_source_direct_planes(&layout, planes) || !ndi_source_direct_prepare_slot(slot, &layout, planes))
+		return;
+	for (int i = 0; i < 3; i++) {
+		if (slot->textures[i] &&
+		    !gs_texture_map(slot->textures[i], &slot->mapped_data[i], &slot->mapped_linesize[i])) {
+			slot->mapped_data[i] = nullptr;
+			ndi_source_direct_unmap(slot);
+			return;
+		}
+	}
+	slot->state = NDI_DIRECT_SLOT_MAPPED;
+}
+
+void ndi_source_direct_render(void *data, gs_effect_t *)
+{
+	auto s = (ndi_source_t *)data;
+
+	pthread_mutex_lock(&s->direct_mutex);
+	ndi_source_direct_update_slots(s);
+	pthread_mutex_unlock(&s->direct_mutex);
+
+	if (s->slate_active && s->direct_effect) {
+		pthread_mutex_lock(&s->slate_mutex);
+		if (s->slate_image.loaded && !s->slate_image.texture)
+			gs_image_file_init_texture(&s->slate_image);
+		if (s->slate_image.texture) {
+			gs_effect_set_texture(gs_effect_get_param_by_name(s->direct_effect, "image"),
+					      s->slate_image.texture);
+			gs_effect_set_float(gs_effect_get_param_by_name(s->direct_effect, "alpha_mode"),
+					    (float)PROP_ALPHA_MODE_NONE);
+			while (gs_effect_loop(s->direct_effect, "DrawRGB")) {
+				gs_draw_sprite(s->slate_image.texture, 0, s->slate_image.cx, s->slate_image.cy);
+			}
+		}
+		pthread_mutex_unlock(&s->slate_mutex);
+		return;
+	}
+
+	if (s->direct_shown < 0 || !s->direct_effect || s->width == 0 || s->height == 0)
+		return;
+
+	// Only this thread changes the shown slot and its textures
+	const ndi_direct_slot_t *shown = &s->direct_slots[s->direct_shown];
+	uint32_t width = shown->width;
+	uint32_t height = shown->height;
+
+	const char *technique;
+	enum video_format yuv_format = VIDEO_FORMAT_NONE;
+	switch (shown->fourcc) {
+	case NDIlib_FourCC_type_UYVY:
+		technique = "DecodeUYVY";
+		yuv_format = VIDEO_FORMAT_UYVY;
+		break;
+	case NDIlib_FourCC_type_UYVA:
+		technique = "DecodeUYVA";
+		yuv_format = VIDEO_FORMAT_UYVY;
+		break;
+	case NDIlib_FourCC_type_P216:
+		technique = "DecodeP216";
+		yuv_format = VIDEO_FORMAT_P216;
+		break;
+	case NDIlib_FourCC_type_PA16:
+		technique = "DecodePA16";
+		yuv_format = VIDEO_FORMAT_P216;
+		break;
+	case NDIlib_FourCC_type_NV12:
+		technique = "DecodeNV12";
+		yuv_format = VIDEO_FORMAT_NV12;
+		break;
+	case NDIlib_FourCC_type_I420:
+		technique = "DecodeI420";
+		yuv_format = VIDEO_FORMAT_I420;
+		break;
+	default:
+		technique = "DrawRGB";
+		break;
+	}
+
+	if (yuv_format != VIDEO_FORMAT_NONE) {
+		float color_matrix[16];
+		float color_range_min[3];
+		float color_range_max[3];
+		video_format_get_parameters_for_format(s->config.yuv_colorspace, s->config.yuv_range, yuv_format,
+						       color_matrix, color_range_min, color_range_max);
+		gs_effect_set_val(gs_effect_get_param_by_name(s->direct_effect, "color_matrix"), color_matrix,
+				  sizeof(color_matrix));
+		gs_effect_set_val(gs_effect_get_param_by_name(s->direct_effect, "color_range_min"), color_range_min,
+				  sizeof(color_range_min));
+		gs_effect_set_val(gs_effect_get_param_by_name(s->direct_effect, "color_range_max"), color_range_max,
+				  sizeof(color_range_max));
+
+		struct vec2 frame_size;
+		vec2_set(&frame_size, (float)width, (float)height);
+		gs_effect_set_vec2(gs_effect_get_param_by_name(s->direct_effect, "frame_size"), &frame_size);
+	}
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(s->direct_effect, "image"), shown->textures[0]);
+	gs_effect_set_texture(gs_effect_get_param_by_name(s->direct_effect, "image_uv"), shown->textures[1]);
+	gs_effect_set_texture(gs_effect_get_param_by_name(s->direct_effect, "image_alpha"), shown->textures[2]);
+	gs_effect_set_texture(gs_effect_get_param_by_name(s->direct_effect, "image_v"), shown->textures[2]);
+	gs_effect_set_float(gs_effect_get_param_by_name(s->direct_effect, "alpha_mode"), (float)s->config.alpha_mode);
+
+	while (gs_effect_loop(s->direct_effect, technique)) {
+		gs_draw_sprite(shown->textures[0], 0, width, height);
+	}
+}
+
+const char *ndi_source_direct_getname(void *)
+{
+	return obs_module_text("NDIPlugin.NDISourceDirectName");
+}
+
+void ndi_source_set_tile_settings(obs_data_t *settings, const char *ndi_source_name)
+{
+	// A monitoring tile: lowest bandwidth, no audio, and received on the shared pool (which framesync and the
+	// audio thread would prevent)
+	obs_data_set_string(settings, PROP_SOURCE, ndi_source_name);
+	obs_data_set_int(settings, PROP_BANDWIDTH, PROP_BW_LOWEST);
+	obs_data_set_bool(settings, PROP_AUDIO, false);
+	obs_data_set_bool(settings, PROP_AUDIO_THREAD, false);
+	obs_data_set_bool(settings, PROP_FRAMESYNC, false);
+	obs_data_set_int(settings, PROP_LATENCY_PROFILE, PROP_LATENCY_PROFILE_CUSTOM);
+	obs_data_set_int(settings, PROP_RECV_THREAD, PROP_RECV_THREAD_POOL);
+}
+
 obs_source_info create_ndi_source_info()
 {
 	// https://docs.obsproject.com/reference-sources#source-definition-structure-obs-source-info
@@ -1247,9 +2783,26 @@ obs_source_info create_ndi_source_info()
 	ndi_source_info.hide = ndi_source_hidden;
 	ndi_source_info.deactivate = ndi_source_deactivated;
 	ndi_source_info.destroy = ndi_source_destroy;
+	ndi_source_info.video_tick = ndi_source_tick;
 
 	ndi_source_info.get_width = ndi_source_get_width;
 	ndi_source_info.get_height = ndi_source_get_height;
 
 	return ndi_source_info;
 }
+
+obs_source_info create_ndi_source_direct_info()
+{
+	// Same receiver as "ndi_source", but rendered synchronously:
+	// NDI frames are uploaded straight to a texture instead of being copied through the OBS async frame cache.
+	obs_source_info ndi_source_direct_info = create_ndi_source_info();
+	ndi_source_direct_info.id = "ndi_source_direct";
+	ndi_source_direct_info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_AUDIO |
+					      OBS_SOURCE_DO_NOT_DUPLICATE;
+
+	ndi_source_direct_info.get_name = ndi_source_direct_getname;
+	ndi_source_direct_info.create = ndi_source_direct_create;
+	ndi_source_direct_info.video_render = ndi_source_direct_render;
+
+	return ndi_source_direct_info;
+}
@@ -0,0 +1,184 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-stripe-pool.h"
+
+#include "plugin-main.h"
+#include "ndi-trace.h"
+
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Below this many rows per stripe, waking another thread costs more than it saves
+#define NDI_STRIPE_POOL_MIN_ROWS 64
+#define NDI_STRIPE_POOL_MAX_WORKERS 15
+
+typedef struct {
+	pthread_t thread;
+	os_event_t *start_event;
+	uint32_t stripe;
+} stripe_worker_t;
+
+static struct {
+	// Held by the frame being processed
+	pthread_mutex_t job_mutex = PTHREAD_MUTEX_INITIALIZER;
+	// Guards start/shutdown
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	volatile bool running = false;
+	std::vector<stripe_worker_t *> workers;
+	os_event_t *done_event = nullptr;
+	std::atomic<int> pending{0};
+
+	ndi_stripe_function_t function = nullptr;
+	void *data = nullptr;
+	uint32_t height = 0;
+	uint32_t stripe_count = 0;
+} pool;
+
+static void stripe_bounds(uint32_t stripe, uint32_t *start_y, uint32_t *end_y)
+{
+	auto bound = [](uint32_t index) {
+		if (index >= pool.stripe_count)
+			return pool.height;
+		return (uint32_t)((uint64_t)pool.height * index / pool.stripe_count) & ~1u;
+	};
+	*start_y = bound(stripe);
+	*end_y = bound(stripe + 1);
+}
+
+static void *stripe_worker_thread(void *data)
+{
+	auto worker = (stripe_worker_t *)data;
+	os_set_thread_name("distroav-stripe-pool");
+
+	while (true) {
+		os_event_wait(worker->start_event);
+		if (!pool.running)
+			break;
+
+		uint32_t start_y, end_y;
+		stripe_bounds(worker->stripe, &start_y, &end_y);
+		pool.function(pool.data, start_y, end_y);
+
+		if (--pool.pending == 0)
+			os_event_signal(pool.done_event);
+	}
+
+	return nullptr;
+}
+
+static bool pool_ensure_started()
+{
+	pthread_mutex_lock(&pool.mutex);
+	if (!pool.running) {
+		int worker_count = std::clamp(os_get_logical_cores() - 1, 0, NDI_STRIPE_POOL_MAX_WORKERS);
+		obs_log(LOG_DEBUG, "ndi_stripe_pool: starting %d worker threads", worker_count);
+
+		os_event_init(&pool.done_event, OS_EVENT_TYPE_AUTO);
+		pool.running = true;
+		for (int i = 0; i < worker_count; i++) {
+			auto worker = new stripe_worker_t();
+			worker->stripe = (uint32_t)i + 1; // Stripe 0 runs on the calling thread
+			os_event_init(&worker->start_event, OS_EVENT_TYPE_AUTO);
+			pthread_create(&worker->thread, nullptr, stripe_worker_thread, worker);
+			pool.workers.push_back(worker);
+		}
+	}
+	bool has_workers = !pool.workers.empty();
+	pthread_mutex_unlock(&pool.mutex);
+	return has_workers;
+}
+
+void ndi_stripe_pool_run(ndi_stripe_function_t function, void *data, uint32_t height)
+{
+	if (height < NDI_STRIPE_POOL_MIN_ROWS * 2 || pthread_mutex_trylock(&pool.job_mutex) != 0) {
+		function(data, 0, height);
+		return;
+	}
+
+	if (!pool_ensure_started()) {
+		pthread_mutex_unlock(&pool.job_mutex);
+		function(data, 0, height);
+		return;
+	}
+
+	pool.function = function;
+	pool.data = data;
+	pool.height = height;
+	pool.stripe_count = std::min((uint32_t)pool.workers.size() + 1, height / NDI_STRIPE_POOL_MIN_ROWS);
+	pool.pending = (int)pool.stripe_count - 1;
+
+	for (uint32_t i = 0; i + 1 < pool.stripe_count; i++)
+		os_event_signal(pool.workers[i]->start_event);
+
+	uint32_t start_y, end_y;
+	stripe_bounds(0, &start_y, &end_y);
+	function(data, start_y, end_y);
+
+	// Barrier: the frame is complete once every worker has finished its stripe
+	if (pool.stripe_count > 1)
+		os_event_wait(pool.done_event);
+
+	pthread_mutex_unlock(&pool.job_mutex);
+}
+
+typedef struct {
+	uyvy_conv_function function;
+	uint8_t **input;
+	uint32_t *in_linesize;
+	uint8_t **output;
+	uint32_t *out_linesize;
+} stripe_convert_job_t;
+
+static void stripe_convert(void *data, uint32_t start_y, uint32_t end_y)
+{
+	auto job = (stripe_convert_job_t *)data;
+	job->function(job->input, job->in_linesize, start_y, end_y, job->output, job->out_linesize);
+}
+
+void ndi_stripe_pool_convert(uyvy_conv_function function, uint8_t *input[], uint32_t in_linesize[], uint32_t height,
+			     uint8_t *output[], uint32_t out_linesize[])
+{
+	NDI_TRACE_ZONE("ndi_stripe_pool_convert");
+	stripe_convert_job_t job = {function, input, in_linesize, output, out_linesize};
+	ndi_stripe_pool_run(stripe_convert, &job, height);
+}
+
+void ndi_stripe_pool_shutdown()
+{
+	pthread_mutex_lock(&pool.job_mutex);
+	pthread_mutex_lock(&pool.mutex);
+	if (pool.running) {
+		pool.running = false;
+		for (auto worker : pool.workers) {
+			os_event_signal(worker->start_event);
+			pthread_join(worker->thread, nullptr);
+			os_event_destroy(worker->start_event);
+			delete worker;
+		}
+		pool.workers.clear();
+		os_event_destroy(pool.done_event);
+		pool.done_event = nullptr;
+		obs_log(LOG_DEBUG, "ndi_stripe_pool: stopped");
+	}
+	pthread_mutex_unlock(&pool.mutex);
+	pthread_mutex_unlock(&pool.job_mutex);
+}
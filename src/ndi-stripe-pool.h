@@ -0,0 +1,52 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include "ndi-color-convert.h"
+
+/**
+ * Stripe pool: runs a per-row job (typically a colour conversion) in horizontal stripes across a small set
+ * of persistent worker threads, the calling thread taking one stripe, and returns once every stripe is done.
+ * One frame is processed at a time; a caller that finds the pool busy runs its job inline instead of waiting.
+ */
+
+/**
+ * Process rows [start_y, end_y) of a job.
+ * Stripe boundaries are even, so 4:2:0 chroma rows are never split.
+ */
+typedef void (*ndi_stripe_function_t)(void *data, uint32_t start_y, uint32_t end_y);
+
+/**
+ * Run a job over all rows, starting the worker threads on first use.
+ * @param function Row range function, called concurrently for disjoint stripes
+ * @param data Opaque job context passed to function
+ * @param height Number of rows
+ */
+void ndi_stripe_pool_run(ndi_stripe_function_t function, void *data, uint32_t height);
+
+/**
+ * Run a colour conversion over a whole frame in stripes.
+ * Same parameters as uyvy_conv_function, for rows [0, height).
+ */
+void ndi_stripe_pool_convert(uyvy_conv_function function, uint8_t *input[], uint32_t in_linesize[], uint32_t height,
+			     uint8_t *output[], uint32_t out_linesize[]);
+
+/**
+ * Stop all pool worker threads. Called on module unload.
+ */
+void ndi_stripe_pool_shutdown();
@@ -0,0 +1,136 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ndi-trace.h"
+
+#include "plugin-support.h"
+
+#include <util/base.h>
+#include <util/threading.h>
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+// Zones kept per thread (24 bytes each), later ones are counted as dropped
+#define NDI_TRACE_MAX_EVENTS_PER_THREAD (1 << 20)
+
+typedef struct {
+	const char *name;
+	uint64_t start_ns;
+	uint64_t end_ns;
+} ndi_trace_event_t;
+
+// Threads only contend for their own buffer with the writer, at shutdown
+typedef struct {
+	pthread_mutex_t mutex;
+	int tid;
+	std::vector<ndi_trace_event_t> events;
+	uint64_t dropped;
+} ndi_trace_thread_t;
+
+std::atomic<bool> ndi_trace_recording{false};
+
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Never freed: the threads keep a pointer to their buffer for as long as they live
+static std::vector<ndi_trace_thread_t *> trace_threads;
+static std::string trace_path;
+static uint64_t trace_start_ns = 0;
+
+static ndi_trace_thread_t *ndi_trace_current_thread()
+{
+	static thread_local ndi_trace_thread_t *thread = nullptr;
+	if (thread)
+		return thread;
+
+	thread = new ndi_trace_thread_t();
+	pthread_mutex_init(&thread->mutex, nullptr);
+	pthread_mutex_lock(&trace_mutex);
+	trace_threads.push_back(thread);
+	thread->tid = (int)trace_threads.size();
+	pthread_mutex_unlock(&trace_mutex);
+	return thread;
+}
+
+void ndi_trace_record(const char *name, uint64_t start_ns, uint64_t end_ns)
+{
+	ndi_trace_thread_t *thread = ndi_trace_current_thread();
+	pthread_mutex_lock(&thread->mutex);
+	if (thread->events.size() < NDI_TRACE_MAX_EVENTS_PER_THREAD)
+		thread->events.push_back({name, start_ns, end_ns});
+	else
+		thread->dropped++;
+	pthread_mutex_unlock(&thread->mutex);
+}
+
+void ndi_trace_init(const char *path)
+{
+#ifdef NDI_TRACE_TRACY
+	UNUSED_PARAMETER(path);
+	obs_log(LOG_INFO, "ndi_trace: timing zones are sent to Tracy");
+#else
+	if (!path || !path[0])
+		return;
+
+	trace_path = path;
+	trace_start_ns = os_gettime_ns();
+	ndi_trace_recording = true;
+	obs_log(LOG_INFO, "ndi_trace: recording timing zones to '%s'", path);
+#endif
+}
+
+void ndi_trace_shutdown()
+{
+	if (!ndi_trace_recording.exchange(false))
+		return;
+
+	FILE *file = os_fopen(trace_path.c_str(), "wb");
+	if (!file) {
+		obs_log(LOG_WARNING, "WARN-433 - Cannot write the trace file '%s'", trace_path.c_str());
+		return;
+	}
+
+	// Chrome trace event format: complete events ("X") with microsecond timestamps
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+	bool first = true;
+	size_t written = 0;
+	uint64_t dropped = 0;
+	pthread_mutex_lock(&trace_mutex);
+	for (ndi_trace_thread_t *thread : trace_threads) {
+		pthread_mutex_lock(&thread->mutex);
+		for (const auto &event : thread->events) {
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				first ? "" : ",\n", event.name, thread->tid,
+				(double)(event.start_ns - trace_start_ns) / 1000.0,
+				(double)(event.end_ns - event.start_ns) / 1000.0);
+			first = false;
+		}
+		written += thread->events.size();
+		dropped += thread->dropped;
+		thread->events.clear();
+		thread->events.shrink_to_fit();
+		thread->dropped = 0;
+		pthread_mutex_unlock(&thread->mutex);
+	}
+	pthread_mutex_unlock(&trace_mutex);
+	fputs("\n]}\n", file);
+	fclose(file);
+
+	obs_log(LOG_INFO, "ndi_trace: wrote %zu zones to '%s' (%llu dropped)", written, trace_path.c_str(),
+		(unsigned long long)dropped);
+}
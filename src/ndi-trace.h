@@ -0,0 +1,84 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <util/platform.h>
+
+#include <atomic>
+
+/**
+ * Opt-in timing zones around the receive, render, readback and send paths, to tell whether a dropped frame
+ * came from the network receive, the GPU readback or the NDI send.
+ * Built with ENABLE_TRACY, the zones are Tracy zones. Otherwise they are recorded only when OBS is started with
+ * `--distroav-trace=<file>`, and written to that file as a Chrome trace (chrome://tracing, Perfetto) on unload.
+ */
+
+#define NDI_TRACE_CONCAT_(a, b) a##b
+#define NDI_TRACE_CONCAT(a, b) NDI_TRACE_CONCAT_(a, b)
+
+#ifdef NDI_TRACE_TRACY
+#include <tracy/Tracy.hpp>
+#define NDI_TRACE_ZONE(name) ZoneNamedN(NDI_TRACE_CONCAT(ndi_trace_zone_, __LINE__), name, true)
+#else
+/**
+ * Time the rest of the enclosing scope as a zone.
+ * @param name Zone name, a string literal
+ */
+#define NDI_TRACE_ZONE(name) ndi_trace_zone NDI_TRACE_CONCAT(ndi_trace_zone_, __LINE__)(name)
+#endif
+
+/**
+ * Start recording zones, to be written to path by ndi_trace_shutdown.
+ * @param path Chrome trace file, nullptr or empty to record nothing (always the case with Tracy)
+ */
+void ndi_trace_init(const char *path);
+
+/**
+ * Stop recording and write the trace. Call on module unload, once the sources and outputs are gone.
+ */
+void ndi_trace_shutdown();
+
+extern std::atomic<bool> ndi_trace_recording;
+
+/**
+ * Record a zone of the calling thread.
+ * @param name Zone name, which must outlive the trace (a string literal)
+ */
+void ndi_trace_record(const char *name, uint64_t start_ns, uint64_t end_ns);
+
+class ndi_trace_zone {
+public:
+	explicit ndi_trace_zone(const char *name)
+		: name(ndi_trace_recording.load(std::memory_order_relaxed) ? name : nullptr),
+		  start_ns(this->name ? os_gettime_ns() : 0)
+	{
+	}
+
+	~ndi_trace_zone()
+	{
+		if (name)
+			ndi_trace_record(name, start_ns, os_gettime_ns());
+	}
+
+	ndi_trace_zone(const ndi_trace_zone &) = delete;
+	ndi_trace_zone &operator=(const ndi_trace_zone &) = delete;
+
+private:
+	const char *name;
+	uint64_t start_ns;
+};
@@ -16,9 +16,26 @@
 ******************************************************************************/
 
 #include "ndi-video-converter.h"
+#include "ndi-buffer-pool.h"
+#include "plugin-support.h"
 #include <util/bmem.h>
+#include <util/threading.h>
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 
+// Per-frame tracing stays out of release builds; with NDI_CONVERTER_TRACE defined it is printed at
+// --distroav-log=verbose only.
+#ifdef NDI_CONVERTER_TRACE
+#define converter_trace(...)                                            \
+	do {                                                            \
+		if (LOG_LEVEL >= LOG_VERBOSE)                           \
+			blog(LOG_INFO, "[ndi-converter] " __VA_ARGS__); \
+	} while (0)
+#else
+#define converter_trace(...) ((void)0)
+#endif
+
 // Property names
 #define PROP_ENABLE_CUSTOM_RES "enable_custom_resolution"
 #define PROP_RESOLUTION_MODE "resolution_mode"
@@ -34,6 +51,7 @@
 #define PROP_FRAMERATE_MODE "framerate_mode"
 #define PROP_CUSTOM_FPS_NUM "custom_fps_num"
 #define PROP_CUSTOM_FPS_DEN "custom_fps_den"
+#define PROP_FRAME_BLEND "frame_blend"
 
 void ndi_converter_init(ndi_video_converter_t *converter)
 {
@@ -165,18 +183,23 @@ void ndi_converter_update(ndi_video_converter_t *converter, obs_data_t *settings
 	converter->crop_width = (uint32_t)obs_data_get_int(settings, PROP_CROP_WIDTH);
 	converter->crop_height = (uint32_t)obs_data_get_int(settings, PROP_CROP_HEIGHT);
 
-	// Validate crop values (0 means use full dimensions, validated in render)
+	// Validate crop values (0 means use full dimensions, clamped to the source in ndi_converter_update_region)
 	if (converter->crop_left < 0)
 		converter->crop_left = 0;
 	if (converter->crop_top < 0)
 		converter->crop_top = 0;
 	// Allow 0 for width/height (means use full dimensions)
 
+	// Force the render region to be recomputed
+	converter->region_source_width = 0;
+	converter->region_source_height = 0;
+
 	// Frame rate settings
 	converter->enable_custom_framerate = obs_data_get_bool(settings, PROP_ENABLE_CUSTOM_FPS);
 	converter->framerate_mode = (enum ndi_framerate_mode)obs_data_get_int(settings, PROP_FRAMERATE_MODE);
 	converter->custom_fps_num = (uint32_t)obs_data_get_int(settings, PROP_CUSTOM_FPS_NUM);
 	converter->custom_fps_den = (uint32_t)obs_data_get_int(settings, PROP_CUSTOM_FPS_DEN);
+	converter->frame_blend = obs_data_get_bool(settings, PROP_FRAME_BLEND);
 
 	// Validate custom frame rate
 	if (converter->custom_fps_num < 1)
@@ -205,6 +228,7 @@ void ndi_converter_update(ndi_video_converter_t *converter, obs_data_t *settings
 		// Reset accumulator when settings change
 		converter->accumulator_ns = 0;
 		converter->last_frame_timestamp = 0;
+		converter->last_frame_delta_ns = 0;
 	} else {
 		converter->target_fps_num = 0;
 		converter->target_fps_den = 0;
@@ -212,21 +236,121 @@ void ndi_converter_update(ndi_video_converter_t *converter, obs_data_t *settings
 	}
 }
 
+void ndi_converter_set_output_settings(obs_data_t *settings, const char *resolution, const char *framerate)
+{
+	unsigned int width = 0;
+	unsigned int height = 0;
+	bool custom_resolution = resolution && sscanf(resolution, "%ux%u", &width, &height) == 2 && width && height;
+	obs_data_set_bool(settings, PROP_ENABLE_CUSTOM_RES, custom_resolution);
+	obs_data_set_int(settings, PROP_RESOLUTION_MODE, NDI_RESOLUTION_CUSTOM);
+	obs_data_set_int(settings, PROP_CUSTOM_WIDTH, width);
+	obs_data_set_int(settings, PROP_CUSTOM_HEIGHT, height);
+	// Outputs downscale the whole canvas texture, which the area effect filters in the same single draw
+	obs_data_set_int(settings, PROP_SCALE_TYPE, NDI_SCALE_AREA);
+
+	unsigned int fps_num = 0;
+	unsigned int fps_den = 1;
+	int fields = framerate ? sscanf(framerate, "%u/%u", &fps_num, &fps_den) : 0;
+	bool custom_framerate = fields >= 1 && fps_num && fps_den;
+	obs_data_set_bool(settings, PROP_ENABLE_CUSTOM_FPS, custom_framerate);
+	obs_data_set_int(settings, PROP_FRAMERATE_MODE, NDI_FRAMERATE_CUSTOM);
+	obs_data_set_int(settings, PROP_CUSTOM_FPS_NUM, fps_num);
+	obs_data_set_int(settings, PROP_CUSTOM_FPS_DEN, fps_den);
+}
+
+void ndi_converter_update_region(ndi_video_converter_t *converter, uint32_t source_width, uint32_t source_height)
+{
+	if (converter->region_source_width == source_width && converter->region_source_height == source_height)
+		return;
+
+	converter->region_source_width = source_width;
+	converter->region_source_height = source_height;
+
+	// Crop box, in source coordinates
+	uint32_t left = 0;
+	uint32_t top = 0;
+	uint32_t width = source_width;
+	uint32_t height = source_height;
+	if (converter->enable_crop && source_width > 0 && source_height > 0) {
+		left = std::min((uint32_t)converter->crop_left, source_width - 1);
+		top = std::min((uint32_t)converter->crop_top, source_height - 1);
+		width = converter->crop_width ? std::min(converter->crop_width, source_width - left)
+					      : source_width - left;
+		height = converter->crop_height ? std::min(converter->crop_height, source_height - top)
+						: source_height - top;
+	}
+	converter->region_left = (float)left;
+	converter->region_top = (float)top;
+	converter->region_width = (float)width;
+	converter->region_height = (float)height;
+
+	// Output size: the crop box, scaled like the whole source is scaled to the target resolution
+	converter->output_width = width;
+	converter->output_height = height;
+	if (converter->enable_custom_resolution && converter->target_width > 0 && converter->target_height > 0 &&
+	    source_width > 0 && source_height > 0) {
+		converter->output_width =
+			std::max<uint32_t>(1, (uint32_t)((uint64_t)width * converter->target_width / source_width));
+		converter->output_height =
+			std::max<uint32_t>(1, (uint32_t)((uint64_t)height * converter->target_height / source_height));
+	}
+
+	blog(LOG_DEBUG, "[ndi-converter] Render region for %ux%u: crop (%u,%u,%u,%u) -> %ux%u", source_width,
+	     source_height, left, top, width, height, converter->output_width, converter->output_height);
+}
+
+bool ndi_converter_gpu_downscale(const ndi_video_converter_t *converter)
+{
+	if (converter->scale_type != NDI_SCALE_AREA && converter->scale_type != NDI_SCALE_LANCZOS)
+		return false;
+
+	return converter->region_width > (float)converter->output_width ||
+	       converter->region_height > (float)converter->output_height;
+}
+
+gs_effect_t *ndi_converter_scale_effect(const ndi_video_converter_t *converter, gs_texture_t *texture)
+{
+	gs_effect_t *effect =
+		obs_get_base_effect(converter->scale_type == NDI_SCALE_LANCZOS ? OBS_EFFECT_LANCZOS : OBS_EFFECT_AREA);
+
+	struct vec2 base;
+	struct vec2 base_i;
+	vec2_set(&base, (float)gs_texture_get_width(texture), (float)gs_texture_get_height(texture));
+	vec2_set(&base_i, 1.0f / base.x, 1.0f / base.y);
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), texture);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "base_dimension"), &base);
+	gs_effect_set_vec2(gs_effect_get_param_by_name(effect, "base_dimension_i"), &base_i);
+	gs_eparam_t *undistort = gs_effect_get_param_by_name(effect, "undistort_factor");
+	if (undistort)
+		gs_effect_set_float(undistort, 1.0f);
+	return effect;
+}
+
+// Free the scaled buffer, for a new frame size or on destroy
+static void ndi_converter_free_scaled_buffer(ndi_video_converter_t *converter)
+{
+	ndi_buffer_pool_free(converter->scaled_buffer, converter->scaled_buffer_size);
+	converter->scaled_buffer = nullptr;
+	converter->scaled_buffer_size = 0;
+}
+
 bool ndi_converter_update_scaler(ndi_video_converter_t *converter, uint32_t source_width, uint32_t source_height,
 				  enum video_format source_format)
 {
 	if (!converter->enable_custom_resolution || converter->target_width == 0 || converter->target_height == 0) {
-		blog(LOG_DEBUG, "[ndi-converter] Scaling disabled or no target dimensions");
+		converter_trace("Scaling disabled or no target dimensions");
 		return false;
 	}
 
-	// Check if we need to recreate the scaler
-	bool need_recreate =
-		!converter->scaler || converter->source_width != source_width ||
-		converter->source_height != source_height || converter->source_format != source_format;
-
+	// Check if we need to recreate the scaler (source, target or scale type changed)
+	bool need_recreate = !converter->scaler || converter->source_width != source_width ||
+			     converter->source_height != source_height || converter->source_format != source_format ||
+			     converter->scaler_width != converter->target_width ||
+			     converter->scaler_height != converter->target_height ||
+			     converter->scaler_scale_type != converter->scale_type;
 	if (!need_recreate) {
-		blog(LOG_DEBUG, "[ndi-converter] Scaler already exists, reusing");
+		converter_trace("Scaler already exists, reusing");
 		return true;
 	}
 
@@ -266,37 +390,39 @@ bool ndi_converter_update_scaler(ndi_video_converter_t *converter, uint32_t sour
 	case NDI_SCALE_BICUBIC:
 		obs_scale_type = VIDEO_SCALE_BICUBIC;
 		break;
+	// video_scaler has no area or Lanczos mode, those are GPU only
 	default:
 		obs_scale_type = VIDEO_SCALE_BICUBIC;
 		break;
 	}
 
-	blog(LOG_DEBUG, "[ndi-converter] Creating video_scaler...");
 	int result = video_scaler_create(&converter->scaler, &dst_info, &src_info, obs_scale_type);
 	if (result != VIDEO_SCALER_SUCCESS) {
 		blog(LOG_ERROR, "[ndi-converter] Failed to create video scaler: %d", result);
 		converter->scaler = nullptr;
 		return false;
 	}
-	blog(LOG_INFO, "[ndi-converter] Scaler created successfully");
 
 	// Update source dimensions
 	converter->source_width = source_width;
 	converter->source_height = source_height;
 	converter->source_format = source_format;
+	converter->scaler_width = converter->target_width;
+	converter->scaler_height = converter->target_height;
+	converter->scaler_scale_type = converter->scale_type;
 
 	// Allocate scaled buffer
-	size_t required_size = converter->target_width * converter->target_height * 4; // BGRA = 4 bytes per pixel
+	size_t required_size = (size_t)converter->target_width * converter->target_height * 4; // BGRA
 	if (converter->scaled_buffer_size < required_size) {
-		blog(LOG_DEBUG, "[ndi-converter] Allocating scaled buffer: %zu bytes", required_size);
-		if (converter->scaled_buffer) {
-			bfree(converter->scaled_buffer);
+		ndi_converter_free_scaled_buffer(converter);
+		converter->scaled_buffer = ndi_buffer_pool_alloc(required_size, &converter->scaled_buffer_size);
+		if (!converter->scaled_buffer) {
+			video_scaler_destroy(converter->scaler);
+			converter->scaler = nullptr;
+			return false;
 		}
-		converter->scaled_buffer = (uint8_t *)bmalloc(required_size);
-		converter->scaled_buffer_size = required_size;
 	}
 
-	blog(LOG_INFO, "[ndi-converter] Scaler setup complete");
 	return true;
 }
 
@@ -304,38 +430,23 @@ bool ndi_converter_scale_video(ndi_video_converter_t *converter, uint8_t *frame_
 			       uint32_t source_width, uint32_t source_height, enum video_format source_format,
 			       uint8_t **frame_out, uint32_t *linesize_out)
 {
-	blog(LOG_DEBUG, "[ndi-converter] scale_video called: %dx%d", source_width, source_height);
-
-	if (!ndi_converter_update_scaler(converter, source_width, source_height, source_format)) {
-		blog(LOG_DEBUG, "[ndi-converter] update_scaler returned false");
-		return false;
-	}
+	converter_trace("scale_video called: %dx%d", source_width, source_height);
 
-	if (!converter->scaler || !converter->scaled_buffer) {
-		blog(LOG_ERROR, "[ndi-converter] No scaler or buffer after update!");
+	if (!ndi_converter_update_scaler(converter, source_width, source_height, source_format))
 		return false;
-	}
 
-	// Prepare output arrays for scaler
 	uint8_t *output_planes[1] = {converter->scaled_buffer};
 	uint32_t output_linesize[1] = {converter->target_width * 4}; // BGRA = 4 bytes per pixel
 
-	blog(LOG_DEBUG, "[ndi-converter] Calling video_scaler_scale...");
-	// Scale the video
-	bool success = video_scaler_scale(converter->scaler, output_planes, output_linesize,
-					  (const uint8_t *const *)frame_in, linesize_in);
-
-	blog(LOG_DEBUG, "[ndi-converter] video_scaler_scale returned: %d", success);
-
-	if (success) {
-		*frame_out = converter->scaled_buffer;
-		*linesize_out = converter->target_width * 4; // BGRA linesize
-		blog(LOG_DEBUG, "[ndi-converter] Scaling successful");
-		return true;
+	if (!video_scaler_scale(converter->scaler, output_planes, output_linesize, (const uint8_t *const *)frame_in,
+				linesize_in)) {
+		converter_trace("Scaling failed");
+		return false;
 	}
 
-	blog(LOG_WARNING, "[ndi-converter] Scaling failed");
-	return false;
+	*frame_out = converter->scaled_buffer;
+	*linesize_out = output_linesize[0];
+	return true;
 }
 
 bool ndi_converter_should_send_frame(ndi_video_converter_t *converter, uint64_t frame_timestamp, int *frames_to_send)
@@ -354,6 +465,7 @@ bool ndi_converter_should_send_frame(ndi_video_converter_t *converter, uint64_t
 	// Add to accumulator
 	converter->accumulator_ns += delta_ns;
 	converter->last_frame_timestamp = frame_timestamp;
+	converter->last_frame_delta_ns = delta_ns;
 
 	// Determine how many frames to send
 	int count = 0;
@@ -366,6 +478,44 @@ bool ndi_converter_should_send_frame(ndi_video_converter_t *converter, uint64_t
 	return count > 0;
 }
 
+void ndi_converter_reset_framerate(ndi_video_converter_t *converter)
+{
+	converter->accumulator_ns = 0;
+	converter->last_frame_timestamp = 0;
+	converter->last_frame_delta_ns = 0;
+}
+
+float ndi_converter_blend_weight(ndi_video_converter_t *converter)
+{
+	int64_t delta_ns = converter->last_frame_delta_ns;
+	if (delta_ns <= 0)
+		return 1.0f;
+
+	// The accumulator holds the time elapsed since the last output tick, which sits that far before this frame
+	int64_t tick_ns = delta_ns - converter->accumulator_ns;
+	if (tick_ns <= 0)
+		return 0.0f;
+	if (tick_ns >= delta_ns)
+		return 1.0f;
+	return (float)tick_ns / (float)delta_ns;
+}
+
+void ndi_frame_pacer_wait(ndi_frame_pacer_t *pacer, uint64_t frame_timestamp, uint64_t frame_interval_ns)
+{
+	uint64_t now_ns = os_gettime_ns();
+	if (pacer->last_send_ns && frame_timestamp > pacer->last_timestamp) {
+		uint64_t delta_ns = std::min(frame_timestamp - pacer->last_timestamp, frame_interval_ns);
+		uint64_t due_ns = pacer->last_send_ns + delta_ns;
+		if (due_ns > now_ns) {
+			os_sleepto_ns(due_ns);
+			// From the due time, so sleep overshoot does not add up over the repeats
+			now_ns = due_ns;
+		}
+	}
+	pacer->last_timestamp = frame_timestamp;
+	pacer->last_send_ns = now_ns;
+}
+
 void ndi_converter_destroy(ndi_video_converter_t *converter)
 {
 	if (converter->scaler) {
@@ -373,11 +523,7 @@ void ndi_converter_destroy(ndi_video_converter_t *converter)
 		converter->scaler = nullptr;
 	}
 
-	if (converter->scaled_buffer) {
-		bfree(converter->scaled_buffer);
-		converter->scaled_buffer = nullptr;
-		converter->scaled_buffer_size = 0;
-	}
+	ndi_converter_free_scaled_buffer(converter);
 
 	memset(converter, 0, sizeof(ndi_video_converter_t));
 }
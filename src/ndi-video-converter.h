@@ -56,7 +56,9 @@ enum ndi_framerate_mode {
 enum ndi_scale_type {
 	NDI_SCALE_FAST_BILINEAR = 0,  // Fastest, lower quality
 	NDI_SCALE_BILINEAR,           // Fast, good quality
-	NDI_SCALE_BICUBIC              // Balanced (default), best quality
+	NDI_SCALE_BICUBIC,             // Balanced (default), best quality
+	NDI_SCALE_AREA,                // GPU downscale averaging every covered pixel (bicubic on the CPU)
+	NDI_SCALE_LANCZOS              // GPU downscale, sharpest (bicubic on the CPU)
 };
 
 /**
@@ -79,6 +81,17 @@ typedef struct {
 	uint32_t crop_width;
 	uint32_t crop_height;
 
+	// Render region (crop box in source coordinates and output size), derived from the settings
+	// and cached per source size by ndi_converter_update_region
+	uint32_t region_source_width;
+	uint32_t region_source_height;
+	float region_left;
+	float region_top;
+	float region_width;
+	float region_height;
+	uint32_t output_width;
+	uint32_t output_height;
+
 	// Frame rate settings
 	bool enable_custom_framerate;
 	enum ndi_framerate_mode framerate_mode;
@@ -87,15 +100,23 @@ typedef struct {
 	uint32_t target_fps_num;
 	uint32_t target_fps_den;
 
-	// Conversion state
+	// Conversion state. Scaled frames are BGRA.
+	// Target the scaler was created for, to recreate it when the settings change
+	uint32_t scaler_width;
+	uint32_t scaler_height;
+	enum ndi_scale_type scaler_scale_type;
 	video_scaler_t *scaler;
 	uint8_t *scaled_buffer;
 	size_t scaled_buffer_size;
 
+	// Blend the frames around each output tick instead of repeating/dropping whole frames
+	bool frame_blend;
+
 	// Frame rate conversion state
 	int64_t accumulator_ns;
 	int64_t target_frame_interval_ns;
 	uint64_t last_frame_timestamp;
+	int64_t last_frame_delta_ns;
 
 	// Source dimensions (for detecting changes)
 	uint32_t source_width;
@@ -104,6 +125,15 @@ typedef struct {
 
 } ndi_video_converter_t;
 
+/**
+ * Send pacing of a private video_output. Its thread hands all the copies of a frame locked with a repeat count
+ * back to back, with timestamps one frame interval apart; the pacer holds each one until it is due.
+ */
+typedef struct {
+	uint64_t last_timestamp;
+	uint64_t last_send_ns;
+} ndi_frame_pacer_t;
+
 /**
  * Initialize a video converter instance.
  * @param converter Pointer to converter structure to initialize
@@ -117,6 +147,43 @@ void ndi_converter_init(ndi_video_converter_t *converter);
  */
 void ndi_converter_update(ndi_video_converter_t *converter, obs_data_t *settings);
 
+/**
+ * Fill the converter settings of an output from its configured resolution ("WIDTHxHEIGHT") and frame rate
+ * ("NUM" or "NUM/DEN"). Empty or invalid values keep the canvas resolution or frame rate.
+ * @param settings OBS settings data handed to ndi_converter_update
+ * @param resolution Configured resolution
+ * @param framerate Configured frame rate
+ */
+void ndi_converter_set_output_settings(obs_data_t *settings, const char *resolution, const char *framerate);
+
+/**
+ * Compute the render region for a source size: the crop box to render (in source coordinates, for gs_ortho)
+ * and the output size, after scaling to the target resolution. Only recomputed when the source size
+ * or the settings change.
+ * @param converter The converter instance
+ * @param source_width Current source width
+ * @param source_height Current source height
+ */
+void ndi_converter_update_region(ndi_video_converter_t *converter, uint32_t source_width, uint32_t source_height);
+
+/**
+ * Whether the GPU path should downscale with a filtering effect (area or Lanczos) instead of drawing the source
+ * straight into the output size, which samples it bilinearly and aliases on large downscales.
+ * Only valid after ndi_converter_update_region.
+ * @param converter The converter instance
+ * @return true when the region is larger than the output and the scale type is area or Lanczos
+ */
+bool ndi_converter_gpu_downscale(const ndi_video_converter_t *converter);
+
+/**
+ * Get the libobs scale effect for the converter's scale type, with its parameters set for the texture.
+ * Draw it with the "Draw" technique.
+ * @param converter The converter instance
+ * @param texture Texture to downscale
+ * @return The effect
+ */
+gs_effect_t *ndi_converter_scale_effect(const ndi_video_converter_t *converter, gs_texture_t *texture);
+
 /**
  * Check if resolution scaling is needed and update scaler if necessary.
  * @param converter The converter instance
@@ -136,8 +203,8 @@ bool ndi_converter_update_scaler(ndi_video_converter_t *converter, uint32_t sour
  * @param source_width Source width
  * @param source_height Source height
  * @param source_format Source video format
- * @param frame_out Output scaled frame data pointer (will point to scaled buffer)
- * @param linesize_out Output line size pointer
+ * @param frame_out Output frame data pointer (points to internal buffer, valid until the next call)
+ * @param linesize_out Output line size
  * @return true on success, false on failure
  */
 bool ndi_converter_scale_video(ndi_video_converter_t *converter, uint8_t *frame_in[], uint32_t linesize_in[],
@@ -155,6 +222,32 @@ bool ndi_converter_scale_video(ndi_video_converter_t *converter, uint8_t *frame_
 bool ndi_converter_should_send_frame(ndi_video_converter_t *converter, uint64_t frame_timestamp,
 				     int *frames_to_send);
 
+/**
+ * Restart the frame rate conversion from the next frame, after frames were not passed to
+ * ndi_converter_should_send_frame (paused rendering), so the gap is not made up with a burst of duplicates.
+ * @param converter The converter instance
+ */
+void ndi_converter_reset_framerate(ndi_video_converter_t *converter);
+
+/**
+ * Position of the last output tick decided by ndi_converter_should_send_frame between the previous frame and
+ * the current one, for frame blending: 0 shows the previous frame, 1 the current one.
+ * When several ticks fall between two frames (upconversion), this is the position of the last one.
+ * @param converter The converter instance
+ * @return Weight of the current frame
+ */
+float ndi_converter_blend_weight(ndi_video_converter_t *converter);
+
+/**
+ * Wait until a frame is due: as long after the previous frame was sent as their timestamps are apart, capped at
+ * one frame interval so a late or stalled render never adds delay. Only for private video_outputs, sleeping on
+ * the OBS video thread would hold back every other output.
+ * @param pacer Pacing state, zeroed to restart
+ * @param frame_timestamp Timestamp of the frame about to be sent
+ * @param frame_interval_ns Frame interval of the video_output
+ */
+void ndi_frame_pacer_wait(ndi_frame_pacer_t *pacer, uint64_t frame_timestamp, uint64_t frame_interval_ns);
+
 /**
  * Destroy and free converter resources.
  * @param converter The converter instance
@@ -22,9 +22,19 @@
 #include "forms/output-settings.h"
 #include "forms/update.h"
 #include "main-output.h"
+#include "ndi-buffer-pool.h"
+#include "ndi-control.h"
+#include "ndi-finder.h"
+#include "ndi-receiver-pool.h"
+#include "ndi-stripe-pool.h"
+#include "ndi-trace.h"
+#include "ndi-video-converter.h"
 #include "preview-output.h"
+#include "routing-outputs.h"
+#include "scene-outputs.h"
 
 #include <QAction>
+#include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
 #include <QLibrary>
@@ -34,6 +44,8 @@
 #include <QRegularExpression>
 #include <QTimer>
 
+#include <thread>
+
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 
@@ -52,6 +64,12 @@ const NDIlib_v6 *ndiLib = nullptr;
 extern struct obs_source_info create_ndi_source_info();
 struct obs_source_info ndi_source_info;
 
+extern struct obs_source_info create_ndi_source_direct_info();
+struct obs_source_info ndi_source_direct_info;
+
+extern struct obs_source_info create_ndi_multiview_info();
+struct obs_source_info ndi_multiview_info;
+
 extern struct obs_output_info create_ndi_output_info();
 struct obs_output_info ndi_output_info;
 
@@ -71,6 +89,9 @@ QLibrary *loaded_lib = nullptr;
 
 OutputSettings *output_settings = nullptr;
 
+std::thread ndi_load_thread;
+bool ndi_initialized = false;
+
 //
 //
 //
@@ -230,53 +251,36 @@ bool is_version_supported(const char *version, const char *min_version)
 	return true;
 }
 
-bool obs_module_load(void)
+/**
+ * Load and initialize the NDI library, on the thread started by obs_module_load.
+ * The results are checked by ndi_library_check.
+ */
+static void ndi_library_load()
 {
-	obs_log(LOG_INFO, "obs_module_load: you can haz %s (Version %s)", PLUGIN_DISPLAY_NAME, PLUGIN_VERSION);
-	// obs_log(LOG_DEBUG, "obs_module_load: Qt Version: %s (runtime), %s (compiled)", qVersion(), QT_VERSION_STR);
-
-	Config::Initialize();
-
-	// Check if the old version of the plugin is installed
-	if (is_obsndi_installed()) {
-		obs_log(LOG_ERROR, "ERR-403 - OBS-NDI is detected and needs to be uninstalled before %s can work.",
-			PLUGIN_DISPLAY_NAME);
-		obs_log(LOG_DEBUG,
-			"obs_module_load: OBS-NDI is detected and needs to be uninstalled before %s will load.",
-			PLUGIN_DISPLAY_NAME);
-		showCriticalUnloadingMessageBoxDelayed(QTStr("NDIPlugin.ErrorObsNdiDetected.Title"),
-						       QTStr("NDIPlugin.ErrorObsNdiDetected.Message")
-							       .arg(rehostUrl(PLUGIN_REDIRECT_UNINSTALL_OBSNDI_URL)));
-		return false;
-	}
-	obs_log(LOG_DEBUG, "obs_module_load: No OBS-NDI leftover detected. Continuing...");
-
-	// Check if this is using the minimum OBS version required by this plugin
-	if (!is_version_supported(obs_get_version_string(), PLUGIN_MIN_OBS_VERSION)) {
-		obs_log(LOG_ERROR, "ERR-424 - %s requires at least OBS version %s.", PLUGIN_DISPLAY_NAME,
-			PLUGIN_MIN_OBS_VERSION);
-		obs_log(LOG_DEBUG,
-			"obs_module_load: OBS version detected is not compatible. OBS version detected: %s. OBS version required: %s",
-			obs_get_version_string(), PLUGIN_MIN_OBS_VERSION);
-
-		auto title = "OBS version not supported";
-		auto message = "Error-424: Plugin requires OBS " + QTStr(PLUGIN_MIN_OBS_VERSION) + " or higher <br>";
-		showCriticalUnloadingMessageBoxDelayed(title, message);
-
-		return false;
-	}
-	obs_log(LOG_DEBUG, "obs_module_load: Minimum OBS version met. Continuing...");
-
-	// Check if the NDI SDK is installed & compatible
-
-	auto main_window = static_cast<QMainWindow *>(obs_frontend_get_main_window());
-
 #if 0
 	// For testing purposes only
 	ndiLib = nullptr;
 #else
 	ndiLib = load_ndilib();
 #endif
+	if (loaded_lib) {
+		// Owned by the main thread from now on, this thread ends after the load
+		loaded_lib->moveToThread(QCoreApplication::instance()->thread());
+	}
+#if 0
+	// for testing purposes only
+	ndi_initialized = false;
+#else
+	ndi_initialized = ndiLib && ndiLib->initialize();
+#endif
+}
+
+/**
+ * Check the NDI library loaded by ndi_library_load, and tell the user when it cannot be used.
+ * @return true if the NDI library is loaded, initialized and recent enough
+ */
+static bool ndi_library_check()
+{
 	if (!ndiLib) {
 		auto title = Str("NDIPlugin.LibError.Title");
 		auto message = "Error-401: " + QTStr("NDIPlugin.LibError.Message") + "<br>";
@@ -286,25 +290,19 @@ bool obs_module_load(void)
 		message += makeLink(PLUGIN_REDIRECT_NDI_REDIST_URL);
 #endif
 		obs_log(LOG_ERROR, "ERR-401 - NDI library failed to load with message: '%s'", QT_TO_UTF8(message));
-		obs_log(LOG_DEBUG, "obs_module_load: ERROR - load_ndilib() failed; message=%s", QT_TO_UTF8(message));
+		obs_log(LOG_DEBUG, "ndi_library_check: ERROR - load_ndilib() failed; message=%s", QT_TO_UTF8(message));
 		showCriticalUnloadingMessageBoxDelayed(title, message);
 		return false;
 	}
 
-#if 0
-	// for testing purposes only
-	auto initialized = false;
-#else
-	auto initialized = ndiLib->initialize();
-#endif
-	if (!initialized) {
+	if (!ndi_initialized) {
 		obs_log(LOG_ERROR, "ERR-406 - NDI library could not initialize due to unsupported CPU.");
 		obs_log(LOG_DEBUG,
-			"obs_module_load: ndiLib->initialize() failed; CPU unsupported by NDI library. Module won't load.");
+			"ndi_library_check: ndiLib->initialize() failed; CPU unsupported by NDI library. Module won't load.");
 		return false;
 	}
 
-	obs_log(LOG_INFO, "obs_module_load: NDI library detected ('%s')", ndiLib->version());
+	obs_log(LOG_INFO, "ndi_library_check: NDI library detected ('%s')", ndiLib->version());
 
 	// Check if the minimum NDI Runtime/SDK required by this plugin is used
 	QString ndi_version_short =
@@ -315,7 +313,7 @@ bool obs_module_load(void)
 		obs_log(LOG_ERROR,
 			"ERR-425 - %s requires at least NDI version %s. NDI Version detected: %s. Plugin will unload.",
 			PLUGIN_DISPLAY_NAME, PLUGIN_MIN_NDI_VERSION, QT_TO_UTF8(ndi_version_short));
-		obs_log(LOG_DEBUG, "obs_module_load: NDI minimum version not met (%s). NDI version detected: %s.",
+		obs_log(LOG_DEBUG, "ndi_library_check: NDI minimum version not met (%s). NDI version detected: %s.",
 			PLUGIN_MIN_NDI_VERSION, ndiLib->version());
 
 		auto title = "NDI Library version not supported";
@@ -327,11 +325,78 @@ bool obs_module_load(void)
 		return false;
 	}
 
-	obs_log(LOG_INFO, "obs_module_load: NDI library initialized successfully");
+	obs_log(LOG_INFO, "ndi_library_check: NDI library initialized successfully");
+	return true;
+}
+
+bool obs_module_load(void)
+{
+	obs_log(LOG_INFO, "obs_module_load: you can haz %s (Version %s)", PLUGIN_DISPLAY_NAME, PLUGIN_VERSION);
+	// obs_log(LOG_DEBUG, "obs_module_load: Qt Version: %s (runtime), %s (compiled)", qVersion(), QT_VERSION_STR);
+
+	Config::Initialize();
+	ndi_trace_init(QT_TO_UTF8(Config::TraceFile));
+
+	// Check if the old version of the plugin is installed
+	if (is_obsndi_installed()) {
+		obs_log(LOG_ERROR, "ERR-403 - OBS-NDI is detected and needs to be uninstalled before %s can work.",
+			PLUGIN_DISPLAY_NAME);
+		obs_log(LOG_DEBUG,
+			"obs_module_load: OBS-NDI is detected and needs to be uninstalled before %s will load.",
+			PLUGIN_DISPLAY_NAME);
+		showCriticalUnloadingMessageBoxDelayed(QTStr("NDIPlugin.ErrorObsNdiDetected.Title"),
+						       QTStr("NDIPlugin.ErrorObsNdiDetected.Message")
+							       .arg(rehostUrl(PLUGIN_REDIRECT_UNINSTALL_OBSNDI_URL)));
+		return false;
+	}
+	obs_log(LOG_DEBUG, "obs_module_load: No OBS-NDI leftover detected. Continuing...");
+
+	// Check if this is using the minimum OBS version required by this plugin
+	if (!is_version_supported(obs_get_version_string(), PLUGIN_MIN_OBS_VERSION)) {
+		obs_log(LOG_ERROR, "ERR-424 - %s requires at least OBS version %s.", PLUGIN_DISPLAY_NAME,
+			PLUGIN_MIN_OBS_VERSION);
+		obs_log(LOG_DEBUG,
+			"obs_module_load: OBS version detected is not compatible. OBS version detected: %s. OBS version required: %s",
+			obs_get_version_string(), PLUGIN_MIN_OBS_VERSION);
+
+		auto title = "OBS version not supported";
+		auto message = "Error-424: Plugin requires OBS " + QTStr(PLUGIN_MIN_OBS_VERSION) + " or higher <br>";
+		showCriticalUnloadingMessageBoxDelayed(title, message);
+
+		return false;
+	}
+	obs_log(LOG_DEBUG, "obs_module_load: Minimum OBS version met. Continuing...");
+
+	// Load the NDI library in the background, while OBS loads the other modules; it is waited for in
+	// obs_module_post_load, before any NDI source or output is created
+	obs_log(LOG_DEBUG, "obs_module_load: Loading NDI library in the background");
+	ndi_load_thread = std::thread(ndi_library_load);
+
+	return true;
+}
+
+void obs_module_post_load(void)
+{
+	obs_log(LOG_DEBUG, "+obs_module_post_load()");
+
+	if (ndi_load_thread.joinable())
+		ndi_load_thread.join();
+
+	if (!ndi_library_check()) {
+		// Nothing is registered, the plugin stays inactive until unloaded
+		obs_log(LOG_DEBUG, "-obs_module_post_load(): NDI library unavailable");
+		return;
+	}
 
 	ndi_source_info = create_ndi_source_info();
 	obs_register_source(&ndi_source_info);
 
+	ndi_source_direct_info = create_ndi_source_direct_info();
+	obs_register_source(&ndi_source_direct_info);
+
+	ndi_multiview_info = create_ndi_multiview_info();
+	obs_register_source(&ndi_multiview_info);
+
 	ndi_output_info = create_ndi_output_info();
 	obs_register_output(&ndi_output_info);
 
@@ -344,15 +409,18 @@ bool obs_module_load(void)
 	alpha_filter_info = create_alpha_filter_info();
 	obs_register_source(&alpha_filter_info);
 
+	auto main_window = static_cast<QMainWindow *>(obs_frontend_get_main_window());
 	if (main_window) {
 		auto menu_action = static_cast<QAction *>(
 			obs_frontend_add_tools_menu_qaction(obs_module_text("NDIPlugin.Menu.OutputSettings")));
 
-		obs_frontend_push_ui_translation(obs_module_get_string);
-		output_settings = new OutputSettings(main_window);
-		obs_frontend_pop_ui_translation();
-
-		auto menu_cb = [] {
+		// The dialog is only built the first time it is opened
+		auto menu_cb = [main_window] {
+			if (!output_settings) {
+				obs_frontend_push_ui_translation(obs_module_get_string);
+				output_settings = new OutputSettings(main_window);
+				obs_frontend_pop_ui_translation();
+			}
 			output_settings->toggleShowHide();
 		};
 		menu_action->connect(menu_action, &QAction::triggered, menu_cb);
@@ -362,10 +430,14 @@ bool obs_module_load(void)
 				if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
 					main_output_init();
 					preview_output_init();
+					scene_outputs_init();
+					routing_outputs_init();
 				} else if (event == OBS_FRONTEND_EVENT_EXIT) {
 					// Unknown why putting this in obs_module_unload causes a crash when closing OBS
 					main_output_deinit();
 					preview_output_deinit();
+					scene_outputs_deinit();
+					routing_outputs_deinit();
 				} else if (event == OBS_FRONTEND_EVENT_PROFILE_CHANGING) {
 					main_output_deinit();
 				} else if (event == OBS_FRONTEND_EVENT_PROFILE_CHANGED) {
@@ -375,12 +447,6 @@ bool obs_module_load(void)
 			nullptr);
 	}
 	obs_log(LOG_INFO, "plugin loaded successfully (version %s)", PLUGIN_VERSION);
-	return true;
-}
-
-void obs_module_post_load(void)
-{
-	obs_log(LOG_DEBUG, "+obs_module_post_load()");
 
 	updateCheckStart();
 
@@ -393,6 +459,16 @@ void obs_module_unload(void)
 
 	updateCheckStop();
 
+	if (ndi_load_thread.joinable())
+		ndi_load_thread.join();
+
+	NDIFinder::shutdown();
+	ndi_receiver_pool_shutdown();
+	ndi_control_shutdown();
+	ndi_stripe_pool_shutdown();
+	ndi_buffer_pool_shutdown();
+	ndi_trace_shutdown();
+
 	if (ndiLib) {
 		ndiLib->destroy();
 		ndiLib = nullptr;
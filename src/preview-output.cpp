@@ -18,6 +18,8 @@
 #include "preview-output.h"
 
 #include "plugin-main.h"
+#include "ndi-readback.h"
+#include "ndi-video-converter.h"
 
 #include <util/platform.h>
 #include <media-io/video-frame.h>
@@ -32,10 +34,16 @@ struct preview_output {
 
 	video_t *video_queue;
 	audio_t *dummy_audio_queue; // unused for now
+	// The preview scene is rendered through its own view, once per canvas frame after the main render
+	obs_view_t *view;
 	gs_texrender_t *texrender;
-	gs_stagesurf_t *stagesurface;
-	uint8_t *video_data;
-	uint32_t video_linesize;
+	ndi_readback_t readback;
+
+	// Render even when no receiver is connected
+	bool always_send;
+
+	// Crop, scale and frame rate conversion, applied while rendering the preview
+	ndi_video_converter_t converter;
 
 	obs_video_info ovi;
 };
@@ -43,7 +51,7 @@ struct preview_output {
 static struct preview_output context = {0};
 
 void on_preview_scene_changed(enum obs_frontend_event event, void *param);
-void render_preview_source(void *param, uint32_t cx, uint32_t cy);
+void render_preview_source(void *param);
 
 void on_preview_output_started(void *, calldata_t *)
 {
@@ -69,19 +77,25 @@ void preview_output_stop()
 
 		video_output_stop(context.video_queue);
 
-		obs_remove_main_render_callback(render_preview_source, &context);
+		obs_remove_main_rendered_callback(render_preview_source, &context);
 		obs_frontend_remove_event_callback(on_preview_scene_changed, &context);
 
+		obs_view_set_source(context.view, 0, nullptr);
+		obs_view_destroy(context.view);
+		context.view = nullptr;
 		obs_source_release(context.current_source);
+		context.current_source = nullptr;
 
 		obs_enter_graphics();
-		gs_stagesurface_destroy(context.stagesurface);
+		ndi_readback_destroy(&context.readback);
 		gs_texrender_destroy(context.texrender);
 		obs_leave_graphics();
 
 		video_output_close(context.video_queue);
 		audio_output_close(context.dummy_audio_queue);
 
+		ndi_converter_destroy(&context.converter);
+
 		context.is_running = false;
 
 		obs_log(LOG_DEBUG, "preview_output_stop: successfully stopped NDI preview output '%s'",
@@ -106,12 +120,25 @@ void preview_output_start()
 
 		obs_get_video_info(&context.ovi);
 
-		uint32_t width = context.ovi.base_width;
-		uint32_t height = context.ovi.base_height;
-
+		auto config = Config::Current();
+		context.always_send = config->PreviewOutputAlwaysSend;
+		obs_data_t *converter_settings = obs_data_create();
+		ndi_converter_set_output_settings(converter_settings, QT_TO_UTF8(config->PreviewOutputResolution),
+						  QT_TO_UTF8(config->PreviewOutputFramerate));
+		ndi_converter_init(&context.converter);
+		ndi_converter_update(&context.converter, converter_settings);
+		obs_data_release(converter_settings);
+
+		// Scenes are canvas sized, so the render region is fixed for the lifetime of the output
+		ndi_converter_update_region(&context.converter, context.ovi.base_width, context.ovi.base_height);
+		uint32_t width = context.converter.output_width;
+		uint32_t height = context.converter.output_height;
+
+		// Frames are mapped one frame after they are staged, once the GPU copy is done
 		obs_enter_graphics();
 		context.texrender = gs_texrender_create(GS_BGRA, GS_ZS_NONE);
-		context.stagesurface = gs_stagesurface_create(width, height, GS_BGRA);
+		ndi_readback_init(&context.readback);
+		ndi_readback_configure(&context.readback, width, height, GS_BGRA, 2);
 		obs_leave_graphics();
 
 		const video_output_info *mainVOI = video_output_get_info(obs_get_video());
@@ -124,6 +151,11 @@ void preview_output_start()
 		voi.height = height;
 		voi.fps_den = context.ovi.fps_den;
 		voi.fps_num = context.ovi.fps_num;
+		if (context.converter.enable_custom_framerate && context.converter.target_fps_num &&
+		    context.converter.target_fps_den) {
+			voi.fps_den = context.converter.target_fps_den;
+			voi.fps_num = context.converter.target_fps_num;
+		}
 		voi.cache_size = 16;
 		voi.colorspace = mainVOI->colorspace;
 		voi.range = mainVOI->range;
@@ -148,7 +180,9 @@ void preview_output_start()
 		} else {
 			context.current_source = obs_frontend_get_current_scene();
 		}
-		obs_add_main_render_callback(render_preview_source, &context);
+		context.view = obs_view_create();
+		obs_view_set_source(context.view, 0, context.current_source);
+		obs_add_main_rendered_callback(render_preview_source, &context);
 
 		obs_data_t *settings = obs_output_get_settings(context.output);
 		obs_data_set_string(settings, "ndi_name", QT_TO_UTF8(context.ndi_name));
@@ -224,6 +258,9 @@ void preview_output_init()
 
 		obs_data_set_bool(output_settings, "uses_audio",
 				  false); // Preview has no audio
+		obs_data_set_bool(output_settings, "always_send", config->PreviewOutputAlwaysSend);
+		obs_data_set_bool(output_settings, "clock_video", config->PreviewOutputClockVideo);
+		obs_data_set_bool(output_settings, "drop_frames", config->PreviewOutputDropFrames);
 
 		context.output = obs_output_create("ndi_output", "NDI Preview Output", output_settings, nullptr);
 		obs_data_release(output_settings);
@@ -275,54 +312,83 @@ void on_preview_scene_changed(enum obs_frontend_event event, void *param)
 		ctx->current_source = nullptr;
 		break;
 	default:
-		break;
+		return;
 	}
+	obs_view_set_source(ctx->view, 0, ctx->current_source);
+}
+
+// Asks the NDI output through its "get_connections" proc
+static bool preview_output_has_receivers(struct preview_output *ctx)
+{
+	if (ctx->always_send)
+		return true;
+
+	uint8_t stack[128];
+	calldata_t cd;
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	if (!proc_handler_call(obs_output_get_proc_handler(ctx->output), "get_connections", &cd))
+		return true;
+	return calldata_int(&cd, "connections") > 0;
 }
 
-void render_preview_source(void *param, uint32_t, uint32_t)
+void render_preview_source(void *param)
 {
 	auto ctx = (struct preview_output *)param;
 	if (!ctx->current_source)
 		return;
 
-	uint32_t width = obs_source_get_base_width(ctx->current_source);
-	uint32_t height = obs_source_get_base_height(ctx->current_source);
+	// Nothing is rendered nor read back while no receiver is connected. Frames staged before are stale by the
+	// time someone connects, and the frame rate conversion restarts from the first frame after the pause.
+	ndi_video_converter_t *converter = &ctx->converter;
+	if (!preview_output_has_receivers(ctx)) {
+		ndi_readback_reset(&ctx->readback);
+		ndi_converter_reset_framerate(converter);
+		return;
+	}
+
+	// Frames dropped by the frame rate conversion are not rendered at all
+	uint64_t timestamp = obs_get_video_frame_time();
+	int frames_to_send = 1;
+	if (converter->enable_custom_framerate &&
+	    (!ndi_converter_should_send_frame(converter, timestamp, &frames_to_send) || frames_to_send == 0))
+		return;
+
+	uint32_t width = converter->output_width;
+	uint32_t height = converter->output_height;
 
 	gs_texrender_reset(ctx->texrender);
 
-	if (gs_texrender_begin(ctx->texrender, width, height)) {
-		struct vec4 background;
-		vec4_zero(&background);
+	if (!gs_texrender_begin(ctx->texrender, width, height))
+		return;
 
-		gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
-		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f, 100.0f);
+	struct vec4 background;
+	vec4_zero(&background);
 
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+	gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
+	// Ortho covers the crop region in canvas coordinates, so the render crops and scales at once
+	gs_ortho(converter->region_left, converter->region_left + converter->region_width, converter->region_top,
+		 converter->region_top + converter->region_height, -100.0f, 100.0f);
 
-		obs_source_video_render(ctx->current_source);
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
 
-		gs_blend_state_pop();
-		gs_texrender_end(ctx->texrender);
+	obs_view_render(ctx->view);
 
-		struct video_frame output_frame;
-		if (video_output_lock_frame(ctx->video_queue, &output_frame, 1, os_gettime_ns())) {
-			gs_stage_texture(ctx->stagesurface, gs_texrender_get_texture(ctx->texrender));
-
-			if (gs_stagesurface_map(ctx->stagesurface, &ctx->video_data, &ctx->video_linesize)) {
-				uint32_t linesize = output_frame.linesize[0];
-				for (uint32_t i = 0; i < ctx->ovi.base_height; i++) {
-					uint32_t dst_offset = linesize * i;
-					uint32_t src_offset = ctx->video_linesize * i;
-					memcpy(output_frame.data[0] + dst_offset, ctx->video_data + src_offset,
-					       linesize);
-				}
-
-				gs_stagesurface_unmap(ctx->stagesurface);
-				ctx->video_data = nullptr;
-			}
+	gs_blend_state_pop();
+	gs_texrender_end(ctx->texrender);
 
+	// Maps the frame staged on the previous call, whose GPU copy is done, and only then locks the queue
+	ndi_readback_stage(&ctx->readback, gs_texrender_get_texture(ctx->texrender), timestamp);
+	uint8_t *video_data;
+	uint32_t video_linesize;
+	uint64_t frame_timestamp = 0;
+	if (ndi_readback_map(&ctx->readback, &video_data, &video_linesize, &frame_timestamp)) {
+		struct video_frame output_frame;
+		if (video_output_lock_frame(ctx->video_queue, &output_frame, frames_to_send, frame_timestamp)) {
+			ndi_readback_copy_plane(output_frame.data[0], output_frame.linesize[0], video_data,
+						video_linesize, width * 4, height);
 			video_output_unlock_frame(ctx->video_queue);
 		}
+		ndi_readback_unmap(&ctx->readback);
 	}
 }
@@ -0,0 +1,151 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "routing-outputs.h"
+
+#include "plugin-main.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <vector>
+
+struct routing_output {
+	QString ndi_name;
+	QString groups;
+	QString source_name;
+	NDIlib_routing_instance_t instance;
+};
+
+static std::vector<routing_output *> routing_outputs;
+
+// Points the routing to its source, or to nothing while the source is empty
+static void routing_output_retarget(routing_output *ro, const QString &source_name)
+{
+	bool result;
+	if (source_name.isEmpty()) {
+		result = ndiLib->routing_clear(ro->instance);
+	} else {
+		auto source_name_utf8 = source_name.toUtf8();
+		NDIlib_source_t source;
+		source.p_ndi_name = source_name_utf8.constData();
+		source.p_url_address = nullptr;
+		result = ndiLib->routing_change(ro->instance, &source);
+	}
+
+	if (!result) {
+		obs_log(LOG_WARNING, "WARN-432 - Failed to route NDI Routing '%s' to '%s'", QT_TO_UTF8(ro->ndi_name),
+			QT_TO_UTF8(source_name));
+		return;
+	}
+
+	obs_log(LOG_INFO, "NDI Routing '%s' routed to '%s'", QT_TO_UTF8(ro->ndi_name), QT_TO_UTF8(source_name));
+	ro->source_name = source_name;
+}
+
+static void routing_output_destroy(routing_output *ro)
+{
+	obs_log(LOG_DEBUG, "routing_output_destroy: releasing NDI Routing '%s'", QT_TO_UTF8(ro->ndi_name));
+
+	ndiLib->routing_destroy(ro->instance);
+	delete ro;
+}
+
+static routing_output *routing_output_create(const QString &ndi_name, const QString &groups)
+{
+	obs_log(LOG_DEBUG, "routing_output_create: creating NDI Routing '%s'", QT_TO_UTF8(ndi_name));
+
+	auto ndi_name_utf8 = ndi_name.toUtf8();
+	auto groups_utf8 = groups.toUtf8();
+	NDIlib_routing_create_t routing_desc;
+	routing_desc.p_ndi_name = ndi_name_utf8.constData();
+	routing_desc.p_groups = groups.isEmpty() ? nullptr : groups_utf8.constData();
+
+	auto instance = ndiLib->routing_create(&routing_desc);
+	if (!instance) {
+		obs_log(LOG_WARNING, "WARN-432 - Failed to create NDI Routing '%s'", QT_TO_UTF8(ndi_name));
+		return nullptr;
+	}
+
+	auto ro = new routing_output();
+	ro->ndi_name = ndi_name;
+	ro->groups = groups;
+	ro->instance = instance;
+	return ro;
+}
+
+void routing_outputs_deinit()
+{
+	obs_log(LOG_DEBUG, "+routing_outputs_deinit()");
+
+	for (auto ro : routing_outputs) {
+		routing_output_destroy(ro);
+	}
+	routing_outputs.clear();
+
+	obs_log(LOG_DEBUG, "-routing_outputs_deinit()");
+}
+
+void routing_outputs_init()
+{
+	obs_log(LOG_DEBUG, "+routing_outputs_init()");
+
+	auto config = Config::Current();
+	QJsonParseError parseError;
+	auto document = QJsonDocument::fromJson(config->RoutingOutputs.toUtf8(), &parseError);
+	if (!config->RoutingOutputs.isEmpty() && parseError.error != QJsonParseError::NoError) {
+		obs_log(LOG_WARNING, "WARN-432 - Invalid NDI Routings configuration: %s",
+			QT_TO_UTF8(parseError.errorString()));
+	}
+
+	// Routings that are still configured are moved to the new list, the others are destroyed after
+	std::vector<routing_output *> configured;
+	for (const auto &value : document.array()) {
+		auto entry = value.toObject();
+		auto ndi_name = entry["name"].toString();
+		auto groups = entry["groups"].toString();
+		if (ndi_name.isEmpty())
+			continue;
+
+		routing_output *ro = nullptr;
+		for (auto it = routing_outputs.begin(); it != routing_outputs.end(); ++it) {
+			if ((*it)->ndi_name == ndi_name && (*it)->groups == groups) {
+				ro = *it;
+				routing_outputs.erase(it);
+				break;
+			}
+		}
+		bool created = false;
+		if (!ro) {
+			ro = routing_output_create(ndi_name, groups);
+			if (!ro)
+				continue;
+			created = true;
+		}
+
+		auto source_name = entry["source"].toString();
+		if (created || ro->source_name != source_name)
+			routing_output_retarget(ro, source_name);
+		configured.push_back(ro);
+	}
+
+	routing_outputs_deinit();
+	routing_outputs = std::move(configured);
+
+	obs_log(LOG_DEBUG, "-routing_outputs_init(): %zu routings", routing_outputs.size());
+}
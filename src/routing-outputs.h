@@ -0,0 +1,32 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+/**
+ * NDI routings: named NDI sources that forward another NDI source on the network, without OBS receiving or
+ * sending any frame. Downstream receivers connect to the routing name and stay connected when the routing is
+ * pointed to another source, a switch is a single NDIlib_routing_change instead of every receiver reconnecting.
+ * They are configured as a list in Config::RoutingOutputs.
+ */
+
+void routing_outputs_deinit();
+/**
+ * Create, retarget or destroy the routings to match the configuration. Routings whose name and groups are
+ * unchanged are kept and only retargeted, so their receivers are not disconnected.
+ */
+void routing_outputs_init();
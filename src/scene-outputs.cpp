@@ -0,0 +1,334 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "scene-outputs.h"
+
+#include "plugin-main.h"
+#include "ndi-readback.h"
+#include "ndi-video-converter.h"
+
+#include <media-io/video-frame.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <vector>
+
+struct scene_output {
+	QString ndi_name;
+	QString scene_name;
+	bool is_running;
+
+	obs_output_t *output;
+	obs_view_t *view;
+	video_t *video_queue;
+	audio_t *dummy_audio_queue; // unused, scene outputs have no audio
+	gs_texrender_t *texrender;
+	ndi_readback_t readback;
+	ndi_video_converter_t converter;
+
+	// Set by the render pass for the readback pass of the same frame
+	bool staged;
+	int frames_to_send;
+};
+
+// The render callback is registered only while outputs exist, and the list is only changed with it removed
+static std::vector<scene_output *> scene_outputs;
+
+void render_scene_outputs(void *param);
+void on_scene_outputs_frontend_event(enum obs_frontend_event event, void *param);
+
+static bool scene_output_has_receivers(scene_output *so)
+{
+	uint8_t stack[128];
+	calldata_t cd;
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	if (!proc_handler_call(obs_output_get_proc_handler(so->output), "get_connections", &cd))
+		return true;
+	return calldata_int(&cd, "connections") > 0;
+}
+
+// Binds the view to the configured scene of the current scene collection, if it exists
+static void scene_output_bind_scene(scene_output *so)
+{
+	obs_source_t *scene = obs_get_source_by_name(QT_TO_UTF8(so->scene_name));
+	if (scene && !obs_source_is_scene(scene)) {
+		obs_source_release(scene);
+		scene = nullptr;
+	}
+	if (!scene)
+		obs_log(LOG_WARNING, "WARN-429 - NDI Scene Output '%s': scene '%s' not found",
+			QT_TO_UTF8(so->ndi_name), QT_TO_UTF8(so->scene_name));
+
+	obs_view_set_source(so->view, 0, scene);
+	obs_source_release(scene);
+}
+
+static void scene_output_destroy(scene_output *so)
+{
+	obs_log(LOG_DEBUG, "scene_output_destroy: releasing NDI Scene Output '%s'", QT_TO_UTF8(so->ndi_name));
+
+	if (so->is_running) {
+		obs_output_stop(so->output);
+		video_output_stop(so->video_queue);
+	}
+
+	obs_view_set_source(so->view, 0, nullptr);
+	obs_view_destroy(so->view);
+
+	obs_enter_graphics();
+	ndi_readback_destroy(&so->readback);
+	gs_texrender_destroy(so->texrender);
+	obs_leave_graphics();
+
+	video_output_close(so->video_queue);
+	audio_output_close(so->dummy_audio_queue);
+	ndi_converter_destroy(&so->converter);
+	obs_output_release(so->output);
+
+	delete so;
+}
+
+static scene_output *scene_output_create(const QJsonObject &entry)
+{
+	auto ndi_name = entry["name"].toString();
+	auto scene_name = entry["scene"].toString();
+	if (ndi_name.isEmpty() || scene_name.isEmpty())
+		return nullptr;
+
+	obs_log(LOG_DEBUG, "scene_output_create: creating NDI Scene Output '%s' for scene '%s'",
+		QT_TO_UTF8(ndi_name), QT_TO_UTF8(scene_name));
+
+	obs_data_t *output_settings = obs_data_create();
+	obs_data_set_string(output_settings, "ndi_name", QT_TO_UTF8(ndi_name));
+	obs_data_set_string(output_settings, "ndi_groups", QT_TO_UTF8(entry["groups"].toString()));
+	obs_data_set_bool(output_settings, "uses_audio", false);
+	auto output_name = QString("NDI Scene Output %1").arg(ndi_name);
+	obs_output_t *output = obs_output_create("ndi_output", QT_TO_UTF8(output_name), output_settings, nullptr);
+	obs_data_release(output_settings);
+	if (!output) {
+		obs_log(LOG_WARNING, "WARN-430 - Failed to create NDI Scene Output '%s'", QT_TO_UTF8(ndi_name));
+		return nullptr;
+	}
+
+	auto so = new scene_output();
+	so->ndi_name = ndi_name;
+	so->scene_name = scene_name;
+	so->output = output;
+
+	obs_video_info ovi;
+	obs_get_video_info(&ovi);
+
+	obs_data_t *converter_settings = obs_data_create();
+	ndi_converter_set_output_settings(converter_settings, QT_TO_UTF8(entry["resolution"].toString()),
+					  QT_TO_UTF8(entry["framerate"].toString()));
+	ndi_converter_init(&so->converter);
+	ndi_converter_update(&so->converter, converter_settings);
+	obs_data_release(converter_settings);
+
+	// Scenes are canvas sized, so the render region is fixed for the lifetime of the output
+	ndi_converter_update_region(&so->converter, ovi.base_width, ovi.base_height);
+	uint32_t width = so->converter.output_width;
+	uint32_t height = so->converter.output_height;
+
+	obs_enter_graphics();
+	so->texrender = gs_texrender_create(GS_BGRA, GS_ZS_NONE);
+	ndi_readback_init(&so->readback);
+	ndi_readback_configure(&so->readback, width, height, GS_BGRA, 2);
+	obs_leave_graphics();
+
+	const video_output_info *mainVOI = video_output_get_info(obs_get_video());
+	const audio_output_info *mainAOI = audio_output_get_info(obs_get_audio());
+
+	video_output_info voi = {0};
+	voi.name = QT_TO_UTF8(so->ndi_name);
+	voi.format = VIDEO_FORMAT_BGRA;
+	voi.width = width;
+	voi.height = height;
+	voi.fps_den = ovi.fps_den;
+	voi.fps_num = ovi.fps_num;
+	if (so->converter.enable_custom_framerate && so->converter.target_fps_num && so->converter.target_fps_den) {
+		voi.fps_den = so->converter.target_fps_den;
+		voi.fps_num = so->converter.target_fps_num;
+	}
+	voi.cache_size = 16;
+	voi.colorspace = mainVOI->colorspace;
+	voi.range = mainVOI->range;
+	video_output_open(&so->video_queue, &voi);
+
+	audio_output_info aoi = {0};
+	aoi.name = QT_TO_UTF8(so->ndi_name);
+	aoi.format = mainAOI->format;
+	aoi.samples_per_sec = mainAOI->samples_per_sec;
+	aoi.speakers = mainAOI->speakers;
+	aoi.input_callback = [](void *, uint64_t, uint64_t, uint64_t *, uint32_t, struct audio_output_data *) {
+		return false;
+	};
+	audio_output_open(&so->dummy_audio_queue, &aoi);
+
+	so->view = obs_view_create();
+	scene_output_bind_scene(so);
+
+	obs_output_set_media(so->output, so->video_queue, so->dummy_audio_queue);
+	so->is_running = obs_output_start(so->output);
+	if (so->is_running) {
+		obs_log(LOG_INFO, "NDI Scene Output started. '%s' (scene '%s', %ux%u)", QT_TO_UTF8(so->ndi_name),
+			QT_TO_UTF8(so->scene_name), width, height);
+	} else {
+		obs_log(LOG_WARNING, "WARN-430 - Failed to start NDI Scene Output '%s'; error='%s'",
+			QT_TO_UTF8(so->ndi_name), obs_output_get_last_error(so->output));
+	}
+
+	return so;
+}
+
+void scene_outputs_deinit()
+{
+	obs_log(LOG_DEBUG, "+scene_outputs_deinit()");
+
+	if (!scene_outputs.empty()) {
+		obs_remove_main_rendered_callback(render_scene_outputs, nullptr);
+		obs_frontend_remove_event_callback(on_scene_outputs_frontend_event, nullptr);
+
+		for (auto so : scene_outputs) {
+			scene_output_destroy(so);
+		}
+		scene_outputs.clear();
+	}
+
+	obs_log(LOG_DEBUG, "-scene_outputs_deinit()");
+}
+
+void scene_outputs_init()
+{
+	obs_log(LOG_DEBUG, "+scene_outputs_init()");
+
+	scene_outputs_deinit();
+
+	auto config = Config::Current();
+	QJsonParseError parseError;
+	auto document = QJsonDocument::fromJson(config->SceneOutputs.toUtf8(), &parseError);
+	if (!config->SceneOutputs.isEmpty() && parseError.error != QJsonParseError::NoError) {
+		obs_log(LOG_WARNING, "WARN-430 - Invalid NDI Scene Outputs configuration: %s",
+			QT_TO_UTF8(parseError.errorString()));
+	}
+
+	for (const auto &value : document.array()) {
+		auto so = scene_output_create(value.toObject());
+		if (so)
+			scene_outputs.push_back(so);
+	}
+
+	if (!scene_outputs.empty()) {
+		obs_frontend_add_event_callback(on_scene_outputs_frontend_event, nullptr);
+		obs_add_main_rendered_callback(render_scene_outputs, nullptr);
+	}
+
+	obs_log(LOG_DEBUG, "-scene_outputs_init(): %zu scene outputs", scene_outputs.size());
+}
+
+void on_scene_outputs_frontend_event(enum obs_frontend_event event, void *)
+{
+	switch (event) {
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP:
+		for (auto so : scene_outputs) {
+			obs_view_set_source(so->view, 0, nullptr);
+		}
+		break;
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
+	case OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED:
+		for (auto so : scene_outputs) {
+			scene_output_bind_scene(so);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void render_scene_outputs(void *)
+{
+	uint64_t timestamp = obs_get_video_frame_time();
+
+	// Render and stage every output first, so the GPU copies run while the next outputs render
+	for (auto so : scene_outputs) {
+		so->staged = false;
+		if (!so->is_running)
+			continue;
+
+		// Nothing is rendered nor read back while no receiver is connected, see preview-output.cpp
+		ndi_video_converter_t *converter = &so->converter;
+		if (!scene_output_has_receivers(so)) {
+			ndi_readback_reset(&so->readback);
+			ndi_converter_reset_framerate(converter);
+			continue;
+		}
+
+		so->frames_to_send = 1;
+		if (converter->enable_custom_framerate &&
+		    (!ndi_converter_should_send_frame(converter, timestamp, &so->frames_to_send) ||
+		     so->frames_to_send == 0))
+			continue;
+
+		uint32_t width = converter->output_width;
+		uint32_t height = converter->output_height;
+
+		gs_texrender_reset(so->texrender);
+		if (!gs_texrender_begin(so->texrender, width, height))
+			continue;
+
+		struct vec4 background;
+		vec4_zero(&background);
+
+		gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
+		gs_ortho(converter->region_left, converter->region_left + converter->region_width,
+			 converter->region_top, converter->region_top + converter->region_height, -100.0f, 100.0f);
+
+		gs_blend_state_push();
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+		obs_view_render(so->view);
+
+		gs_blend_state_pop();
+		gs_texrender_end(so->texrender);
+
+		ndi_readback_stage(&so->readback, gs_texrender_get_texture(so->texrender), timestamp);
+		so->staged = true;
+	}
+
+	// Then map the frames staged on the previous call, whose copies are done
+	for (auto so : scene_outputs) {
+		if (!so->staged)
+			continue;
+
+		uint8_t *video_data;
+		uint32_t video_linesize;
+		uint64_t frame_timestamp = 0;
+		if (!ndi_readback_map(&so->readback, &video_data, &video_linesize, &frame_timestamp))
+			continue;
+
+		struct video_frame output_frame;
+		if (video_output_lock_frame(so->video_queue, &output_frame, so->frames_to_send, frame_timestamp)) {
+			ndi_readback_copy_plane(output_frame.data[0], output_frame.linesize[0], video_data,
+						video_linesize, so->converter.output_width * 4,
+						so->converter.output_height);
+			video_output_unlock_frame(so->video_queue);
+		}
+		ndi_readback_unmap(&so->readback);
+	}
+}
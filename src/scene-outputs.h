@@ -0,0 +1,28 @@
+/******************************************************************************
+	Copyright (C) 2016-2024 DistroAV <contact@distroav.org>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, see <https://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+/**
+ * Additional NDI outputs, each sending one scene (ISO feeds) at its own resolution and frame rate.
+ * They are configured as a list in Config::SceneOutputs and rendered together: every output renders its scene
+ * through its own obs_view once per canvas frame, all frames are staged for readback first and mapped after,
+ * so the GPU copies of all outputs overlap.
+ */
+
+void scene_outputs_deinit();
+void scene_outputs_init();